@@ -0,0 +1,143 @@
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "catch2/catch_amalgamated.hpp"
+#include "Dast/collections/LinkedList.hpp"
+#include "Dast/collections/UnrolledList.hpp"
+#include "Dast/memory/Arena.hpp"
+
+namespace {
+    template<typename List>
+    List filled(const std::size_t n) {
+        List res;
+        for (std::size_t i = 0; i < n; i++) {
+            res.push_back(static_cast<int>(i));
+        }
+        return res;
+    }
+
+    /// Same elements, but every node allocated between nodes of other lists, as lists built up over time are.
+    template<typename List>
+    List scattered(const std::size_t n, std::vector<List>& others) {
+        List res;
+        others.resize(7);
+        for (std::size_t i = 0; i < n; i++) {
+            res.push_back(static_cast<int>(i));
+            for (List& other : others) {
+                other.push_back(0);
+            }
+        }
+        return res;
+    }
+
+    template<typename List>
+    long long sum(const List& list) {
+        long long res = 0;
+        for (auto it = list.begin(); it != list.end(); ++it) {
+            res += *it;
+        }
+        return res;
+    }
+
+    /// Indices spread over the list, the same for every container.
+    std::vector<std::size_t> positions(const std::size_t count, const std::size_t n) {
+        std::mt19937_64 rng(0);
+        std::vector<std::size_t> res(count);
+        for (std::size_t i = 0; i < count; i++) {
+            res[i] = std::uniform_int_distribution<std::size_t>(0, n + i - 1)(rng);
+        }
+        return res;
+    }
+}
+
+TEST_CASE("Traversal", "[benchmark]") {
+
+    constexpr std::size_t n = 1'000'000;
+
+    const std::vector<int> vector = filled<std::vector<int>>(n);
+    const Dast::LinkedList<int> linked = filled<Dast::LinkedList<int>>(n);
+    const Dast::UnrolledList<int> unrolled = filled<Dast::UnrolledList<int>>(n);
+
+    std::vector<Dast::LinkedList<int>> linked_others;
+    const Dast::LinkedList<int> linked_scattered = scattered(n, linked_others);
+    std::vector<Dast::UnrolledList<int>> unrolled_others;
+    const Dast::UnrolledList<int> unrolled_scattered = scattered(n, unrolled_others);
+
+    BENCHMARK("sum std::vector 1M") {
+        return std::accumulate(vector.begin(), vector.end(), 0LL);
+    };
+
+    BENCHMARK("sum LinkedList 1M") {
+        return sum(linked);
+    };
+
+    BENCHMARK("sum UnrolledList 1M") {
+        return sum(unrolled);
+    };
+
+    BENCHMARK("sum LinkedList 1M scattered nodes") {
+        return sum(linked_scattered);
+    };
+
+    BENCHMARK("sum UnrolledList 1M scattered nodes") {
+        return sum(unrolled_scattered);
+    };
+}
+
+TEST_CASE("Building", "[benchmark]") {
+
+    constexpr std::size_t n = 1'000'000;
+
+    BENCHMARK("push_back std::vector 1M") {
+        return filled<std::vector<int>>(n).size();
+    };
+
+    BENCHMARK("push_back LinkedList 1M") {
+        return filled<Dast::LinkedList<int>>(n).size();
+    };
+
+    BENCHMARK("push_back UnrolledList 1M") {
+        return filled<Dast::UnrolledList<int>>(n).size();
+    };
+
+    BENCHMARK("push_back LinkedList 1M arena") {
+        Dast::Arena arena;
+        Dast::LinkedList<int, Dast::ArenaAllocator<int>> list{ Dast::ArenaAllocator<int>(arena) };
+        for (std::size_t i = 0; i < n; i++) {
+            list.push_back(static_cast<int>(i));
+        }
+        return list.size();
+    };
+}
+
+TEST_CASE("Insertion", "[benchmark]") {
+
+    // Inserting after random indices walks to the index and then inserts, which a vector pays for by shifting
+    constexpr std::size_t n = 10'000;
+    const std::vector<std::size_t> indices = positions(1'000, n);
+
+    BENCHMARK("insert 1000 into std::vector 10k") {
+        std::vector<int> vector = filled<std::vector<int>>(n);
+        for (const std::size_t index : indices) {
+            vector.insert(vector.begin() + static_cast<std::ptrdiff_t>(index) + 1, 0);
+        }
+        return vector.size();
+    };
+
+    BENCHMARK("insert 1000 into LinkedList 10k") {
+        Dast::LinkedList<int> list = filled<Dast::LinkedList<int>>(n);
+        for (const std::size_t index : indices) {
+            list.insert(index, 0);
+        }
+        return list.size();
+    };
+
+    BENCHMARK("insert 1000 into UnrolledList 10k") {
+        Dast::UnrolledList<int> list = filled<Dast::UnrolledList<int>>(n);
+        for (const std::size_t index : indices) {
+            list.insert(index, 0);
+        }
+        return list.size();
+    };
+}
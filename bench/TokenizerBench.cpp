@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <new>
+#include <random>
+
+#include "catch2/catch_amalgamated.hpp"
+#include "Orion/Tokenizer.hpp"
+
+namespace {
+    // Heap bytes currently allocated through operator new, and the most allocated at once since the last reset
+    std::atomic<std::size_t> allocated_bytes = 0;
+    std::atomic<std::size_t> peak_bytes = 0;
+
+    /// Precedes every block handed out by the counting operator new.
+    struct AllocationHeader {
+        void* base;
+        std::size_t size;
+    };
+
+    void* counted_allocate(const std::size_t size, std::size_t alignment) {
+        alignment = std::max(alignment, alignof(AllocationHeader));
+
+        void* base = std::malloc(size + sizeof(AllocationHeader) + alignment);
+        if (base == nullptr) {
+            throw std::bad_alloc();
+        }
+
+        const std::uintptr_t address =
+            (reinterpret_cast<std::uintptr_t>(base) + sizeof(AllocationHeader) + alignment - 1) / alignment * alignment;
+        reinterpret_cast<AllocationHeader*>(address)[-1] = {base, size};
+
+        const std::size_t allocated = allocated_bytes.fetch_add(size) + size;
+        std::size_t peak = peak_bytes.load();
+        while (allocated > peak && !peak_bytes.compare_exchange_weak(peak, allocated)) {}
+
+        return reinterpret_cast<void*>(address);
+    }
+
+    void counted_deallocate(void* ptr) noexcept {
+        if (ptr != nullptr) {
+            const AllocationHeader header = static_cast<AllocationHeader*>(ptr)[-1];
+            allocated_bytes.fetch_sub(header.size);
+            std::free(header.base);
+        }
+    }
+}
+
+// Every other form of operator new and delete forwards to these
+void* operator new(const std::size_t size) {
+    return counted_allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment) {
+    return counted_allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept {
+    counted_deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    counted_deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    counted_deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    counted_deallocate(ptr);
+}
+
+namespace {
+    /// Generates sentences over a Zipf distributed vocabulary of random lower case words, roughly resembling the word
+    /// frequencies of natural text.
+    std::vector<std::string> corpus(const std::size_t sentences, const std::size_t words, const std::size_t seed = 0) {
+        std::mt19937_64 rng(seed);
+
+        std::uniform_int_distribution<std::size_t> length(2, 12);
+        std::uniform_int_distribution<int> letter('a', 'z');
+
+        std::vector<std::string> dictionary(words);
+        std::vector<double> weights(words);
+        for (std::size_t i = 0; i < words; i++) {
+            for (std::size_t j = length(rng); j > 0; j--) {
+                dictionary[i] += static_cast<char>(letter(rng));
+            }
+            weights[i] = 1.0 / static_cast<double>(i + 1);
+        }
+
+        std::discrete_distribution<std::size_t> pick(weights.begin(), weights.end());
+        std::uniform_int_distribution<std::size_t> sentence_length(5, 30);
+
+        std::vector<std::string> res(sentences);
+        for (std::string& sentence : res) {
+            for (std::size_t i = sentence_length(rng); i > 0; i--) {
+                sentence += dictionary[pick(rng)];
+                sentence += i > 1 ? " " : ".";
+            }
+        }
+
+        return res;
+    }
+
+    /// Runs a workload once and reports its throughput along with the most heap memory it held at once, beyond what was
+    /// already allocated when it started.
+    /// @param name Workload name.
+    /// @param unit Name of the unit processed.
+    /// @param work Workload, returns the number of units processed.
+    template<typename F>
+    void throughput(const std::string& name, const std::string& unit, F&& work) {
+        const std::size_t baseline = allocated_bytes.load();
+        peak_bytes = baseline;
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto units = static_cast<double>(work());
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        const auto peak = static_cast<double>(peak_bytes.load() - baseline);
+        std::cout << std::format("{:<48} {:>10.3f} s {:>14.0f} {}/s {:>10.1f} MB heap peak",
+            name, elapsed.count(), units / elapsed.count(), unit, peak / (1024.0 * 1024.0)) << std::endl;
+    }
+
+    std::size_t count_symbols(const std::vector<std::string>& raw) {
+        std::size_t res = 0;
+        for (const std::string& sentence : raw) {
+            for_each_word(sentence, true, [&res](const std::string_view word) { res += word.size(); });
+        }
+        return res;
+    }
+}
+
+TEST_CASE("Normalize", "[benchmark]") {
+
+    for (const std::size_t sentences : { 1'000, 10'000, 100'000 }) {
+        const std::vector<std::string> raw = corpus(sentences, 20'000);
+        const std::size_t symbols = count_symbols(raw);
+
+        throughput(std::format("normalize {} sentences", sentences), "symbols", [&] {
+            return normalize(raw, true).size() > 0 ? symbols : 0;
+        });
+
+        throughput(std::format("normalize small vectors {} sentences", sentences), "symbols", [&] {
+            return normalize<Symbols>(raw, true).size() > 0 ? symbols : 0;
+        });
+
+        throughput(std::format("normalize arena {} sentences", sentences), "symbols", [&] {
+            Dast::Arena arena;
+            return normalize(raw, true, arena).size() > 0 ? symbols : 0;
+        });
+    }
+
+    const std::vector<std::string> raw = corpus(1'000, 20'000);
+
+    BENCHMARK("normalize 1000 sentences") {
+        return normalize(raw, true);
+    };
+
+    BENCHMARK("normalize small vectors 1000 sentences") {
+        return normalize<Symbols>(raw, true);
+    };
+}
+
+TEST_CASE("Byte Pair Training", "[benchmark]") {
+
+    // Time per merge should stay flat as the corpus grows if training no longer rescans the corpus for each merge
+    for (const std::size_t sentences : { 1'000, 10'000, 100'000 }) {
+        const std::vector<std::string> raw = corpus(sentences, 20'000);
+
+        const WordCounts counts({ raw }, true);
+
+        throughput(std::format("count words {} sentences", sentences), "symbols", [&] {
+            return WordCounts({ raw }, true).size() > 0 ? count_symbols(raw) : 0;
+        });
+
+        for (const unsigned int n_vocab : { 500u, 1'000u, 2'000u }) {
+            throughput(std::format("train {} tokens {} sentences", n_vocab, sentences), "merges", [&] {
+                const BytePairConfig config = { .n_vocab = n_vocab, .min_frequency = 1, .special_tokens = {} };
+                const std::set<std::string> tokens = BytePairTokenizer::train(counts, std::array{ 1.0 }, config);
+
+                return std::ranges::count_if(tokens, [](const std::string& token) { return token.size() > 1; });
+            });
+        }
+    }
+}
+
+TEST_CASE("WordPiece Encoding", "[benchmark]") {
+
+    const WordPieceTokenizer tokenizer(WordPieceTokenizer().tokenize(corpus(2'000, 5'000, 1), 1'000, true));
+
+    for (const std::size_t sentences : { 10'000, 100'000 }) {
+        const std::vector<std::string> raw = corpus(sentences, 20'000);
+
+        throughput(std::format("encode {} sentences", sentences), "tokens", [&] {
+            std::size_t tokens = 0;
+            for (const std::string& sentence : raw) {
+                tokens += tokenizer.encode(sentence).size();
+            }
+            return tokens;
+        });
+    }
+
+    const std::vector<std::string> raw = corpus(1'000, 20'000);
+
+    BENCHMARK("encode 1000 sentences") {
+        std::size_t tokens = 0;
+        for (const std::string& sentence : raw) {
+            tokens += tokenizer.encode(sentence).size();
+        }
+        return tokens;
+    };
+}
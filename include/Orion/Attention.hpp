@@ -0,0 +1,378 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "LinearLib/Gemm.hpp"
+#include "LinearLib/Softmax.hpp"
+#include "LinearLib/Tensor.hpp"
+#include "LinearLib/ThreadPool.hpp"
+
+namespace Orion {
+    /// Query and key rows per tile, a 64 x 64 score tile plus the Q, K and V tiles of a head stay within L2.
+    inline constexpr std::size_t attention_block_q = 64;
+    inline constexpr std::size_t attention_block_k = 64;
+
+    namespace detail {
+        /// Offset of the index-th matrix of the leading dimensions, which are flattened row-major.
+        template<typename T>
+        std::size_t matrix_offset(const LinearLib::Tensor<T>& t, std::size_t index) {
+            std::size_t offset = 0;
+            for (std::size_t d = t.rank() - 2; d-- > 0;) {
+                offset += index % t.shape(d) * t.strides()[d];
+                index /= t.shape(d);
+            }
+            return offset;
+        }
+
+        /// Keys visible to queries q0, q0 + 1, ... of the batch-th sequence. Both masks keep a prefix of the keys,
+        /// which only grows with the query.
+        inline void visible_keys(const LinearLib::SoftmaxMask& mask, std::size_t const batch, std::size_t const q0,
+                                 std::size_t const keys, std::span<std::size_t> const limits) {
+            std::size_t length = keys;
+            if (!mask.lengths.empty()) {
+                length = std::min(length, mask.lengths[batch]);
+            }
+            for (std::size_t r = 0; r < limits.size(); r++) {
+                limits[r] = mask.causal ? std::min(length, q0 + r + mask.offset + 1) : length;
+            }
+        }
+
+        template<typename T>
+        void require_attention_shapes(const LinearLib::Tensor<T>& q, const LinearLib::Tensor<T>& k,
+                                      const LinearLib::Tensor<T>& v, const LinearLib::Tensor<T>& out,
+                                      const LinearLib::SoftmaxMask& mask) {
+            const std::size_t rank = q.rank();
+            if (rank < 2 || k.rank() != rank || v.rank() != rank || out.rank() != rank) {
+                throw std::invalid_argument("Attention operands must share a rank of at least 2");
+            }
+            for (std::size_t d = 0; d + 2 < rank; d++) {
+                if (k.shape(d) != q.shape(d) || v.shape(d) != q.shape(d) || out.shape(d) != q.shape(d)) {
+                    throw std::invalid_argument("Attention operands must share their leading dimensions");
+                }
+            }
+            if (k.shape(rank - 1) != q.shape(rank - 1) || v.shape(rank - 2) != k.shape(rank - 2)) {
+                throw std::invalid_argument("Attention keys must match the queries' width and the values' length");
+            }
+            if (out.shape(rank - 2) != q.shape(rank - 2) || out.shape(rank - 1) != v.shape(rank - 1)) {
+                throw std::invalid_argument("Attention output must be queries x value width");
+            }
+            if (!mask.lengths.empty() && mask.lengths.size() != (rank > 2 ? q.shape(0) : 1)) {
+                throw std::invalid_argument("Attention mask needs one length per index of the first dimension");
+            }
+        }
+
+        template<std::floating_point T>
+        void attention(const LinearLib::Tensor<T>& q, const LinearLib::Tensor<T>& k, const LinearLib::Tensor<T>& v,
+                       LinearLib::Tensor<T>& out, T* lse, const LinearLib::SoftmaxMask& mask, T scale) {
+            require_attention_shapes(q, k, v, out, mask);
+
+            const std::size_t rank = q.rank();
+            const std::size_t queries = q.shape(rank - 2);
+            const std::size_t keys = k.shape(rank - 2);
+            const std::size_t width = q.shape(rank - 1);
+            const std::size_t value_width = v.shape(rank - 1);
+            std::size_t matrices = 1;
+            for (std::size_t d = 0; d + 2 < rank; d++) {
+                matrices *= q.shape(d);
+            }
+            const std::size_t per_batch = rank > 2 ? matrices / q.shape(0) : matrices;
+            const std::size_t tiles = (queries + attention_block_q - 1) / attention_block_q;
+
+            if (scale == T{0}) {
+                scale = T{1} / std::sqrt(static_cast<T>(std::max<std::size_t>(width, 1)));
+            }
+
+            const std::size_t q_rs = q.strides()[rank - 2], q_cs = q.strides()[rank - 1];
+            const std::size_t k_rs = k.strides()[rank - 2], k_cs = k.strides()[rank - 1];
+            const std::size_t v_rs = v.strides()[rank - 2], v_cs = v.strides()[rank - 1];
+            const std::size_t o_rs = out.strides()[rank - 2], o_cs = out.strides()[rank - 1];
+
+            LinearLib::parallelFor(0, matrices * tiles, 1, [&](std::size_t const lo, std::size_t const hi) {
+                std::vector<T> scores(attention_block_q * attention_block_k);
+                std::vector<T> acc(attention_block_q * value_width);
+                std::vector<T> row_max(attention_block_q);
+                std::vector<T> row_sum(attention_block_q);
+                std::vector<std::size_t> row_keys(attention_block_q);
+
+                for (std::size_t task = lo; task < hi; task++) {
+                    const std::size_t matrix = task / tiles;
+                    const std::size_t q0 = task % tiles * attention_block_q;
+                    const std::size_t rows = std::min(attention_block_q, queries - q0);
+
+                    const T* qm = q.data() + detail::matrix_offset(q, matrix) + q0 * q_rs;
+                    const T* km = k.data() + detail::matrix_offset(k, matrix);
+                    const T* vm = v.data() + detail::matrix_offset(v, matrix);
+                    T* om = out.data() + detail::matrix_offset(out, matrix) + q0 * o_rs;
+
+                    detail::visible_keys(mask, matrix / per_batch, q0, keys, std::span(row_keys.data(), rows));
+                    const std::size_t end = row_keys[rows - 1];
+
+                    std::fill(acc.begin(), acc.end(), T{0});
+                    std::fill(row_max.begin(), row_max.end(), std::numeric_limits<T>::lowest());
+                    std::fill(row_sum.begin(), row_sum.end(), T{0});
+
+                    for (std::size_t k0 = 0; k0 < end; k0 += attention_block_k) {
+                        const std::size_t cols = std::min(attention_block_k, end - k0);
+
+                        LinearLib::gemm(rows, cols, width, scale, qm, q_rs, q_cs, km + k0 * k_rs, k_cs, k_rs, T{0},
+                                        scores.data(), attention_block_k);
+
+                        for (std::size_t r = 0; r < rows; r++) {
+                            T* s = scores.data() + r * attention_block_k;
+                            const std::size_t valid = std::min(cols, row_keys[r] - std::min(row_keys[r], k0));
+
+                            if (valid > 0) {
+                                const T previous = row_max[r];
+                                const T next = std::max(previous, *std::max_element(s, s + valid));
+                                const T correction = std::exp(previous - next);
+
+                                row_sum[r] = row_sum[r] * correction + LinearLib::exponentiate(s, valid, next);
+                                row_max[r] = next;
+
+                                if (correction != T{1}) {
+                                    T* a = acc.data() + r * value_width;
+                                    for (std::size_t j = 0; j < value_width; j++) {
+                                        a[j] *= correction;
+                                    }
+                                }
+                            }
+                            std::fill(s + valid, s + cols, T{0});
+                        }
+
+                        LinearLib::gemm(rows, value_width, cols, T{1}, scores.data(), attention_block_k,
+                                        std::size_t{1}, vm + k0 * v_rs, v_rs, v_cs, T{1}, acc.data(), value_width);
+                    }
+
+                    for (std::size_t r = 0; r < rows; r++) {
+                        if (lse != nullptr) {
+                            lse[matrix * queries + q0 + r] = row_sum[r] > T{0} ? row_max[r] + std::log(row_sum[r])
+                                                                               : std::numeric_limits<T>::infinity();
+                        }
+
+                        const T inv = row_sum[r] > T{0} ? T{1} / row_sum[r] : T{0};
+                        const T* a = acc.data() + r * value_width;
+                        T* o = om + r * o_rs;
+                        for (std::size_t j = 0; j < value_width; j++) {
+                            o[j * o_cs] = a[j] * inv;
+                        }
+                    }
+                }
+            });
+        }
+    }
+
+    /**
+     * Scaled dot-product attention softmax(Q K^T * scale) V written into out, which may be a strided view. Keys
+     * and values are visited in tiles with an online softmax, so the sequence x sequence scores are never formed
+     * and memory stays linear in sequence length. Query tiles of every matrix of the leading (batch, head)
+     * dimensions run in parallel, and causal tiles above the diagonal are skipped entirely.
+     * @param q [..., queries, width]
+     * @param k [..., keys, width]
+     * @param v [..., keys, value width]
+     * @param out [..., queries, value width]
+     * @param mask Causal and key padding masks, lengths indexing the first dimension. Fully masked queries give 0.
+     * @param scale Score scale, 1 / sqrt(width) when 0.
+     */
+    template<std::floating_point T>
+    void attention(const LinearLib::Tensor<T>& q, const LinearLib::Tensor<T>& k, const LinearLib::Tensor<T>& v,
+                   LinearLib::Tensor<T>& out, const LinearLib::SoftmaxMask& mask = {}, T const scale = 0) {
+        detail::attention(q, k, v, out, static_cast<T*>(nullptr), mask, scale);
+    }
+
+    /**
+     * Attention that also keeps the log-sum-exp of every query's scores, all attention_backward needs to rebuild
+     * the probabilities tile by tile.
+     * @param lse Contiguous [..., queries], +infinity for fully masked queries.
+     */
+    template<std::floating_point T>
+    void attention(const LinearLib::Tensor<T>& q, const LinearLib::Tensor<T>& k, const LinearLib::Tensor<T>& v,
+                   LinearLib::Tensor<T>& out, LinearLib::Tensor<T>& lse, const LinearLib::SoftmaxMask& mask = {},
+                   T const scale = 0) {
+        if (!lse.isContiguous() || lse.size() * v.shape(v.rank() - 1) != out.size()) {
+            throw std::invalid_argument("Attention log-sum-exp must be a contiguous [..., queries] tensor");
+        }
+        detail::attention(q, k, v, out, lse.data(), mask, scale);
+    }
+
+    /// Scaled dot-product attention into a new [..., queries, value width] tensor, see the overload writing into
+    /// a given output.
+    template<std::floating_point T>
+    LinearLib::Tensor<T> attention(const LinearLib::Tensor<T>& q, const LinearLib::Tensor<T>& k,
+                                   const LinearLib::Tensor<T>& v, const LinearLib::SoftmaxMask& mask = {},
+                                   T const scale = 0) {
+        if (q.rank() < 2 || v.rank() < 2) {
+            throw std::invalid_argument("Attention operands must share a rank of at least 2");
+        }
+
+        typename LinearLib::Tensor<T>::Shape shape(q.shape());
+        shape.back() = v.shape(v.rank() - 1);
+
+        LinearLib::Tensor<T> out{std::move(shape)};
+        attention(q, k, v, out, mask, scale);
+        return out;
+    }
+
+    /**
+     * Gradients of attention from its output gradient, rebuilding the probabilities tile by tile from the forward
+     * pass' log-sum-exp instead of storing them. Key tiles are the outer loop so their gradients are completed one
+     * tile at a time, which keeps each (batch, head) matrix on one thread; the matrices run in parallel.
+     * @param out Forward output.
+     * @param lse Forward log-sum-exp, contiguous [..., queries].
+     * @param grad Gradient of out.
+     * @param dq, dk, dv Overwritten with the gradients of q, k and v, may be strided views.
+     */
+    template<std::floating_point T>
+    void attention_backward(const LinearLib::Tensor<T>& q, const LinearLib::Tensor<T>& k,
+                            const LinearLib::Tensor<T>& v, const LinearLib::Tensor<T>& out,
+                            const LinearLib::Tensor<T>& lse, const LinearLib::Tensor<T>& grad, LinearLib::Tensor<T>& dq,
+                            LinearLib::Tensor<T>& dk, LinearLib::Tensor<T>& dv, const LinearLib::SoftmaxMask& mask = {},
+                            T scale = 0) {
+        detail::require_attention_shapes(q, k, v, out, mask);
+        if (grad.shape() != out.shape() || dq.shape() != q.shape() || dk.shape() != k.shape() ||
+            dv.shape() != v.shape()) {
+            throw std::invalid_argument("Attention gradients must match their operands");
+        }
+        if (!lse.isContiguous() || lse.size() * v.shape(v.rank() - 1) != out.size()) {
+            throw std::invalid_argument("Attention log-sum-exp must be a contiguous [..., queries] tensor");
+        }
+
+        const std::size_t rank = q.rank();
+        const std::size_t queries = q.shape(rank - 2);
+        const std::size_t keys = k.shape(rank - 2);
+        const std::size_t width = q.shape(rank - 1);
+        const std::size_t value_width = v.shape(rank - 1);
+        std::size_t matrices = 1;
+        for (std::size_t d = 0; d + 2 < rank; d++) {
+            matrices *= q.shape(d);
+        }
+        const std::size_t per_batch = rank > 2 ? matrices / q.shape(0) : matrices;
+
+        if (scale == T{0}) {
+            scale = T{1} / std::sqrt(static_cast<T>(std::max<std::size_t>(width, 1)));
+        }
+
+        const std::size_t q_rs = q.strides()[rank - 2], q_cs = q.strides()[rank - 1];
+        const std::size_t k_rs = k.strides()[rank - 2], k_cs = k.strides()[rank - 1];
+        const std::size_t v_rs = v.strides()[rank - 2], v_cs = v.strides()[rank - 1];
+        const std::size_t o_rs = out.strides()[rank - 2], o_cs = out.strides()[rank - 1];
+        const std::size_t g_rs = grad.strides()[rank - 2], g_cs = grad.strides()[rank - 1];
+
+        // Copies a dense rows x cols block into a strided matrix
+        const auto scatter = [rank](const T* from, std::size_t const rows, std::size_t const cols,
+                                    LinearLib::Tensor<T>& to, T* base) {
+            const std::size_t rs = to.strides()[rank - 2], cs = to.strides()[rank - 1];
+            for (std::size_t r = 0; r < rows; r++) {
+                for (std::size_t j = 0; j < cols; j++) {
+                    base[r * rs + j * cs] = from[r * cols + j];
+                }
+            }
+        };
+
+        LinearLib::parallelFor(0, matrices, 1, [&](std::size_t const lo, std::size_t const hi) {
+            std::vector<T> probs(attention_block_q * attention_block_k);
+            std::vector<T> dprobs(attention_block_q * attention_block_k);
+            std::vector<T> dk_tile(attention_block_k * width);
+            std::vector<T> dv_tile(attention_block_k * value_width);
+            std::vector<T> dq_acc(queries * width);
+            std::vector<T> delta(queries);
+            std::vector<std::size_t> limits(queries);
+
+            for (std::size_t matrix = lo; matrix < hi; matrix++) {
+                const T* qm = q.data() + detail::matrix_offset(q, matrix);
+                const T* km = k.data() + detail::matrix_offset(k, matrix);
+                const T* vm = v.data() + detail::matrix_offset(v, matrix);
+                const T* om = out.data() + detail::matrix_offset(out, matrix);
+                const T* gm = grad.data() + detail::matrix_offset(grad, matrix);
+                const T* lm = lse.data() + matrix * queries;
+
+                detail::visible_keys(mask, matrix / per_batch, 0, keys, limits);
+                const std::size_t end = queries == 0 ? 0 : limits[queries - 1];
+
+                // delta_i = dO_i . O_i, the softmax Jacobian's correction term of row i
+                for (std::size_t i = 0; i < queries; i++) {
+                    T sum = 0;
+                    for (std::size_t j = 0; j < value_width; j++) {
+                        sum += gm[i * g_rs + j * g_cs] * om[i * o_rs + j * o_cs];
+                    }
+                    delta[i] = sum;
+                }
+                std::fill(dq_acc.begin(), dq_acc.end(), T{0});
+
+                for (std::size_t k0 = 0; k0 < end; k0 += attention_block_k) {
+                    const std::size_t cols = std::min(attention_block_k, end - k0);
+                    const T* kt = km + k0 * k_rs;
+                    const T* vt = vm + k0 * v_rs;
+
+                    std::fill(dk_tile.begin(), dk_tile.end(), T{0});
+                    std::fill(dv_tile.begin(), dv_tile.end(), T{0});
+
+                    // Queries that see none of this tile are skipped, causal ones all come first
+                    const std::size_t first = static_cast<std::size_t>(
+                        std::upper_bound(limits.begin(), limits.end(), k0) - limits.begin());
+
+                    for (std::size_t q0 = first; q0 < queries; q0 += attention_block_q) {
+                        const std::size_t rows = std::min(attention_block_q, queries - q0);
+                        const T* qt = qm + q0 * q_rs;
+                        const T* gt = gm + q0 * g_rs;
+
+                        // P = exp(scale Q K^T - lse)
+                        LinearLib::gemm(rows, cols, width, scale, qt, q_rs, q_cs, kt, k_cs, k_rs, T{0}, probs.data(),
+                                        attention_block_k);
+                        for (std::size_t r = 0; r < rows; r++) {
+                            T* p = probs.data() + r * attention_block_k;
+                            const std::size_t valid = std::min(cols, limits[q0 + r] - std::min(limits[q0 + r], k0));
+                            LinearLib::exponentiate(p, valid, lm[q0 + r]);
+                            std::fill(p + valid, p + cols, T{0});
+                        }
+
+                        // dV += P^T dO, dP = dO V^T
+                        LinearLib::gemm(cols, value_width, rows, T{1}, probs.data(), std::size_t{1},
+                                        attention_block_k, gt, g_rs, g_cs, T{1}, dv_tile.data(), value_width);
+                        LinearLib::gemm(rows, cols, value_width, T{1}, gt, g_rs, g_cs, vt, v_cs, v_rs, T{0},
+                                        dprobs.data(), attention_block_k);
+
+                        // dS = scale P (dP - delta)
+                        for (std::size_t r = 0; r < rows; r++) {
+                            const T* p = probs.data() + r * attention_block_k;
+                            T* ds = dprobs.data() + r * attention_block_k;
+                            for (std::size_t j = 0; j < cols; j++) {
+                                ds[j] = scale * p[j] * (ds[j] - delta[q0 + r]);
+                            }
+                        }
+
+                        // dQ += dS K, dK += dS^T Q
+                        LinearLib::gemm(rows, width, cols, T{1}, dprobs.data(), attention_block_k, std::size_t{1},
+                                        kt, k_rs, k_cs, T{1}, dq_acc.data() + q0 * width, width);
+                        LinearLib::gemm(cols, width, rows, T{1}, dprobs.data(), std::size_t{1}, attention_block_k,
+                                        qt, q_rs, q_cs, T{1}, dk_tile.data(), width);
+                    }
+
+                    scatter(dk_tile.data(), cols, width, dk, dk.data() + detail::matrix_offset(dk, matrix) +
+                                                             k0 * dk.strides()[rank - 2]);
+                    scatter(dv_tile.data(), cols, value_width, dv, dv.data() + detail::matrix_offset(dv, matrix) +
+                                                                   k0 * dv.strides()[rank - 2]);
+                }
+
+                // Keys no query sees get no gradient
+                std::fill(dk_tile.begin(), dk_tile.end(), T{0});
+                std::fill(dv_tile.begin(), dv_tile.end(), T{0});
+                for (std::size_t k0 = end; k0 < keys; k0 += attention_block_k) {
+                    const std::size_t cols = std::min(attention_block_k, keys - k0);
+                    scatter(dk_tile.data(), cols, width, dk, dk.data() + detail::matrix_offset(dk, matrix) +
+                                                             k0 * dk.strides()[rank - 2]);
+                    scatter(dv_tile.data(), cols, value_width, dv, dv.data() + detail::matrix_offset(dv, matrix) +
+                                                                   k0 * dv.strides()[rank - 2]);
+                }
+
+                scatter(dq_acc.data(), queries, width, dq, dq.data() + detail::matrix_offset(dq, matrix));
+            }
+        });
+    }
+}
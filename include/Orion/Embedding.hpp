@@ -0,0 +1,345 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <immintrin.h>
+#endif
+
+#include "LinearLib/Gemm.hpp"
+#include "LinearLib/Tensor.hpp"
+#include "LinearLib/ThreadPool.hpp"
+#include "Orion/Parameter.hpp"
+#include "Orion/PositionalEncoding.hpp"
+
+namespace Orion {
+    /// Rows requested ahead of the one being copied, enough to hide a DRAM miss behind a 512-wide row copy.
+    inline constexpr std::size_t embedding_prefetch = 4;
+
+    /// Elements copied per gather task.
+    inline constexpr std::size_t embedding_grain = 1 << 15;
+
+    namespace detail {
+        inline void prefetch(const void* address) {
+#if defined(_MSC_VER) && !defined(__clang__)
+            _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+            __builtin_prefetch(address, 0, 3);
+#endif
+        }
+
+        /// Requests every cache line of a row.
+        template<typename T>
+        void prefetch_row(const T* row, std::size_t const width) {
+            constexpr std::size_t line = 64 / sizeof(T);
+            for (std::size_t j = 0; j < width; j += line) {
+                prefetch(row + j);
+            }
+        }
+
+        inline void require_tokens(const LinearLib::Tensor<std::size_t>& tokens, std::size_t const vocab) {
+            const std::size_t* ids = tokens.data();
+            if (std::any_of(ids, ids + tokens.size(), [vocab](std::size_t const id) { return id >= vocab; })) {
+                throw std::out_of_range("Token id outside the vocabulary");
+            }
+        }
+
+        /// Calls write(i, row) with the table row of every token, rows a few tokens ahead are prefetched since
+        /// consecutive ids land anywhere in the table.
+        template<typename T, typename F>
+        void gather_rows(const T* table, std::size_t const width, std::span<const std::size_t> const tokens,
+                         F&& write) {
+            const std::size_t grain = std::max<std::size_t>(1, embedding_grain / std::max<std::size_t>(width, 1));
+
+            LinearLib::parallelFor(0, tokens.size(), grain, [&](std::size_t const lo, std::size_t const hi) {
+                for (std::size_t i = lo; i < std::min(hi, lo + embedding_prefetch); i++) {
+                    prefetch_row(table + tokens[i] * width, width);
+                }
+                for (std::size_t i = lo; i < hi; i++) {
+                    if (i + embedding_prefetch < hi) {
+                        prefetch_row(table + tokens[i + embedding_prefetch] * width, width);
+                    }
+                    write(i, table + tokens[i] * width);
+                }
+            });
+        }
+    }
+
+    /**
+     * Copies the table rows of a sequence of ids.
+     * @param table [vocab, width], contiguous.
+     * @param out tokens.size() x width, contiguous.
+     */
+    template<std::floating_point T>
+    void gather(const T* table, std::size_t const width, std::span<const std::size_t> const tokens, T* out) {
+        detail::gather_rows(table, width, tokens, [&](std::size_t const i, const T* row) {
+            std::copy_n(row, width, out + i * width);
+        });
+    }
+
+    /**
+     * Gathers, scales and adds positional encodings in one pass, out_i = scale * table[token_i] + encoding of the
+     * position of token i within its sequence.
+     * @param sequence Tokens per sequence, consecutive sequences restart at position offset.
+     * @param encodings Rows offset, offset + 1, ... of sequence positions.
+     */
+    template<std::floating_point T>
+    void gather_encoded(const T* table, std::size_t const width, std::span<const std::size_t> const tokens,
+                        std::size_t const sequence, const T* encodings, T const scale, T* out) {
+        detail::gather_rows(table, width, tokens, [&](std::size_t const i, const T* row) {
+            const T* encoding = encodings + i % sequence * width;
+            T* o = out + i * width;
+            for (std::size_t j = 0; j < width; j++) {
+                o[j] = scale * row[j] + encoding[j];
+            }
+        });
+    }
+
+    /**
+     * Gradient of the rows of a table that were actually used. Rows are kept in the order they were first touched
+     * with a dense row -> slot index, so accumulating is constant time and clearing only visits touched rows.
+     */
+    template<std::floating_point T>
+    class SparseGradient {
+    public:
+        SparseGradient(std::size_t const rows, std::size_t const width)
+            : n_width(width), slots(rows, untouched) {}
+
+        [[nodiscard]] std::size_t width() const {
+            return n_width;
+        }
+
+        /// Number of touched rows.
+        [[nodiscard]] std::size_t size() const {
+            return touched.size();
+        }
+
+        [[nodiscard]] bool empty() const {
+            return touched.empty();
+        }
+
+        /// Touched rows, the i-th one's gradient is values(i).
+        [[nodiscard]] std::span<const std::size_t> rows() const {
+            return touched;
+        }
+
+        [[nodiscard]] std::span<const T> values(std::size_t const i) const {
+            return std::span<const T>(gradients.data() + i * n_width, n_width);
+        }
+
+        /// Adds scale times a gradient row of width elements to a row.
+        void accumulate(std::size_t const row, const T* gradient, T const scale = 1) {
+            std::size_t& slot = slots[row];
+            if (slot == untouched) {
+                slot = touched.size();
+                touched.push_back(row);
+                gradients.resize(gradients.size() + n_width, T{0});
+            }
+
+            T* values = gradients.data() + slot * n_width;
+            for (std::size_t j = 0; j < n_width; j++) {
+                values[j] += scale * gradient[j];
+            }
+        }
+
+        /// dense[row] += scale * gradient for every touched row, with scale = -learning rate an SGD step.
+        void scatter_add(LinearLib::Tensor<T>& dense, T const scale = 1) const {
+            if (dense.rank() != 2 || dense.shape(0) != slots.size() || dense.shape(1) != n_width ||
+                !dense.isContiguous()) {
+                throw std::invalid_argument("Sparse gradient must be scattered into a contiguous table of its shape");
+            }
+
+            LinearLib::parallelFor(0, touched.size(), 1, [&](std::size_t const lo, std::size_t const hi) {
+                for (std::size_t i = lo; i < hi; i++) {
+                    T* row = dense.data() + touched[i] * n_width;
+                    const T* values = gradients.data() + i * n_width;
+                    for (std::size_t j = 0; j < n_width; j++) {
+                        row[j] += scale * values[j];
+                    }
+                }
+            });
+        }
+
+        void clear() {
+            for (std::size_t const row : touched) {
+                slots[row] = untouched;
+            }
+            touched.clear();
+            gradients.clear();
+        }
+
+    private:
+        static constexpr std::size_t untouched = std::numeric_limits<std::size_t>::max();
+
+        std::size_t n_width;
+        std::vector<std::size_t> slots;
+        std::vector<std::size_t> touched;
+        std::vector<T> gradients;
+    };
+
+    /**
+     * Token embedding table. Backward passes only accumulate the rows the batch used, so a step costs as much as
+     * the batch rather than the vocabulary. The same table can serve as the pre-softmax projection, as in
+     * "Attention Is All You Need"; that projection touches every row, so its gradient is kept dense and apart.
+     */
+    template<std::floating_point T = float>
+    class Embedding {
+        using Tensor = LinearLib::Tensor<T>;
+        using Shape = typename Tensor::Shape;
+
+    public:
+        /// [vocab, d_model]
+        Tensor weight;
+
+        /// Uniform weights with variance 1 / d_model.
+        /// @param seed Seed of the weights, tables constructed without one each get their own from layer_seed().
+        Embedding(std::size_t const vocab, std::size_t const d_model,
+                  std::optional<std::size_t> const seed = std::nullopt)
+            : weight(Tensor::random({vocab, d_model}, -std::sqrt(T{3} / static_cast<T>(d_model)),
+                                    std::sqrt(T{3} / static_cast<T>(d_model)),
+                                    weight_seed(seed.value_or(layer_seed()), 0))),
+              sparse(vocab, d_model) {}
+
+        [[nodiscard]] std::size_t vocab() const {
+            return weight.shape(0);
+        }
+
+        [[nodiscard]] std::size_t d_model() const {
+            return weight.shape(1);
+        }
+
+        /// Gradient of the rows looked up since the last zero_grad.
+        [[nodiscard]] const SparseGradient<T>& grad() const {
+            return sparse;
+        }
+
+        /// Gradient of the table through project since the last zero_grad, empty if it was not used.
+        [[nodiscard]] const Tensor& projection_grad() const {
+            return dense;
+        }
+
+        /// @param tokens Ids of any shape.
+        /// @return tokens' shape + [d_model]
+        Tensor forward(const LinearLib::Tensor<std::size_t>& tokens) {
+            detail::require_tokens(tokens, vocab());
+            ids = tokens.clone();
+            scale = 1;
+
+            Shape shape(tokens.shape());
+            shape.push_back(d_model());
+
+            Tensor res{std::move(shape)};
+            gather(weight.data(), d_model(), std::span<const std::size_t>(ids.data(), ids.size()), res.data());
+            return res;
+        }
+
+        /**
+         * Embeddings scaled by sqrt(d_model) plus positional encodings, as the paper feeds the encoder and decoder,
+         * formed while the rows are gathered.
+         * @param tokens [..., sequence]
+         * @param offset Position of each sequence's first token, e.g. the tokens already decoded.
+         * @return tokens' shape + [d_model]
+         */
+        Tensor forward(const LinearLib::Tensor<std::size_t>& tokens, const PositionalEncoding<T>& positions,
+                       std::size_t const offset = 0) {
+            if (tokens.rank() == 0 || positions.d_model() != d_model()) {
+                throw std::invalid_argument("Positional encodings must match d_model and the tokens a sequence");
+            }
+
+            const std::size_t sequence = tokens.shape(tokens.rank() - 1);
+            if (offset + sequence > positions.max_length()) {
+                throw std::out_of_range("Sequence beyond the encoding's maximum length");
+            }
+
+            detail::require_tokens(tokens, vocab());
+            ids = tokens.clone();
+            scale = std::sqrt(static_cast<T>(d_model()));
+
+            Shape shape(tokens.shape());
+            shape.push_back(d_model());
+
+            Tensor res{std::move(shape)};
+            if (sequence > 0) {
+                gather_encoded(weight.data(), d_model(), std::span<const std::size_t>(ids.data(), ids.size()),
+                               sequence, positions.table().data() + offset * d_model(), scale, res.data());
+            }
+            return res;
+        }
+
+        /// Accumulates the gradient of the last forward pass' rows.
+        void backward(const Tensor& grad) {
+            if (ids.empty() || grad.size() != ids.size() * d_model() || grad.shape(grad.rank() - 1) != d_model()) {
+                throw std::invalid_argument("Embedding gradient must match the last forward output");
+            }
+
+            const Tensor g = grad.contiguous();
+            for (std::size_t i = 0; i < ids.size(); i++) {
+                sparse.accumulate(ids.data()[i], g.data() + i * d_model(), scale);
+            }
+        }
+
+        /// Logits x W^T of the tied pre-softmax projection.
+        /// @param x [..., d_model]
+        /// @return [..., vocab]
+        Tensor project(const Tensor& x) {
+            if (x.rank() == 0 || x.shape(x.rank() - 1) != d_model()) {
+                throw std::invalid_argument("Projection input must end in d_model");
+            }
+            projected = x.clone();
+
+            Shape shape(x.shape());
+            shape.back() = vocab();
+
+            Tensor res{std::move(shape)};
+            LinearLib::gemm(projected.size() / d_model(), vocab(), d_model(), T{1}, projected.data(), d_model(),
+                            std::size_t{1}, weight.data(), std::size_t{1}, d_model(), T{0}, res.data(), vocab());
+            return res;
+        }
+
+        /// Accumulates the table's dense projection gradient of the last project call.
+        /// @return Gradient of its input.
+        Tensor project_backward(const Tensor& grad) {
+            const std::size_t rows = projected.size() / d_model();
+            if (projected.empty() || grad.size() != rows * vocab() || grad.shape(grad.rank() - 1) != vocab()) {
+                throw std::invalid_argument("Projection gradient must match the last project output");
+            }
+
+            const Tensor g = grad.contiguous();
+            if (dense.empty()) {
+                dense = Tensor::zeros(weight.shape());
+            }
+
+            LinearLib::gemm(vocab(), d_model(), rows, T{1}, g.data(), std::size_t{1}, vocab(), projected.data(),
+                            d_model(), std::size_t{1}, T{1}, dense.data(), d_model());
+
+            Tensor res{Shape(projected.shape())};
+            LinearLib::gemm(rows, d_model(), vocab(), T{1}, g.data(), vocab(), std::size_t{1}, weight.data(),
+                            d_model(), std::size_t{1}, T{0}, res.data(), d_model());
+            return res;
+        }
+
+        void zero_grad() {
+            sparse.clear();
+            if (!dense.empty()) {
+                dense.fill(T{0});
+            }
+        }
+
+    private:
+        SparseGradient<T> sparse;
+        Tensor dense;
+
+        // Forward state kept for the backward passes, copied so later writes to the inputs cannot change it
+        LinearLib::Tensor<std::size_t> ids;
+        T scale = 1;
+        Tensor projected;
+    };
+}
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "LinearLib/Gemm.hpp"
+#include "LinearLib/Softmax.hpp"
+#include "LinearLib/Tensor.hpp"
+#include "Orion/Attention.hpp"
+#include "Orion/Parameter.hpp"
+
+namespace Orion {
+    /**
+     * Multi-head attention of "Attention Is All You Need". The query, key and value projections share one
+     * [d_model, 3 d_model] weight so self-attention projects with a single GEMM, and cross-attention projects the
+     * queries and the keys and values with one GEMM each. Heads are strided views of the projections and attention
+     * writes straight into the merged layout, so splitting and merging heads copies nothing.
+     */
+    template<std::floating_point T = float>
+    class MultiHeadAttention {
+        using Tensor = LinearLib::Tensor<T>;
+        using Shape = typename Tensor::Shape;
+
+    public:
+        /// Columns Q | K | V, each holding the heads side by side.
+        Parameter<T> qkv_weight;
+        Parameter<T> qkv_bias;
+        Parameter<T> out_weight;
+        Parameter<T> out_bias;
+
+        /// Xavier uniform weights and zero biases.
+        /// @param seed Seed of the weights, layers constructed without one each get their own from layer_seed().
+        MultiHeadAttention(std::size_t const d_model, std::size_t const heads,
+                           std::optional<std::size_t> const seed = std::nullopt)
+            : qkv_bias(Tensor::zeros({3 * d_model})), out_bias(Tensor::zeros({d_model})), model(d_model),
+              n_heads(heads) {
+            if (heads == 0 || d_model % heads != 0) {
+                throw std::invalid_argument("d_model must be a multiple of the number of heads");
+            }
+
+            const std::size_t layer = seed.has_value() ? *seed : layer_seed();
+            qkv_weight = Parameter<T>(xavier({d_model, 3 * d_model}, weight_seed(layer, 0)));
+            out_weight = Parameter<T>(xavier({d_model, d_model}, weight_seed(layer, 1)));
+        }
+
+        [[nodiscard]] std::size_t d_model() const {
+            return model;
+        }
+
+        [[nodiscard]] std::size_t heads() const {
+            return n_heads;
+        }
+
+        [[nodiscard]] std::array<Parameter<T>*, 4> parameters() {
+            return {&qkv_weight, &qkv_bias, &out_weight, &out_bias};
+        }
+
+        /// Self-attention over x.
+        /// @param x [batch, sequence, d_model]
+        /// @param mask Causal mask and per batch key lengths.
+        /// @return [batch, sequence, d_model]
+        Tensor forward(const Tensor& x, const LinearLib::SoftmaxMask& mask = {}) {
+            require_input(x);
+
+            projections = {project(x, 0, 3 * model)};
+            return attend(projections[0], 0, projections[0], 1, mask);
+        }
+
+        /// Cross-attention of x's queries over memory's keys and values.
+        /// @param x [batch, queries, d_model]
+        /// @param memory [batch, keys, d_model], e.g. the encoder output.
+        /// @return [batch, queries, d_model]
+        Tensor forward(const Tensor& x, const Tensor& memory, const LinearLib::SoftmaxMask& mask = {}) {
+            require_input(x);
+            require_input(memory);
+            if (memory.shape(0) != x.shape(0)) {
+                throw std::invalid_argument("Attention memory must share the input's batch size");
+            }
+
+            projections = {project(x, 0, model), project(memory, model, 2 * model)};
+            return attend(projections[0], 0, projections[1], 0, mask);
+        }
+
+        /**
+         * Accumulates the parameter gradients of the last forward pass.
+         * @param grad Gradient of its output.
+         * @return Gradient of x, for cross-attention the gradient of memory is left in memory_grad().
+         */
+        Tensor backward(const Tensor& grad) {
+            if (projections.empty() || grad.shape() != context.shape()) {
+                throw std::invalid_argument("Attention gradient must match the last forward output");
+            }
+
+            const Tensor g = grad.contiguous();
+            const std::size_t rows = g.size() / model;
+
+            // Output projection
+            accumulate_column_sums(g.data(), rows, model, out_bias.grad.data());
+            LinearLib::gemm(model, model, rows, T{1}, context.data(), std::size_t{1}, model, g.data(), model,
+                            std::size_t{1}, T{1}, out_weight.grad.data(), model);
+
+            Tensor d_context{Shape(context.shape())};
+            LinearLib::gemm(rows, model, model, T{1}, g.data(), model, std::size_t{1}, out_weight.value.data(),
+                            std::size_t{1}, model, T{0}, d_context.data(), model);
+
+            // Attention, its gradients land in the projections' layout
+            std::vector<Tensor> d_projections;
+            for (const Projection& projection : projections) {
+                d_projections.emplace_back(Shape(projection.output.shape()));
+            }
+
+            const bool cross = projections.size() == 2;
+            Tensor dq = heads_of(d_projections[0], 0);
+            Tensor dk = heads_of(d_projections.back(), cross ? 0 : 1);
+            Tensor dv = heads_of(d_projections.back(), cross ? 1 : 2);
+
+            const std::vector<Projection>& inputs = projections;
+            attention_backward(heads_of(inputs[0].output, 0), heads_of(inputs.back().output, cross ? 0 : 1),
+                               heads_of(inputs.back().output, cross ? 1 : 2), heads_of(std::as_const(context), 0), lse,
+                               heads_of(std::as_const(d_context), 0), dq, dk, dv, mask());
+
+            // Input projections
+            std::vector<Tensor> d_inputs;
+            for (std::size_t p = 0; p < projections.size(); p++) {
+                const Projection& projection = projections[p];
+                const Tensor& d_out = d_projections[p];
+                const std::size_t n = projection.width;
+                const std::size_t m = projection.input.size() / model;
+
+                accumulate_column_sums(d_out.data(), m, n, qkv_bias.grad.data() + projection.column);
+                LinearLib::gemm(model, n, m, T{1}, projection.input.data(), std::size_t{1}, model, d_out.data(), n,
+                                std::size_t{1}, T{1}, qkv_weight.grad.data() + projection.column, 3 * model);
+
+                Tensor& d_input = d_inputs.emplace_back(Shape(projection.input.shape()));
+                LinearLib::gemm(m, model, n, T{1}, d_out.data(), n, std::size_t{1},
+                                qkv_weight.value.data() + projection.column, std::size_t{1}, 3 * model, T{0},
+                                d_input.data(), model);
+            }
+
+            memory_gradient = cross ? d_inputs[1] : Tensor();
+            return d_inputs[0];
+        }
+
+        /// Gradient of the memory of the last cross-attention backward pass.
+        [[nodiscard]] const Tensor& memory_grad() const {
+            return memory_gradient;
+        }
+
+        void zero_grad() {
+            for (Parameter<T>* parameter : parameters()) {
+                parameter->zero_grad();
+            }
+        }
+
+    private:
+        /// Input times a column range of qkv_weight, plus bias.
+        struct Projection {
+            /// Copy of the layer input for the weight gradient, unaffected by later writes to the caller's tensor.
+            Tensor input;
+            Tensor output;
+            std::size_t column;
+            std::size_t width;
+        };
+
+        std::size_t model;
+        std::size_t n_heads;
+
+        // Forward state kept for the backward pass
+        std::vector<Projection> projections;
+        Tensor context;
+        Tensor lse;
+        bool causal = false;
+        std::size_t offset = 0;
+        std::vector<std::size_t> lengths;
+        Tensor memory_gradient;
+
+        static Tensor xavier(Shape shape, std::size_t const seed) {
+            const T limit = std::sqrt(T{6} / static_cast<T>(shape[0] + shape[1]));
+            return Tensor::random(std::move(shape), -limit, limit, seed);
+        }
+
+        [[nodiscard]] LinearLib::SoftmaxMask mask() const {
+            return {.causal = causal, .offset = offset, .lengths = lengths};
+        }
+
+        void require_input(const Tensor& x) const {
+            if (x.rank() != 3 || x.shape(2) != model) {
+                throw std::invalid_argument("Attention input must be [batch, sequence, d_model]");
+            }
+        }
+
+        static void accumulate_column_sums(const T* x, std::size_t const rows, std::size_t const cols, T* sums) {
+            for (std::size_t i = 0; i < rows; i++) {
+                for (std::size_t j = 0; j < cols; j++) {
+                    sums[j] += x[i * cols + j];
+                }
+            }
+        }
+
+        Projection project(const Tensor& x, std::size_t const column, std::size_t const width) const {
+            Projection res{x.clone(), Tensor{Shape{x.shape(0), x.shape(1), width}}, column, width};
+
+            const std::size_t rows = x.shape(0) * x.shape(1);
+            T* out = res.output.data();
+            for (std::size_t i = 0; i < rows; i++) {
+                std::copy_n(qkv_bias.value.data() + column, width, out + i * width);
+            }
+
+            LinearLib::gemm(rows, width, model, T{1}, res.input.data(), model, std::size_t{1},
+                            qkv_weight.value.data() + column, 3 * model, std::size_t{1}, T{1}, out, width);
+            return res;
+        }
+
+        /// [batch, heads, sequence, head width] view of the part-th d_model columns of a [batch, sequence, n * d_model]
+        /// projection that is only read.
+        Tensor heads_of(const Tensor& projection, std::size_t const part) const {
+            const std::size_t parts = projection.shape(2) / model;
+            return projection.view({projection.shape(0), projection.shape(1), parts, n_heads, model / n_heads})
+                    .permute({2, 0, 3, 1, 4})[part];
+        }
+
+        /// Heads of a projection written through the view, such as the context or the projection gradients.
+        Tensor heads_of(Tensor& projection, std::size_t const part) const {
+            return heads_of(std::as_const(projection), part);
+        }
+
+        Tensor attend(const Projection& queries, std::size_t const q_part, const Projection& keys,
+                      std::size_t const k_part, const LinearLib::SoftmaxMask& attention_mask) {
+            causal = attention_mask.causal;
+            offset = attention_mask.offset;
+            lengths.assign(attention_mask.lengths.begin(), attention_mask.lengths.end());
+
+            const std::size_t batch = queries.output.shape(0);
+            const std::size_t sequence = queries.output.shape(1);
+
+            // Heads write into their columns of the merged [batch, sequence, d_model] context
+            context = Tensor{Shape{batch, sequence, model}};
+            lse = Tensor{Shape{batch, n_heads, sequence}};
+
+            Tensor merged = heads_of(context, 0);
+            attention(heads_of(queries.output, q_part), heads_of(keys.output, k_part),
+                      heads_of(keys.output, k_part + 1), merged, lse, mask());
+
+            Tensor res{Shape{batch, sequence, model}};
+            const std::size_t rows = batch * sequence;
+            for (std::size_t i = 0; i < rows; i++) {
+                std::copy_n(out_bias.value.data(), model, res.data() + i * model);
+            }
+            LinearLib::gemm(rows, model, model, T{1}, context.data(), model, std::size_t{1}, out_weight.value.data(),
+                            model, std::size_t{1}, T{1}, res.data(), model);
+            return res;
+        }
+    };
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "LinearLib/Tensor.hpp"
+
+namespace Orion {
+    namespace detail {
+        /// SplitMix64 finalizer, nearby inputs give unrelated outputs.
+        constexpr std::uint64_t mix_seed(std::uint64_t x) {
+            x += 0x9e3779b97f4a7c15;
+            x = (x ^ x >> 30) * 0xbf58476d1ce4e5b9;
+            x = (x ^ x >> 27) * 0x94d049bb133111eb;
+            return x ^ x >> 31;
+        }
+    }
+
+    /// Seed of the stream-th tensor initialized by a layer seeded with seed. Consecutive layer seeds and the tensors of
+    /// one layer all draw from unrelated random streams.
+    constexpr std::size_t weight_seed(std::size_t const seed, std::size_t const stream) {
+        return static_cast<std::size_t>(detail::mix_seed(detail::mix_seed(seed) + stream));
+    }
+
+    /// Seed of a layer constructed without one. Every call returns another, so layers built one after another start
+    /// from different weights, in the same order on every run.
+    inline std::size_t layer_seed() {
+        static std::atomic<std::uint64_t> layers = 0;
+        return static_cast<std::size_t>(detail::mix_seed(~layers.fetch_add(1)));
+    }
+
+    /// Trainable tensor and the gradient its layer's backward passes accumulate into.
+    template<std::floating_point T>
+    struct Parameter {
+        LinearLib::Tensor<T> value;
+        LinearLib::Tensor<T> grad;
+
+        Parameter() = default;
+
+        explicit Parameter(LinearLib::Tensor<T> init)
+            : value(std::move(init)), grad(LinearLib::Tensor<T>::zeros(value.shape())) {}
+
+        void zero_grad() {
+            grad.fill(T{0});
+        }
+    };
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <numbers>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "LinearLib/Matrix.hpp"
+#include "LinearLib/Tensor.hpp"
+#include "LinearLib/ThreadPool.hpp"
+
+namespace Orion {
+    namespace detail {
+        /// ln 10000, the base of the encoding's wavelengths.
+        inline constexpr double log_wavelength = 9.21034037197618273607;
+
+        /// Taylor series of e^x after reducing x by multiples of ln 2, exact to a few ulp; usable in constant
+        /// expressions where std::exp is not.
+        constexpr double exp(double const x) {
+            const double n = static_cast<double>(static_cast<long long>(x / std::numbers::ln2 + (x < 0 ? -0.5 : 0.5)));
+            const double r = x - n * std::numbers::ln2;
+
+            double sum = 1;
+            double term = 1;
+            for (int k = 1; k < 30 && term != 0; k++) {
+                term *= r / k;
+                sum += term;
+            }
+
+            for (long long i = 0; i < static_cast<long long>(n); i++) {
+                sum *= 2;
+            }
+            for (long long i = 0; i > static_cast<long long>(n); i--) {
+                sum /= 2;
+            }
+            return sum;
+        }
+
+        /// Taylor series of sin(x + phase) after reducing x to [-pi, pi], phase being 0 or pi / 2.
+        constexpr double sinusoid(double const x, bool const cosine) {
+            constexpr double two_pi = 2 * std::numbers::pi;
+            const double n = static_cast<double>(static_cast<long long>(x / two_pi + (x < 0 ? -0.5 : 0.5)));
+            const double r = x - n * two_pi;
+
+            double sum = cosine ? 1 : r;
+            double term = sum;
+            for (int k = cosine ? 1 : 2; k < 60 && term != 0; k += 2) {
+                term *= -r * r / (k * (k + 1));
+                sum += term;
+            }
+            return sum;
+        }
+    }
+
+    /**
+     * Sinusoidal encoding of "Attention Is All You Need", sin(position / 10000^(2i / d_model)) in column 2i and the
+     * cosine of the same angle in column 2i + 1. Computed in double, at compile time when constant evaluated.
+     */
+    template<std::floating_point T = float>
+    constexpr T positional_encoding(std::size_t const position, std::size_t const column, std::size_t const d_model) {
+        const double exponent = -static_cast<double>(column / 2 * 2) / static_cast<double>(d_model);
+        const bool cosine = column % 2 == 1;
+
+        if (std::is_constant_evaluated()) {
+            const double angle = static_cast<double>(position) * detail::exp(exponent * detail::log_wavelength);
+            return static_cast<T>(detail::sinusoid(angle, cosine));
+        }
+
+        const double angle = static_cast<double>(position) * std::pow(10000.0, exponent);
+        return static_cast<T>(cosine ? std::cos(angle) : std::sin(angle));
+    }
+
+    /// Encoding of positions 0 to L - 1 for a fixed size model, e.g. constexpr auto pe = positional_encoding<64, 16>().
+    template<std::size_t L, std::size_t D, std::floating_point T = float>
+    constexpr LinearLib::Matrix<L, D, T> positional_encoding() {
+        LinearLib::Matrix<L, D, T> res{};
+        for (std::size_t i = 0; i < L; i++) {
+            for (std::size_t j = 0; j < D; j++) {
+                res.data[i][j] = positional_encoding<T>(i, j, D);
+            }
+        }
+        return res;
+    }
+
+    /// Positional encodings of every position up to a maximum length, computed once into a contiguous, 64 byte
+    /// aligned [max_length, d_model] table.
+    template<std::floating_point T = float>
+    class PositionalEncoding {
+        using Tensor = LinearLib::Tensor<T>;
+
+    public:
+        PositionalEncoding(std::size_t const max_length, std::size_t const d_model)
+            : encodings(typename Tensor::Shape{max_length, d_model}) {
+            // The frequencies are shared by every position
+            std::vector<double> frequencies(d_model);
+            for (std::size_t j = 0; j < d_model; j++) {
+                frequencies[j] = std::pow(10000.0, -static_cast<double>(j / 2 * 2) / static_cast<double>(d_model));
+            }
+
+            T* out = encodings.data();
+            LinearLib::parallelFor(0, max_length, 64, [&](std::size_t const lo, std::size_t const hi) {
+                for (std::size_t i = lo; i < hi; i++) {
+                    for (std::size_t j = 0; j < d_model; j++) {
+                        const double angle = static_cast<double>(i) * frequencies[j];
+                        out[i * d_model + j] = static_cast<T>(j % 2 == 1 ? std::cos(angle) : std::sin(angle));
+                    }
+                }
+            });
+        }
+
+        /// Copies a fixed size table, e.g. one computed at compile time by positional_encoding<L, D>().
+        template<std::size_t L, std::size_t D>
+        explicit PositionalEncoding(const LinearLib::Matrix<L, D, T>& table)
+            : encodings(typename Tensor::Shape{L, D}) {
+            std::copy_n(table.data[0].data(), L * D, encodings.data());
+        }
+
+        [[nodiscard]] std::size_t max_length() const {
+            return encodings.shape(0);
+        }
+
+        [[nodiscard]] std::size_t d_model() const {
+            return encodings.shape(1);
+        }
+
+        [[nodiscard]] const Tensor& table() const {
+            return encodings;
+        }
+
+        /// Encoding of a position, d_model contiguous elements.
+        [[nodiscard]] const T* row(std::size_t const position) const {
+            if (position >= max_length()) {
+                throw std::out_of_range("Position beyond the encoding's maximum length");
+            }
+            return encodings.data() + position * d_model();
+        }
+
+    private:
+        Tensor encodings;
+    };
+}
@@ -1,15 +1,27 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cctype>
+#include <cstdint>
+#include <functional>
 #include <map>
 #include <optional>
+#include <queue>
+#include <ranges>
 #include <set>
+#include <span>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
+#include "Dast/collections/IndexList.hpp"
 #include "Dast/collections/LinkedList.hpp"
+#include "Dast/collections/SmallVector.hpp"
 
 class Tokenizer {
 public:
@@ -24,20 +36,33 @@ public:
     virtual ~Tokenizer() = default;
 };
 
-inline std::vector<std::vector<Dast::LinkedList<int>>> normalize(const std::vector<std::string>& raw, const bool lower) {
+/// Symbols of a word, kept inline for words of up to 15 characters so most words never allocate.
+using Symbols = Dast::SmallVector<int, 15>;
+
+/// Word whose nodes are drawn from an arena, dropping it leaves the nodes for the arena to release in bulk.
+using ArenaWord = Dast::LinkedList<int, Dast::ArenaAllocator<int>>;
+
+/// Splits sentences into words of letters.
+/// @param raw Raw sentences.
+/// @param lower Normalize to lower case.
+/// @param make_word Creates an empty word.
+/// @return Sentence -> word -> letters
+template<typename MakeWord>
+auto normalize_with(const std::vector<std::string>& raw, const bool lower, MakeWord&& make_word) {
+    using Word = std::invoke_result_t<MakeWord&>;
 
     // Sentence -> word -> letters (as linked string chars)
-    std::vector<std::vector<Dast::LinkedList<int>>> res;
+    std::vector<std::vector<Word>> res;
     res.reserve(raw.size());
 
     for (const std::string& sentence : raw) {
-        std::vector<Dast::LinkedList<int>> normalized;
+        std::vector<Word> normalized;
 
         std::stringstream ss(sentence);
         std::string word;
         while (getline(ss, word, ' ')) {
 
-            Dast::LinkedList<int> curr;
+            Word curr = make_word();
 
             for (const char& c : word) {
                 if (std::isalpha(c)) {
@@ -45,9 +70,9 @@ inline std::vector<std::vector<Dast::LinkedList<int>>> normalize(const std::vect
                 } else if (word.length() > 1) {
                     if (!curr.empty()) {
                         normalized.emplace_back(std::move(curr));
-                        curr.clear();
+                        curr = make_word();
                     }
-                    normalized.emplace_back(Dast::LinkedList{static_cast<int>(c)});
+                    normalized.emplace_back(make_word()).push_back(static_cast<int>(c));
                 }
             }
 
@@ -56,98 +81,430 @@ inline std::vector<std::vector<Dast::LinkedList<int>>> normalize(const std::vect
             }
         }
 
-        res.emplace_back(normalized);
+        res.emplace_back(std::move(normalized));
     }
 
     return res;
 }
 
+/// Splits sentences into words of letters.
+/// @tparam Word Sequence of letters, e.g. Dast::LinkedList<int> or Symbols.
+/// @param raw Raw sentences.
+/// @param lower Normalize to lower case.
+/// @return Sentence -> word -> letters
+template<typename Word = Dast::LinkedList<int>>
+std::vector<std::vector<Word>> normalize(const std::vector<std::string>& raw, const bool lower) {
+    return normalize_with(raw, lower, [] { return Word(); });
+}
+
+/// Splits sentences into words of letters whose nodes are drawn from an arena, so the result is torn down without
+/// freeing node by node and its memory is returned at once by releasing the arena.
+/// @param raw Raw sentences.
+/// @param lower Normalize to lower case.
+/// @param arena Arena the nodes are drawn from, must outlive the result.
+/// @return Sentence -> word -> letters
+inline std::vector<std::vector<ArenaWord>> normalize(const std::vector<std::string>& raw, const bool lower, Dast::Arena& arena) {
+    return normalize_with(raw, lower, [&arena] { return ArenaWord(Dast::ArenaAllocator<int>(arena)); });
+}
+
+/// Splits a sentence into words using the same rules as `normalize`: runs of letters form a word and every other
+/// character of a multi-character word becomes a word of its own.
+/// @param sentence Raw sentence.
+/// @param lower Normalize to lower case.
+/// @param emit Invoked with each word, the view is only valid for the duration of the call.
+template<typename F>
+void for_each_word(const std::string_view sentence, const bool lower, F&& emit) {
+    std::string curr;
+    std::size_t start = 0;
+
+    while (start < sentence.size()) {
+        std::size_t end = sentence.find(' ', start);
+        if (end == std::string_view::npos) {
+            end = sentence.size();
+        }
+
+        const std::string_view word = sentence.substr(start, end - start);
+
+        for (std::size_t i = 0; i < word.size(); i++) {
+            if (const auto c = static_cast<unsigned char>(word[i]); std::isalpha(c)) {
+                curr += lower ? static_cast<char>(std::tolower(c)) : word[i];
+            } else if (word.length() > 1) {
+                if (!curr.empty()) {
+                    emit(std::string_view(curr));
+                    curr.clear();
+                }
+                emit(word.substr(i, 1));
+            }
+        }
+
+        if (!curr.empty()) {
+            emit(std::string_view(curr));
+            curr.clear();
+        }
+
+        start = end + 1;
+    }
+}
+
 struct pair_hash {
     std::size_t operator()(const std::pair<int, int>& p) const {
         return std::hash<int>()(p.first) ^ std::hash<int>()(p.second) << 1;
     }
 };
 
+/// Sentences of a corpus, viewed without copying.
+using Corpus = std::span<const std::string>;
+
+/// Occurrences of every unique word over several corpora, gathered in a single pass so each word is stored once.
+class WordCounts {
+public:
+    /// Counts the words of each corpus.
+    /// @param corpora Corpora, e.g. the source and target side of a parallel corpus.
+    /// @param lower Normalize to lower case.
+    WordCounts(const std::span<const Corpus> corpora, const bool lower) : n_corpora(corpora.size()) {
+        std::unordered_map<std::string, std::size_t, string_hash, std::equal_to<>> index;
+
+        for (std::size_t corpus = 0; corpus < corpora.size(); corpus++) {
+            for (const std::string& sentence : corpora[corpus]) {
+                for_each_word(sentence, lower, [&](const std::string_view word) {
+                    auto it = index.find(word);
+                    if (it == index.end()) {
+                        it = index.emplace(word, words.size()).first;
+                        words.emplace_back(word);
+                        counts.resize(counts.size() + n_corpora);
+                    }
+                    counts[it->second * n_corpora + corpus]++;
+                });
+            }
+        }
+    }
+
+    WordCounts(const std::initializer_list<Corpus> corpora, const bool lower) : WordCounts(std::span(corpora.begin(), corpora.size()), lower) {}
+
+    /// @return Number of unique words
+    [[nodiscard]] std::size_t size() const {
+        return words.size();
+    }
+
+    /// @return Number of counted corpora
+    [[nodiscard]] std::size_t corpora() const {
+        return n_corpora;
+    }
+
+    [[nodiscard]] const std::string& word(const std::size_t index) const {
+        return words.at(index);
+    }
+
+    /// @return Occurrences of a word in a corpus
+    [[nodiscard]] std::uint64_t count(const std::size_t index, const std::size_t corpus) const {
+        return counts.at(index * n_corpora + corpus);
+    }
+
+    /// @return Occurrences of a word, weighted per corpus
+    [[nodiscard]] double count(const std::size_t index, const std::span<const double> weights) const {
+        double res = 0;
+        for (std::size_t corpus = 0; corpus < n_corpora; corpus++) {
+            res += weights[corpus] * static_cast<double>(counts[index * n_corpora + corpus]);
+        }
+        return res;
+    }
+
+private:
+    struct string_hash {
+        using is_transparent = void;
+
+        std::size_t operator()(const std::string_view str) const {
+            return std::hash<std::string_view>()(str);
+        }
+    };
+
+    std::vector<std::string> words;
+
+    // Row per word, column per corpus
+    std::vector<std::uint64_t> counts;
+    std::size_t n_corpora;
+};
+
+/// Controls for Byte Pair training.
+struct BytePairConfig {
+    /// Number of tokens, including special tokens.
+    unsigned int n_vocab = 37000;
+
+    /// Normalize to lower case when counting words.
+    bool lower = true;
+
+    /// Training stops once the most frequent pair occurs fewer times than this, at least 1.
+    unsigned int min_frequency = 2;
+
+    /// Tokens reserved ahead of the learned vocabulary.
+    std::vector<std::string> special_tokens = { "<pad>", "<s>", "</s>", "<unk>" };
+
+    /// Longest token in characters a merge may produce, 0 for no limit.
+    std::size_t max_token_length = 0;
+
+    /// Number of most frequent characters kept in the initial alphabet, 0 keeps every character. Characters left out
+    /// never take part in a merge.
+    std::size_t limit_alphabet = 0;
+};
+
 class BytePairTokenizer final : public Tokenizer {
 public:
-    /// Tokenizes raw data via Byte Pair algorithm.
+    /// Tokenizes raw data via Byte Pair algorithm, merging until the vocabulary is full.
     /// @param raw Raw sentences.
     /// @param n_vocab Number of tokens
     /// @param lower Normalize to lower case.
     /// @return Tokens
     [[nodiscard]] std::set<std::string> tokenize(const std::vector<std::string>& raw, const unsigned int n_vocab, const bool lower) const override {
+        return tokenize(raw, BytePairConfig{ .n_vocab = n_vocab, .lower = lower, .min_frequency = 1, .special_tokens = {} });
+    }
+
+    /// Tokenizes raw data via Byte Pair algorithm.
+    /// @param raw Raw sentences.
+    /// @param config Training controls.
+    /// @return Tokens, special tokens included
+    [[nodiscard]] static std::set<std::string> tokenize(const std::vector<std::string>& raw, const BytePairConfig& config) {
+        return train(WordCounts({ raw }, config.lower), std::array{ 1.0 }, config);
+    }
+
+    /// Trains a joint vocabulary over several corpora.
+    /// @param corpora Corpora, e.g. the source and target side of a parallel corpus.
+    /// @param weights Weight of each corpus.
+    /// @param config Training controls.
+    /// @return Tokens, special tokens included
+    [[nodiscard]] static std::set<std::string> tokenize(const std::span<const Corpus> corpora, const std::span<const double> weights, const BytePairConfig& config) {
+        return train(WordCounts(corpora, config.lower), weights, config);
+    }
+
+    /// Trains a vocabulary from word counts, several vocabularies (e.g. joint and per language) can be trained from a
+    /// single counting pass by varying the weights.
+    /// @param counts Word counts, already normalized.
+    /// @param weights Weight of each counted corpus, words only seen in corpora of weight 0 are left out.
+    /// @param config Training controls, lower casing is decided by the counts.
+    /// @return Tokens, special tokens included
+    [[nodiscard]] static std::set<std::string> train(const WordCounts& counts, const std::span<const double> weights, const BytePairConfig& config) {
+
+        if (weights.size() != counts.corpora()) {
+            throw std::invalid_argument("Expected one weight per corpus!");
+        }
+        if (config.min_frequency == 0) {
+            throw std::invalid_argument("Minimum frequency must be at least 1");
+        }
+
+        const std::size_t n_corpora = counts.corpora();
+
+        using Handle = Dast::IndexList<int>::Handle;
+        constexpr Handle npos = Dast::IndexList<int>::npos;
 
-        std::vector<std::vector<Dast::LinkedList<int>>> normalized = normalize(raw, lower);
+        struct Symbol {
+            int id;
+            std::uint32_t word;
+        };
 
-        std::cout << "Normalized data" << std::endl;
+        // Every word is a run of symbols in one contiguous list, so neighbours are found and unlinked in constant time
+        Dast::IndexList<Symbol> symbols;
+
+        // Row per kept word, column per corpus
+        std::vector<std::uint64_t> word_counts;
+
+        // Count characters so the alphabet can be limited to the most frequent ones
+        std::map<int, double> alphabet;
+        for (std::size_t i = 0; i < counts.size(); i++) {
+            const double count = counts.count(i, weights);
+            if (count <= 0) {
+                continue;
+            }
+
+            const auto word = static_cast<std::uint32_t>(word_counts.size() / n_corpora);
+            for (std::size_t corpus = 0; corpus < n_corpora; corpus++) {
+                word_counts.push_back(counts.count(i, corpus));
+            }
+
+            for (const char c : counts.word(i)) {
+                const int letter = static_cast<unsigned char>(c);
+                symbols.push_back({letter, word});
+                alphabet[letter] += count;
+            }
+            symbols.cut();
+        }
+
+        if (config.limit_alphabet > 0 && alphabet.size() > config.limit_alphabet) {
+            // Most frequent first, ties go to the lower character
+            std::vector<std::pair<int, double>> ranked(alphabet.begin(), alphabet.end());
+            std::ranges::stable_sort(ranked, std::greater{}, [](const auto& entry) { return entry.second; });
+
+            for (std::size_t i = config.limit_alphabet; i < ranked.size(); i++) {
+                alphabet.erase(ranked[i].first);
+            }
+
+            // Characters outside the alphabet are masked so no pair is ever formed with them
+            for (Symbol& symbol : symbols) {
+                if (!alphabet.contains(symbol.id)) {
+                    symbol.id = masked;
+                }
+            }
+        }
 
         // Use ordered map for better decoding
         std::map<int, std::pair<int, std::optional<int>>> defs = {};
+        std::unordered_map<int, std::size_t> lengths = {};
 
         // Add characters to vocab
         int max = 0;
-        for (const auto& sentence : normalized) {
-            for (const auto& word : sentence) {
-                for (const auto& letter : word) {
-                    max = std::max(max, letter);
-                    defs[letter] = std::make_pair(letter, std::optional<int>{});
-                }
+        for (const auto& letter : alphabet | std::views::keys) {
+            max = std::max(max, letter);
+            defs[letter] = std::make_pair(letter, std::optional<int>{});
+            lengths[letter] = 1;
+        }
+
+        std::set<std::string> specials(config.special_tokens.begin(), config.special_tokens.end());
+
+        // Get the occurrences of all pairings of characters once, counted per corpus along with where each pair occurs.
+        // Merges then only touch the occurrences of the merged pair instead of rescanning the corpus. Counts stay
+        // integral so a pair whose occurrences are all merged away drops to exactly zero, the corpus weights only enter
+        // a pair's frequency.
+        std::unordered_map<std::pair<int, int>, std::size_t, pair_hash> rows = {};
+        std::vector<std::uint64_t> pair_counts;
+        std::unordered_map<std::pair<int, int>, std::vector<Handle>, pair_hash> occurrences = {};
+
+        auto row_of = [&](const std::pair<int, int>& pair) {
+            const auto [it, inserted] = rows.try_emplace(pair, pair_counts.size() / n_corpora);
+            if (inserted) {
+                pair_counts.resize(pair_counts.size() + n_corpora, 0);
+            }
+            return it->second;
+        };
+
+        auto frequency = [&](const std::size_t row) {
+            double res = 0;
+            for (std::size_t corpus = 0; corpus < n_corpora; corpus++) {
+                res += weights[corpus] * static_cast<double>(pair_counts[row * n_corpora + corpus]);
+            }
+            return res;
+        };
+
+        auto occurs = [&](const std::size_t row) {
+            return std::any_of(pair_counts.begin() + row * n_corpora, pair_counts.begin() + (row + 1) * n_corpora,
+                               [](const std::uint64_t count) { return count > 0; });
+        };
+
+        // Adds or removes one occurrence of a pair within a word
+        auto count_pair = [&](const std::pair<int, int>& pair, const std::uint32_t word, const bool add) {
+            const std::size_t row = row_of(pair);
+            for (std::size_t corpus = 0; corpus < n_corpora; corpus++) {
+                const std::uint64_t in_word = word_counts[word * n_corpora + corpus];
+                std::uint64_t& count = pair_counts[row * n_corpora + corpus];
+                count = add ? count + in_word : count - in_word;
+            }
+        };
+
+        for (Handle handle = 0; handle < symbols.slot_count(); handle++) {
+            const Handle next = symbols.next(handle);
+            if (next != npos && symbols[handle].id != masked && symbols[next].id != masked) {
+                const std::pair pair(symbols[handle].id, symbols[next].id);
+                count_pair(pair, symbols[handle].word, true);
+                occurrences[pair].push_back(handle);
             }
         }
 
-        while (defs.size() < n_vocab) {
+        // Most frequent pair first, ties go to the lower pair so training does not depend on hashing order. Entries are
+        // pushed again whenever a count changes and skipped once they no longer match it.
+        struct Candidate {
+            double count;
+            std::pair<int, int> pair;
 
-            std::unordered_map<std::pair<int, int>, int, pair_hash> freqs = {};
+            bool operator<(const Candidate& other) const {
+                return count < other.count || (count == other.count && pair > other.pair);
+            }
+        };
 
-            // Get the frequencies of all pairings of characters
-            for (std::vector<Dast::LinkedList<int>>& sentence: normalized) {
-                for (Dast::LinkedList<int>& word : sentence) {
-                    Dast::Node<int>* node = word.get_ptr();
-                    while (node->next != nullptr) {
-                        freqs[std::pair(node->data, node->next->data)]++;
-                        node = node->next;
-                    }
-                }
+        std::priority_queue<Candidate> candidates;
+        for (const auto& [pair, row] : rows) {
+            candidates.push({frequency(row), pair});
+        }
+
+        std::vector<std::pair<int, int>> changed;
+        auto update = [&](const std::pair<int, int>& pair, const std::uint32_t word, const bool add, const Handle handle) {
+            count_pair(pair, word, add);
+            if (add) {
+                occurrences[pair].push_back(handle);
             }
+            changed.push_back(pair);
+        };
 
-            // If we do not get a frequency distribution it would indicate merging is complete.
-            if (freqs.empty()) {
-                break;
+        while (defs.size() + specials.size() < config.n_vocab && !candidates.empty()) {
+
+            const auto [mode, key] = candidates.top();
+            candidates.pop();
+
+            if (const auto it = rows.find(key); it == rows.end() || frequency(it->second) != mode) {
+                continue;
             }
 
-            // Add mode to defs
-            int mode = 0;
-            std::pair<int, int> key;
-            for (const auto&[freq_key, count] : freqs) {
-                if (count > mode) {
-                    mode = count;
-                    key = {freq_key.first, freq_key.second};
-                }
+            if (config.max_token_length > 0 && lengths[key.first] + lengths[key.second] > config.max_token_length) {
+                continue;
+            }
+
+            // Merging the best pair no longer pays off
+            if (mode < config.min_frequency) {
+                break;
             }
 
             max = max + 1;
             defs[max] = key;
+            lengths[max] = lengths[key.first] + lengths[key.second];
+
+            // Replace occurrences left to right, so overlapping ones merge the same way a scan of the word would
+            std::vector<Handle> positions = std::move(occurrences[key]);
+            occurrences.erase(key);
+            std::ranges::sort(positions);
 
-            // Replace occurrences in normalized with new
-            for (std::vector<Dast::LinkedList<int>>& sentence: normalized) {
-                for (Dast::LinkedList<int>& word : sentence) {
-                    auto node = word.get_ptr();
-
-                    while (node != nullptr && node->next != nullptr) {
-                        if (node->data == key.first && node->next->data == key.second) {
-                            Dast::Node<int>* next = node->next->next;
-                            node->data = max;
-                            delete node->next;
-                            node->next = next;
-                        }
-                        node = node->next;
+            changed.clear();
+            for (const Handle handle : positions) {
+                if (!symbols.alive(handle) || symbols[handle].id != key.first) {
+                    continue;
+                }
+
+                const Handle next = symbols.next(handle);
+                if (next == npos || symbols[next].id != key.second) {
+                    continue;
+                }
+
+                const std::uint32_t word = symbols[handle].word;
+
+                if (const Handle prev = symbols.prev(handle); prev != npos && symbols[prev].id != masked) {
+                    update({symbols[prev].id, key.first}, word, false, prev);
+                    update({symbols[prev].id, max}, word, true, prev);
+                }
+
+                if (const Handle after = symbols.next(next); after != npos && symbols[after].id != masked) {
+                    update({key.second, symbols[after].id}, word, false, handle);
+                    update({max, symbols[after].id}, word, true, handle);
+                }
+
+                symbols[handle].id = max;
+                symbols.erase(next);
+            }
+
+            // Every occurrence of the pair is gone, overlapping ones included
+            rows.erase(key);
+
+            std::ranges::sort(changed);
+            const auto [first, last] = std::ranges::unique(changed);
+            changed.erase(first, last);
+
+            for (const auto& pair : changed) {
+                if (const auto it = rows.find(pair); it != rows.end()) {
+                    if (occurs(it->second)) {
+                        candidates.push({frequency(it->second), pair});
+                    } else {
+                        rows.erase(it);
                     }
                 }
             }
         }
 
         // Decode in the order from least to greatest key
-        std::set<std::string> tokens = {};
+        std::set<std::string> tokens = std::move(specials);
         for (const auto&[encoding, comps] : defs) {
             tokens.emplace(decode(defs, comps));
         }
@@ -167,6 +524,309 @@ public:
 
         return val;
     }
+
+private:
+    // Symbol standing in for characters left out of a limited alphabet
+    static constexpr int masked = -1;
 };
 
+class WordPieceTokenizer final : public Tokenizer {
+public:
+    /// Prefix marking a piece that continues a word.
+    static constexpr std::string_view suffix_indicator = "##";
+
+    /// Encoder over an empty vocabulary, every word encodes to the unknown token until a trained vocabulary is loaded.
+    WordPieceTokenizer() : WordPieceTokenizer(std::set<std::string>{}) {}
+
+    /// Builds an encoder over a vocabulary, token ids follow the iteration order of the set.
+    /// @param vocab Tokens, pieces continuing a word carry the `##` prefix.
+    /// @param lower Normalize to lower case before encoding.
+    /// @param unk Token emitted for words the vocabulary cannot cover, added to the vocabulary if missing.
+    explicit WordPieceTokenizer(const std::set<std::string>& vocab, const bool lower = true, const std::string& unk = "[UNK]") : lower(lower) {
+        for (const std::string& token : vocab) {
+            add_token(token);
+        }
+
+        unk_id = ids.contains(unk) ? ids.at(unk) : add_token(unk);
+
+        build_trie();
+    }
+
+    /// Trains a WordPiece vocabulary, merging the pair that maximizes count(ab) / (count(a) * count(b)).
+    /// @param raw Raw sentences.
+    /// @param n_vocab Number of tokens, including the unknown token.
+    /// @param lower Normalize to lower case.
+    /// @return Tokens
+    [[nodiscard]] std::set<std::string> tokenize(const std::vector<std::string>& raw, const unsigned int n_vocab, const bool lower) const override {
+
+        std::unordered_map<std::string, std::uint64_t> counts;
+        for (const std::string& sentence : raw) {
+            for_each_word(sentence, lower, [&counts](const std::string_view word) {
+                ++counts[std::string(word)];
+            });
+        }
+
+        std::vector<std::string> symbols;
+        std::unordered_map<std::string, int> symbol_ids;
+
+        auto intern = [&symbols, &symbol_ids](std::string symbol) {
+            const auto [it, inserted] = symbol_ids.try_emplace(symbol, static_cast<int>(symbols.size()));
+            if (inserted) {
+                symbols.push_back(std::move(symbol));
+            }
+            return it->second;
+        };
+
+        struct Word {
+            std::vector<int> symbols;
+            std::uint64_t count;
+        };
+
+        // Words start with a plain character, every following character continues it
+        std::vector<Word> words;
+        words.reserve(counts.size());
+        for (const auto& [word, count] : counts) {
+            Word split{{}, count};
+            split.symbols.reserve(word.size());
+            split.symbols.push_back(intern(word.substr(0, 1)));
+            for (std::size_t i = 1; i < word.size(); i++) {
+                split.symbols.push_back(intern(std::string(suffix_indicator) + word[i]));
+            }
+            words.push_back(std::move(split));
+        }
+
+        std::set<std::string> tokens(symbols.begin(), symbols.end());
+        tokens.emplace("[UNK]");
+
+        while (tokens.size() < n_vocab) {
+
+            std::unordered_map<int, std::uint64_t> unit_freqs;
+            std::unordered_map<std::pair<int, int>, std::uint64_t, pair_hash> pair_freqs;
+
+            for (const Word& word : words) {
+                for (std::size_t i = 0; i < word.symbols.size(); i++) {
+                    unit_freqs[word.symbols[i]] += word.count;
+                    if (i + 1 < word.symbols.size()) {
+                        pair_freqs[{word.symbols[i], word.symbols[i + 1]}] += word.count;
+                    }
+                }
+            }
+
+            // Every word is a single symbol, nothing left to merge
+            if (pair_freqs.empty()) {
+                break;
+            }
+
+            // Pick the best scoring pair, ties go to the more frequent then the lower pair for determinism
+            std::pair<int, int> key;
+            double best = -1;
+            std::uint64_t best_count = 0;
+            for (const auto& [pair, count] : pair_freqs) {
+                const double score = static_cast<double>(count) /
+                    (static_cast<double>(unit_freqs[pair.first]) * static_cast<double>(unit_freqs[pair.second]));
+                if (score > best || (score == best && (count > best_count || (count == best_count && pair < key)))) {
+                    best = score;
+                    best_count = count;
+                    key = pair;
+                }
+            }
+
+            std::string merged = symbols[key.first] + symbols[key.second].substr(suffix_indicator.size());
+            tokens.insert(merged);
+            const int id = intern(std::move(merged));
+
+            for (Word& word : words) {
+                std::size_t out = 0;
+                for (std::size_t i = 0; i < word.symbols.size(); i++) {
+                    if (i + 1 < word.symbols.size() && word.symbols[i] == key.first && word.symbols[i + 1] == key.second) {
+                        word.symbols[out++] = id;
+                        i++;
+                    } else {
+                        word.symbols[out++] = word.symbols[i];
+                    }
+                }
+                word.symbols.resize(out);
+            }
+        }
+
+        return tokens;
+    }
 
+    /// Encodes text into token ids.
+    /// @param text Raw sentence.
+    /// @return Token ids
+    [[nodiscard]] std::vector<int> encode(const std::string_view text) const {
+        std::vector<int> res;
+        for_each_word(text, lower, [this, &res](const std::string_view word) {
+            encode_word(word, res);
+        });
+        return res;
+    }
+
+    /// Encodes a single pre-split word in linear time using LinMaxMatch, where failure links precomputed on the trie
+    /// replace the backtracking of repeated longest prefix lookups.
+    /// @param word Word without whitespace or punctuation.
+    /// @param res Output the token ids are appended to, a word the vocabulary cannot cover becomes the unknown token.
+    void encode_word(const std::string_view word, std::vector<int>& res) const {
+        const std::size_t start = res.size();
+        int node = 0;
+
+        for (std::size_t i = 0; i < word.size();) {
+            if (const int next = child(node, static_cast<unsigned char>(word[i])); next != none) {
+                node = next;
+                i++;
+                continue;
+            }
+
+            if (trie[node].fail == none) {
+                res.resize(start);
+                res.push_back(unk_id);
+                return;
+            }
+
+            res.insert(res.end(), pops.begin() + trie[node].pops_begin, pops.begin() + trie[node].pops_end);
+            node = trie[node].fail;
+        }
+
+        while (node != 0 && node != suffix_root) {
+            if (trie[node].fail == none) {
+                res.resize(start);
+                res.push_back(unk_id);
+                return;
+            }
+
+            res.insert(res.end(), pops.begin() + trie[node].pops_begin, pops.begin() + trie[node].pops_end);
+            node = trie[node].fail;
+        }
+    }
+
+    [[nodiscard]] const std::string& token(const int id) const {
+        return tokens.at(id);
+    }
+
+    [[nodiscard]] std::optional<int> id(const std::string& token) const {
+        if (const auto it = ids.find(token); it != ids.end()) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    [[nodiscard]] int unknown() const {
+        return unk_id;
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return tokens.size();
+    }
+
+private:
+    static constexpr int none = -1;
+
+    struct TrieNode {
+        // Token spelled by the path to this node
+        int token = none;
+
+        // Node matching resumes from once no edge can be followed, along with the tokens popped on the way
+        int fail = none;
+        std::uint32_t pops_begin = 0;
+        std::uint32_t pops_end = 0;
+    };
+
+    std::vector<std::string> tokens;
+    std::unordered_map<std::string, int> ids;
+
+    // Root is node 0, edges are keyed by (node, byte)
+    std::vector<TrieNode> trie;
+    std::unordered_map<std::uint64_t, int> edges;
+    std::vector<int> pops;
+    int suffix_root = 0;
+    int unk_id = none;
+    bool lower = true;
+
+    int add_token(const std::string& token) {
+        const auto [it, inserted] = ids.try_emplace(token, static_cast<int>(tokens.size()));
+        if (inserted) {
+            tokens.push_back(token);
+        }
+        return it->second;
+    }
+
+    [[nodiscard]] int child(const int node, const unsigned char c) const {
+        const auto it = edges.find(static_cast<std::uint64_t>(node) << 8 | c);
+        return it == edges.end() ? none : it->second;
+    }
+
+    int insert(const std::string_view path) {
+        int node = 0;
+        for (const char c : path) {
+            const std::uint64_t key = static_cast<std::uint64_t>(node) << 8 | static_cast<unsigned char>(c);
+            if (const auto it = edges.find(key); it != edges.end()) {
+                node = it->second;
+            } else {
+                trie.emplace_back();
+                node = static_cast<int>(trie.size() - 1);
+                edges.emplace(key, node);
+            }
+        }
+        return node;
+    }
+
+    void build_trie() {
+        trie.assign(1, TrieNode{});
+        edges.clear();
+        pops.clear();
+
+        suffix_root = insert(suffix_indicator);
+
+        for (std::size_t i = 0; i < tokens.size(); i++) {
+            if (static_cast<int>(i) != unk_id && !tokens[i].empty() && tokens[i] != suffix_indicator) {
+                trie[insert(tokens[i])].token = static_cast<int>(i);
+            }
+        }
+
+        // Children of every node, so the breadth first pass does not have to scan the edge table
+        std::vector<std::vector<std::pair<unsigned char, int>>> children(trie.size());
+        for (const auto& [key, node] : edges) {
+            children[key >> 8].emplace_back(static_cast<unsigned char>(key & 0xFF), node);
+        }
+
+        // Failure links are computed breadth first so a node's parent and every shorter suffix are resolved already
+        std::queue<int> queue;
+        queue.push(0);
+        queue.push(suffix_root);
+
+        while (!queue.empty()) {
+            const int parent = queue.front();
+            queue.pop();
+
+            for (const auto& [c, node] : children[parent]) {
+                if (node == suffix_root) {
+                    continue;
+                }
+
+                if (trie[node].token != none) {
+                    trie[node].fail = suffix_root;
+                    trie[node].pops_begin = static_cast<std::uint32_t>(pops.size());
+                    pops.push_back(trie[node].token);
+                    trie[node].pops_end = static_cast<std::uint32_t>(pops.size());
+                } else {
+                    std::vector popped(pops.begin() + trie[parent].pops_begin, pops.begin() + trie[parent].pops_end);
+                    int fail = trie[parent].fail;
+                    while (fail != none && child(fail, c) == none) {
+                        popped.insert(popped.end(), pops.begin() + trie[fail].pops_begin, pops.begin() + trie[fail].pops_end);
+                        fail = trie[fail].fail;
+                    }
+
+                    if (fail != none) {
+                        trie[node].fail = child(fail, c);
+                        trie[node].pops_begin = static_cast<std::uint32_t>(pops.size());
+                        pops.insert(pops.end(), popped.begin(), popped.end());
+                        trie[node].pops_end = static_cast<std::uint32_t>(pops.size());
+                    }
+                }
+
+                queue.push(node);
+            }
+        }
+    }
+};
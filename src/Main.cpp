@@ -1,3 +1,4 @@
+#include <array>
 #include <fstream>
 #include <iostream>
 #include <vector>
@@ -10,31 +11,28 @@ using Translation = std::pair<std::string, std::string>;
 int main() {
 
     std::cout << "Parsing Raw Data..." << std::endl;
-    const std::vector<Translation> translations = read_file("../data/wmt14_translate_de-en_train.csv");
+    std::vector<Translation> translations = read_file("../data/wmt14_translate_de-en_train.csv");
 
     std::cout << "Raw Data: " << translations.size() << std::endl;
 
+    // Move each side into its own column so the tokenizer can view them without another copy
     std::vector<std::string> en;
     en.reserve(translations.size());
 
     std::vector<std::string> de;
     de.reserve(translations.size());
 
-    std::vector<std::string> shared;
-    shared.reserve(2 * translations.size());
-
-    for (const auto&[english, german] : translations) {
-        en.push_back(english);
-        de.push_back(german);
-
-        shared.push_back(english);
-        shared.push_back(german);
+    for (auto&[english, german] : translations) {
+        en.push_back(std::move(english));
+        de.push_back(std::move(german));
     }
 
-    const BytePairTokenizer tokenizer;
+    translations.clear();
+    translations.shrink_to_fit();
 
     std::cout << "Tokenizing Data..." << std::endl;
-    std::set<std::string> tokens = tokenizer.tokenize(shared, 37000, true);
+    const WordCounts counts({ en, de }, true);
+    std::set<std::string> tokens = BytePairTokenizer::train(counts, std::array{ 1.0, 1.0 }, { .n_vocab = 37000 });
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "catch2/catch_amalgamated.hpp"
+#include "Dast/memory/Arena.hpp"
+
+#include <cstdint>
+#include <set>
+
+TEST_CASE("Arena", "[Arena]") {
+
+    SECTION("Reuse Through Free Lists") {
+
+        Dast::Arena arena(4096);
+
+        void* a = arena.allocate(24);
+        void* b = arena.allocate(24);
+        void* c = arena.allocate(100);
+        REQUIRE(a != b);
+
+        // Chunks given back come out again, last in first out, within their own size class only
+        arena.deallocate(a, 24);
+        arena.deallocate(b, 24);
+        REQUIRE(arena.allocate(100) != b);
+        REQUIRE(arena.allocate(20) == b);
+        REQUIRE(arena.allocate(17) == a);
+        REQUIRE(arena.allocate(24) != a);
+
+        arena.deallocate(c, 100);
+        REQUIRE(arena.allocate(100) == c);
+
+        // Chunks too large to pool are not handed out again
+        void* large = arena.allocate(1000);
+        arena.deallocate(large, 1000);
+        REQUIRE(arena.allocate(1000) != large);
+    }
+
+    SECTION("Alignment") {
+
+        Dast::Arena arena(4096);
+
+        for (std::size_t const alignment : { 1, 2, 8, 16, 64, 256 }) {
+            arena.allocate(3);
+            void* ptr = arena.allocate(40, alignment);
+            REQUIRE(reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0);
+        }
+    }
+
+    SECTION("Growth And Release") {
+
+        Dast::Arena arena(1024);
+        REQUIRE(arena.capacity() == 0);
+
+        std::set<void*> chunks;
+        for (int i = 0; i < 100; i++) {
+            chunks.insert(arena.allocate(64));
+        }
+        REQUIRE(chunks.size() == 100);
+        REQUIRE(arena.capacity() >= 100 * 64);
+
+        // Allocations larger than a block get a block of their own
+        const std::size_t before = arena.capacity();
+        arena.allocate(10'000);
+        REQUIRE(arena.capacity() >= before + 10'000);
+
+        // Releasing returns every block and empties the free lists
+        arena.deallocate(*chunks.begin(), 64);
+        arena.release();
+        REQUIRE(arena.capacity() == 0);
+
+        void* ptr = arena.allocate(64);
+        REQUIRE(ptr != nullptr);
+        REQUIRE(arena.capacity() > 0);
+        arena.release();
+        arena.release();
+        REQUIRE(arena.capacity() == 0);
+    }
+
+    SECTION("Move") {
+
+        Dast::Arena arena(1024);
+        void* a = arena.allocate(32);
+        arena.deallocate(a, 32);
+        const std::size_t capacity = arena.capacity();
+
+        // Blocks and free lists move along
+        Dast::Arena moved(std::move(arena));
+        REQUIRE(moved.capacity() == capacity);
+        REQUIRE(arena.capacity() == 0);
+        REQUIRE(moved.allocate(32) == a);
+
+        Dast::Arena assigned;
+        assigned.allocate(8);
+        assigned = std::move(moved);
+        REQUIRE(assigned.capacity() == capacity);
+        REQUIRE(moved.capacity() == 0);
+    }
+
+    SECTION("Allocator") {
+
+        Dast::Arena arena;
+        Dast::Arena other;
+
+        const Dast::ArenaAllocator<int> a(arena);
+        const Dast::ArenaAllocator<double> b(a);
+
+        // Equal when drawing from the same arena, whatever the element type
+        REQUIRE(a == b);
+        REQUIRE_FALSE(a == Dast::ArenaAllocator<int>(other));
+        REQUIRE(b.get_arena() == &arena);
+
+        Dast::ArenaAllocator<double> alloc = b;
+        double* ptr = alloc.allocate(3);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(ptr) % alignof(double) == 0);
+        alloc.deallocate(ptr, 3);
+        REQUIRE(alloc.allocate(3) == ptr);
+
+        STATIC_REQUIRE(Dast::is_bulk_allocator_v<Dast::ArenaAllocator<int>>);
+        STATIC_REQUIRE_FALSE(Dast::is_bulk_allocator_v<std::allocator<int>>);
+    }
+}
@@ -0,0 +1,70 @@
+#include "catch2/catch_amalgamated.hpp"
+#include "Orion/Attention.hpp"
+
+namespace {
+    using LinearLib::Tensor;
+
+    /// Materializes the full score matrix of every (batch, head) pair.
+    Tensor<double> reference(const Tensor<double>& q, const Tensor<double>& k, const Tensor<double>& v,
+                             const LinearLib::SoftmaxMask& mask) {
+        Tensor<double> scores = LinearLib::matmul(q, k.transpose()) * (1.0 / std::sqrt(static_cast<double>(q.shape(3))));
+        return LinearLib::matmul(LinearLib::softmax(scores, mask), v);
+    }
+
+    double max_difference(const Tensor<double>& a, const Tensor<double>& b) {
+        return a.zipMap(b, [](double const x, double const y) { return std::abs(x - y); })
+                .reduce(0.0, [](double const x, double const y) { return std::max(x, y); });
+    }
+}
+
+TEST_CASE("Attention", "[Attention]") {
+
+    const Tensor<double> q = Tensor<double>::random({ 2, 3, 150, 24 }, -1, 1, 1);
+    const Tensor<double> k = Tensor<double>::random({ 2, 3, 170, 24 }, -1, 1, 2);
+    const Tensor<double> v = Tensor<double>::random({ 2, 3, 170, 40 }, -1, 1, 3);
+
+    SECTION("Unmasked") {
+
+        REQUIRE(max_difference(Orion::attention(q, k, v), reference(q, k, v, {})) < 1e-12);
+    }
+
+    SECTION("Causal") {
+
+        const LinearLib::SoftmaxMask mask{ .causal = true, .offset = 20 };
+
+        REQUIRE(max_difference(Orion::attention(q, k, v, mask), reference(q, k, v, mask)) < 1e-12);
+    }
+
+    SECTION("Padding") {
+
+        const std::vector<std::size_t> lengths = { 170, 65 };
+        const LinearLib::SoftmaxMask mask{ .causal = true, .lengths = lengths };
+
+        REQUIRE(max_difference(Orion::attention(q, k, v, mask), reference(q, k, v, mask)) < 1e-12);
+    }
+
+    SECTION("Strided Views") {
+
+        // Heads split out of [batch, sequence, heads, width] without copying
+        const Tensor<double> qs = q.permute({ 0, 2, 1, 3 }).contiguous().permute({ 0, 2, 1, 3 });
+        Tensor<double> out = Tensor<double>::zeros({ 2, 150, 3, 40 }).permute({ 0, 2, 1, 3 });
+
+        Orion::attention(qs, k, v, out);
+
+        REQUIRE_FALSE(qs.isContiguous());
+        REQUIRE(max_difference(out.contiguous(), reference(q, k, v, {})) < 1e-12);
+    }
+
+    SECTION("Float") {
+
+        const auto narrow = [](double const x) { return static_cast<float>(x); };
+        const Tensor<float> out = Orion::attention(q.map(narrow), k.map(narrow), v.map(narrow));
+
+        REQUIRE(max_difference(out.map([](float const x) { return static_cast<double>(x); }), reference(q, k, v, {})) < 1e-5);
+    }
+
+    SECTION("Shapes") {
+
+        REQUIRE_THROWS_AS(Orion::attention(q, k, q), std::invalid_argument);
+    }
+}
@@ -0,0 +1,128 @@
+#include "catch2/catch_amalgamated.hpp"
+#include "LinearLib/Decomposition.hpp"
+#include "LinearLib/Matrix.hpp"
+#include "LinearLib/Tensor.hpp"
+
+namespace {
+    using LinearLib::Tensor;
+
+    double max_difference(const Tensor<double>& a, const Tensor<double>& b) {
+        return a.zipMap(b, [](double const x, double const y) { return std::abs(x - y); })
+                .reduce(0.0, [](double const x, double const y) { return std::max(x, y); });
+    }
+
+    Tensor<double> identity(std::size_t const n) {
+        Tensor<double> res = Tensor<double>::zeros({ n, n });
+        for (std::size_t i = 0; i < n; i++) {
+            res(i, i) = 1;
+        }
+        return res;
+    }
+
+    /// B B^T / n + I, symmetric positive-definite with a determinant that stays finite.
+    Tensor<double> spd(std::size_t const n, std::size_t const seed) {
+        const Tensor<double> b = Tensor<double>::random({ n, n }, -1, 1, seed);
+        Tensor<double> res = LinearLib::matmul(b, b.transpose()).map([n](double const x) { return x / static_cast<double>(n); });
+        for (std::size_t i = 0; i < n; i++) {
+            res(i, i) += 1;
+        }
+        return res;
+    }
+}
+
+TEST_CASE("Decomposition", "[Decomposition]") {
+
+    SECTION("Pivoting") {
+
+        // A zero leading pivot forces a row swap
+        const LinearLib::Matrix<3, 3, double> a = { { 0, 2, 1 }, { 1, 1, 1 }, { 2, 1, 3 } };
+
+        REQUIRE(std::abs(a.determinant() + 3) < 1e-12);
+
+        const LinearLib::Matrix<3, 1, double> b = { { 3 }, { 3 }, { 6 } };
+        const LinearLib::Matrix<3, 1, double> x = a.solve(b);
+
+        REQUIRE(std::abs(x[0][0] - 1) < 1e-12);
+        REQUIRE(std::abs(x[1][0] - 1) < 1e-12);
+        REQUIRE(std::abs(x[2][0] - 1) < 1e-12);
+
+        const LinearLib::Matrix<3, 3, double> product = a & a.inverse();
+        for (std::size_t i = 0; i < 3; i++) {
+            for (std::size_t j = 0; j < 3; j++) {
+                REQUIRE(std::abs(product[i][j] - (i == j ? 1.0 : 0.0)) < 1e-12);
+            }
+        }
+    }
+
+    SECTION("Singular") {
+
+        const LinearLib::Matrix<3, 3, double> a = { { 1, 2, 3 }, { 2, 4, 6 }, { 1, 0, 1 } };
+
+        REQUIRE(a.determinant() == 0);
+        REQUIRE_FALSE(LinearLib::LUDecomposition<double>(3, a.data[0].data(), 3).isRegular());
+        REQUIRE_THROWS_AS(a.inverse(), std::domain_error);
+        REQUIRE_THROWS_AS(a.solve(LinearLib::Matrix<3, 1, double>{ { 1 }, { 2 }, { 3 } }), std::domain_error);
+    }
+
+    SECTION("Not Positive-Definite") {
+
+        const LinearLib::Matrix<2, 2, double> indefinite = { { 1, 2 }, { 2, 1 } };
+
+        REQUIRE_THROWS_AS(indefinite.cholesky(), std::domain_error);
+
+        const LinearLib::Matrix<2, 2, double> a = { { 4, 2 }, { 2, 5 } };
+        const LinearLib::Matrix<2, 2, double> l = a.cholesky();
+
+        REQUIRE(l[0][0] == 2);
+        REQUIRE(l[0][1] == 0);
+        REQUIRE(l[1][0] == 1);
+        REQUIRE(l[1][1] == 2);
+    }
+
+    SECTION("Blocked") {
+
+        // Sizes past the 64 column panels, with a ragged last panel
+        constexpr std::size_t n = 150;
+
+        Tensor<double> a = Tensor<double>::random({ n, n }, -1, 1, 1);
+        const Tensor<double> b = Tensor<double>::random({ n, 3 }, -1, 1, 2);
+
+        const Tensor<double> x = LinearLib::solve(a, b);
+        REQUIRE(max_difference(LinearLib::matmul(a, x), b) < 1e-10);
+        REQUIRE(max_difference(LinearLib::matmul(a, LinearLib::inverse(a)), identity(n)) < 1e-10);
+
+        const Tensor<double> s = spd(n, 3);
+        const LinearLib::CholeskyDecomposition<double> cholesky(n, s.data(), n);
+
+        Tensor<double> l({ n, n });
+        std::copy_n(cholesky.lower().data(), n * n, l.data());
+        for (std::size_t i = 0; i < n; i++) {
+            for (std::size_t j = i + 1; j < n; j++) {
+                REQUIRE(l(i, j) == 0);
+            }
+        }
+        REQUIRE(max_difference(LinearLib::matmul(l, l.transpose()), s) < 1e-10);
+
+        const double lu_determinant = LinearLib::LUDecomposition<double>(n, s.data(), n).determinant();
+        REQUIRE(std::abs(cholesky.determinant() / lu_determinant - 1) < 1e-10);
+
+        Tensor<double> y = b.clone();
+        cholesky.solve(y.data(), 3, 3);
+        REQUIRE(max_difference(LinearLib::matmul(s, y), b) < 1e-10);
+    }
+
+    SECTION("Integer Determinant") {
+
+        const LinearLib::Matrix<3, 3, int> a = { { 2, -3, 1 }, { 2, 0, -1 }, { 1, 4, 5 } };
+        REQUIRE(a.determinant() == 49);
+
+        const LinearLib::Matrix<4, 4, int> pivoted = { { 0, 1, 2, 3 }, { 1, 0, 1, 2 }, { 2, 1, 0, 1 }, { 3, 2, 1, 0 } };
+        REQUIRE(pivoted.determinant() == -12);
+
+        REQUIRE(LinearLib::Matrix<2, 2, int>{ { 1, 2 }, { 2, 4 } }.determinant() == 0);
+
+        // The products before the last division reach 1e24 while every minor fits
+        const LinearLib::Matrix<3, 3, long long> large = { { 1000000, 1, 0 }, { 1, 1000000, 1 }, { 0, 1, 1000000 } };
+        REQUIRE(large.determinant() == 1000000000000000000LL - 2000000);
+    }
+}
@@ -0,0 +1,122 @@
+#include "catch2/catch_amalgamated.hpp"
+#include "LinearLib/Tensor.hpp"
+#include "LinearLib/ThreadPool.hpp"
+
+#include <cmath>
+
+namespace {
+    using LinearLib::Tensor;
+    using Shape = Tensor<int>::Shape;
+
+    // Past the grain so the parallel variants split the work, with a partial last chunk
+    constexpr std::size_t large = 3 * LinearLib::detail::elementwise_grain + 123;
+
+    Tensor<int> iota(Shape shape) {
+        Tensor<int> res(std::move(shape));
+        std::iota(res.data(), res.data() + res.size(), 0);
+        return res;
+    }
+}
+
+TEST_CASE("Elementwise", "[Elementwise]") {
+
+    LinearLib::ThreadPool::configure({ .threads = 4 });
+
+    SECTION("Apply") {
+
+        for (const bool parallel : { false, true }) {
+            Tensor<int> t = iota({ large });
+            const auto twice = [](int const x) { return 2 * x; };
+            Tensor<int>& res = parallel ? t.parallelApply(twice) : t.apply(twice);
+
+            REQUIRE(&res == &t);
+            for (std::size_t i = 0; i < large; i++) {
+                REQUIRE(t(i) == 2 * static_cast<int>(i));
+            }
+        }
+
+        // Only the elements of a strided view change
+        Tensor<int> t = iota({ 4, 4 });
+        Tensor<int> column = t.transpose()[1];
+        column.parallelApply([](int const x) { return -x; });
+        REQUIRE(t == Tensor<int>({ 4, 4 }, { 0, -1, 2, 3, 4, -5, 6, 7, 8, -9, 10, 11, 12, -13, 14, 15 }));
+    }
+
+    SECTION("Map") {
+
+        const Tensor<int> t = iota({ large });
+        const auto half = [](int const x) { return static_cast<double>(x) / 2; };
+
+        // The result takes the function's type
+        const Tensor<double> serial = t.map(half);
+        const Tensor<double> parallel = t.parallelMap(half);
+
+        REQUIRE(serial == parallel);
+        REQUIRE(serial.shape() == t.shape());
+        REQUIRE(serial(large - 1) == static_cast<double>(large - 1) / 2);
+
+        // Views map into a fresh contiguous tensor and stay untouched
+        const Tensor<int> view = iota({ 3, 5 }).slice(1, 1, 5, 2);
+        const Tensor<int> squared = view.map([](int const x) { return x * x; });
+        REQUIRE(squared.isContiguous());
+        REQUIRE(squared == Tensor<int>({ 3, 2 }, { 1, 9, 36, 64, 121, 169 }));
+        REQUIRE(view(2, 1) == 13);
+    }
+
+    SECTION("Zip Map") {
+
+        const Tensor<int> a = iota({ large });
+        const Tensor<float> b = Tensor<float>::uniform({ large }, 0.5f);
+        const auto add = [](int const x, float const y) { return static_cast<double>(x) + y; };
+
+        const Tensor<double> serial = a.zipMap(b, add);
+        const Tensor<double> parallel = a.parallelZipMap(b, add);
+
+        REQUIRE(serial == parallel);
+        REQUIRE(serial(7) == 7.5);
+
+        // Operands with different layouts are matched by index
+        const Tensor<int> m = iota({ 3, 3 });
+        const Tensor<int> sums = m.zipMap(m.transpose(), [](int const x, int const y) { return x + y; });
+        REQUIRE(sums == Tensor<int>({ 3, 3 }, { 0, 4, 8, 4, 8, 12, 8, 12, 16 }));
+
+        REQUIRE_THROWS_AS(m.zipMap(iota({ 9 }), std::plus{}), std::invalid_argument);
+        REQUIRE_THROWS_AS(m.parallelZipMap(iota({ 3, 4 }), std::plus{}), std::invalid_argument);
+    }
+
+    SECTION("Reduce") {
+
+        const Tensor<int> t = iota({ large });
+        const long long expected = static_cast<long long>(large) * (large - 1) / 2;
+        const auto plus = [](long long const a, long long const b) { return a + b; };
+
+        REQUIRE(t.reduce(0LL, plus) == expected);
+        REQUIRE(t.parallelReduce(0LL, plus) == expected);
+        REQUIRE(t.parallelReduce(10LL, plus) == expected + 10);
+
+        // Associative but not commutative folds keep the element order
+        const auto first = [](long long const a, long long) { return a; };
+        const auto last = [](long long, long long const b) { return b; };
+        REQUIRE(t.parallelReduce(-1LL, first) == -1);
+        REQUIRE(t.parallelReduce(-1LL, last) == static_cast<long long>(large) - 1);
+
+        // Accumulators of another type, bool included
+        const Tensor<int> positive = t.map([](int const x) { return x + 1; });
+        const auto all = [](bool const a, bool const b) { return a && b; };
+        REQUIRE(positive.parallelReduce(true, all));
+        REQUIRE_FALSE(t.parallelReduce(true, all));
+
+        // The parallel fold does not depend on the thread count, even for floating point sums
+        const Tensor<float> values = Tensor<float>::random({ large }, -1, 1, 1);
+        const auto sum = [](float const a, float const b) { return a + b; };
+        const float four = values.parallelReduce(0.0f, sum);
+        LinearLib::ThreadPool::configure({ .threads = 2 });
+        REQUIRE(values.parallelReduce(0.0f, sum) == four);
+
+        // Strided views and empty tensors
+        REQUIRE(iota({ 4, 4 }).transpose()[0].reduce(0, std::plus{}) == 24);
+        REQUIRE(Tensor<int>({ 0 }).parallelReduce(5, std::plus{}) == 5);
+    }
+
+    LinearLib::ThreadPool::configure({});
+}
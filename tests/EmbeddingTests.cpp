@@ -0,0 +1,88 @@
+#include "catch2/catch_amalgamated.hpp"
+#include "Orion/Embedding.hpp"
+
+TEST_CASE("Embedding", "[Embedding]") {
+
+    using LinearLib::Tensor;
+
+    Orion::Embedding<double> embedding(50, 8, 1);
+    const Tensor<std::size_t> tokens({ 2, 3 }, { 4, 17, 4, 49, 0, 17 });
+
+    SECTION("Gather") {
+
+        const Tensor<double> x = embedding.forward(tokens);
+
+        REQUIRE(x.shape() == Tensor<double>::Shape{ 2, 3, 8 });
+        for (std::size_t i = 0; i < 2; i++) {
+            for (std::size_t j = 0; j < 3; j++) {
+                for (std::size_t k = 0; k < 8; k++) {
+                    REQUIRE(x(i, j, k) == embedding.weight(tokens(i, j), k));
+                }
+            }
+        }
+
+        REQUIRE_THROWS_AS(embedding.forward(Tensor<std::size_t>({ 1 }, { 50 })), std::out_of_range);
+    }
+
+    SECTION("Sparse Gradient") {
+
+        embedding.forward(tokens);
+        embedding.backward(Tensor<double>::ones({ 2, 3, 8 }));
+
+        const Orion::SparseGradient<double>& grad = embedding.grad();
+
+        REQUIRE(std::ranges::equal(grad.rows(), std::vector<std::size_t>{ 4, 17, 49, 0 }));
+        REQUIRE(grad.values(0)[3] == 2.0);
+        REQUIRE(grad.values(2)[3] == 1.0);
+
+        const Tensor<double> before = embedding.weight.clone();
+        grad.scatter_add(embedding.weight, -0.5);
+
+        REQUIRE(embedding.weight(17, 0) == before(17, 0) - 1.0);
+        REQUIRE(embedding.weight(49, 7) == before(49, 7) - 0.5);
+        REQUIRE(embedding.weight(1, 0) == before(1, 0));
+
+        embedding.zero_grad();
+
+        REQUIRE(embedding.grad().empty());
+        embedding.backward(Tensor<double>::ones({ 2, 3, 8 }));
+        REQUIRE(embedding.grad().size() == 4);
+    }
+
+    SECTION("Tied Projection") {
+
+        Tensor<double> x = Tensor<double>::random({ 3, 8 }, -1, 1, 2);
+        const Tensor<double> grad = Tensor<double>::random({ 3, 50 }, -1, 1, 3);
+
+        // The projection keeps its own copy of the input for the backward pass
+        const Tensor<double> logits = embedding.project(x);
+        const Tensor<double> original = x.clone();
+        x.fill(100);
+        const Tensor<double> dx = embedding.project_backward(grad);
+        x.assign(original);
+
+        REQUIRE(logits.shape() == Tensor<double>::Shape{ 3, 50 });
+        REQUIRE(std::abs(logits(2, 9) - LinearLib::matmul(x, embedding.weight.transpose())(2, 9)) < 1e-12);
+        REQUIRE(std::abs(dx(1, 5) - LinearLib::matmul(grad, embedding.weight)(1, 5)) < 1e-12);
+        REQUIRE(std::abs(embedding.projection_grad()(30, 2) - LinearLib::matmul(grad.transpose(), x)(30, 2)) < 1e-12);
+    }
+
+    SECTION("Seeds") {
+
+        // Tables built without a seed, e.g. the source and target embeddings, start from different weights
+        const Orion::Embedding<double> source(50, 8);
+        const Orion::Embedding<double> target(50, 8);
+        REQUIRE_FALSE(source.weight == target.weight);
+
+        // The same seed gives the same weights, consecutive seeds unrelated ones
+        REQUIRE(Orion::Embedding<double>(50, 8, 1).weight == embedding.weight);
+        const Orion::Embedding<double> next(50, 8, 2);
+        REQUIRE_FALSE(std::equal(next.weight.data(), next.weight.data() + 8, embedding.weight.data()));
+
+        // Variance 1 / d_model bounds every weight by sqrt(3 / d_model)
+        const double limit = std::sqrt(3.0 / 8.0);
+        for (std::size_t i = 0; i < source.weight.size(); i++) {
+            REQUIRE(std::abs(source.weight.data()[i]) <= limit);
+        }
+    }
+}
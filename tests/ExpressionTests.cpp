@@ -0,0 +1,94 @@
+#include "catch2/catch_amalgamated.hpp"
+#include "LinearLib/Vector.hpp"
+
+#include <utility>
+
+namespace {
+    using LinearLib::lazy;
+    using LinearLib::Matrix;
+    using LinearLib::Vector;
+
+    template<typename L, typename R>
+    concept Addable = requires(const L& lhs, const R& rhs) { lhs + rhs; };
+
+    template<typename M>
+    concept Lazy = requires(M&& m) { lazy(std::forward<M>(m)); };
+
+    using Leaf34 = LinearLib::LeafExpression<double, 3, 4>;
+    using Leaf43 = LinearLib::LeafExpression<double, 4, 3>;
+    using LeafInt34 = LinearLib::LeafExpression<int, 3, 4>;
+
+    // Expressions combine only with the same shape and element type
+    static_assert(LinearLib::MatrixExpression<Leaf34>);
+    static_assert(!LinearLib::MatrixExpression<int>);
+    static_assert(!LinearLib::MatrixExpression<Matrix<3, 4, double>>);
+    static_assert(Addable<Leaf34, Leaf34>);
+    static_assert(!Addable<Leaf34, Leaf43>);
+    static_assert(!Addable<Leaf34, LeafInt34>);
+
+    // They only evaluate into a matrix of their own shape and type
+    using Sum34 = decltype(std::declval<Leaf34>() + std::declval<Leaf34>());
+    static_assert(std::is_constructible_v<Matrix<3, 4, double>, Sum34>);
+    static_assert(!std::is_constructible_v<Matrix<4, 3, double>, Sum34>);
+    static_assert(!std::is_constructible_v<Matrix<3, 4, float>, Sum34>);
+    static_assert(!std::is_assignable_v<Matrix<4, 3, double>&, Sum34>);
+    static_assert(std::is_constructible_v<Vector<4, double>, LinearLib::LeafExpression<double, 4, 1>>);
+    static_assert(!std::is_constructible_v<Vector<4, double>, LinearLib::LeafExpression<double, 1, 4>>);
+
+    // A temporary would be destroyed before the expression reads it
+    static_assert(Lazy<const Matrix<2, 2, int>&>);
+    static_assert(!Lazy<Matrix<2, 2, int>>);
+    static_assert(!Lazy<Vector<2, int>>);
+}
+
+TEST_CASE("Expression", "[Expression]") {
+
+    const Matrix<3, 4, double> a = { { 1, 2, 3, 4 }, { 5, 6, 7, 8 }, { 9, 10, 11, 12 } };
+    const Matrix<3, 4, double> b = { { 2, 2, 2, 2 }, { -1, 0, 1, 2 }, { 0.5, 0.25, 4, 8 } };
+    const Matrix<3, 4, double> c = { { 1, 0, 1, 0 }, { 3, 3, 3, 3 }, { -2, -4, -6, -8 } };
+
+    SECTION("Lazy Matches Eager") {
+
+        const Matrix<3, 4, double> lazy_result = lazy(a) * lazy(b) + lazy(c) * 2.0 - lazy(b);
+        const Matrix<3, 4, double> eager_result = a * b + c * 2.0 - b;
+
+        REQUIRE(lazy_result == eager_result);
+
+        const Matrix<3, 4, double> divided = -(lazy(a) / lazy(b)) + 0.5 * lazy(c) / 4.0;
+        for (std::size_t i = 0; i < 3; i++) {
+            for (std::size_t j = 0; j < 4; j++) {
+                REQUIRE(divided[i][j] == -(a[i][j] / b[i][j]) + 0.5 * c[i][j] / 4.0);
+            }
+        }
+
+        const Vector<3, int> u = { 1, 2, 3 };
+        const Vector<3, int> v = { 4, 5, 6 };
+        const Vector<3, int> w = lazy(u) * lazy(v) - lazy(u) * 2;
+        REQUIRE(w == Vector<3, int>{ 2, 6, 12 });
+    }
+
+    SECTION("Aliasing") {
+
+        // Every element only reads its own index, so an expression may assign to one of its operands
+        Matrix<3, 4, double> x = a;
+        x = lazy(x) + lazy(b);
+        REQUIRE(x == a + b);
+
+        x = lazy(x) * lazy(x) - lazy(x);
+        const Matrix<3, 4, double> sum = a + b;
+        REQUIRE(x == sum * sum - sum);
+
+        Vector<3, int> v = { 1, 2, 3 };
+        v = -lazy(v) * 3;
+        REQUIRE(v == Vector<3, int>{ -3, -6, -9 });
+    }
+
+    SECTION("Reduced Precision") {
+
+        const Matrix<2, 2, LinearLib::BFloat16> h = { { 1.5f, 2.0f }, { -3.0f, 0.25f } };
+        const Matrix<2, 2, LinearLib::BFloat16> doubled = lazy(h) * LinearLib::BFloat16(2.0f) + lazy(h);
+
+        REQUIRE(static_cast<float>(doubled[0][0]) == 4.5f);
+        REQUIRE(static_cast<float>(doubled[1][1]) == 0.75f);
+    }
+}
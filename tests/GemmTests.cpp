@@ -0,0 +1,316 @@
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "catch2/catch_amalgamated.hpp"
+#include "LinearLib/Gemm.hpp"
+#include "LinearLib/Tensor.hpp"
+#include "LinearLib/ThreadPool.hpp"
+
+namespace {
+    using LinearLib::Tensor;
+
+    /// Operands of one strided product, filled with random values. A and B are stored transposed when asked to and
+    /// every leading dimension is padded, C's padding holds a sentinel the product must not touch.
+    template<typename T>
+    struct Problem {
+        std::size_t m, n, k;
+        bool a_transposed, b_transposed;
+        std::size_t a_rs, a_cs, b_rs, b_cs, ldc;
+        std::vector<T> a, b, c;
+
+        static constexpr T sentinel = T{-12345};
+
+        Problem(std::size_t const m, std::size_t const n, std::size_t const k, bool const a_transposed = false,
+                bool const b_transposed = false)
+            : m(m), n(n), k(k), a_transposed(a_transposed), b_transposed(b_transposed) {
+            const std::size_t lda = (a_transposed ? m : k) + 3;
+            const std::size_t ldb = (b_transposed ? k : n) + 5;
+            a_rs = a_transposed ? 1 : lda;
+            a_cs = a_transposed ? lda : 1;
+            b_rs = b_transposed ? 1 : ldb;
+            b_cs = b_transposed ? ldb : 1;
+            ldc = n + 2;
+
+            std::mt19937 gen(static_cast<unsigned>(m * 131 + n * 17 + k));
+            std::uniform_int_distribution<int> dist(-4, 4);
+            a.resize((a_transposed ? k : m) * lda);
+            b.resize((b_transposed ? n : k) * ldb);
+            c.assign(m * ldc, sentinel);
+            for (T& x : a) {
+                x = static_cast<T>(dist(gen)) / T{2};
+            }
+            for (T& x : b) {
+                x = static_cast<T>(dist(gen)) / T{4};
+            }
+            for (std::size_t i = 0; i < m; i++) {
+                for (std::size_t j = 0; j < n; j++) {
+                    c[i * ldc + j] = static_cast<T>(dist(gen));
+                }
+            }
+        }
+
+        /// alpha * A * B + beta * C with naive loops in double.
+        [[nodiscard]] std::vector<double> expected(T const alpha, T const beta) const {
+            std::vector<double> res(m * n);
+            for (std::size_t i = 0; i < m; i++) {
+                for (std::size_t j = 0; j < n; j++) {
+                    double sum = 0;
+                    for (std::size_t p = 0; p < k; p++) {
+                        sum += static_cast<double>(a[i * a_rs + p * a_cs]) * static_cast<double>(b[p * b_rs + j * b_cs]);
+                    }
+                    res[i * n + j] = alpha * sum + (beta == T{0} ? 0.0 : beta * static_cast<double>(c[i * ldc + j]));
+                }
+            }
+            return res;
+        }
+
+        /// Runs the product and returns the largest error against the naive one.
+        double run(T const alpha, T const beta) {
+            const std::vector<double> reference = expected(alpha, beta);
+            LinearLib::gemm(m, n, k, alpha, a.data(), a_rs, a_cs, b.data(), b_rs, b_cs, beta, c.data(), ldc);
+
+            double res = 0;
+            for (std::size_t i = 0; i < m; i++) {
+                for (std::size_t j = 0; j < n; j++) {
+                    res = std::max(res, std::abs(static_cast<double>(c[i * ldc + j]) - reference[i * n + j]));
+                }
+                for (std::size_t j = n; j < ldc; j++) {
+                    REQUIRE(c[i * ldc + j] == sentinel);
+                }
+            }
+            return res;
+        }
+    };
+
+    /// Every combination of transposed operands and of beta for one shape.
+    template<typename T>
+    void check(std::size_t const m, std::size_t const n, std::size_t const k, double const tolerance) {
+        for (const bool a_transposed : { false, true }) {
+            for (const bool b_transposed : { false, true }) {
+                for (const T beta : { T{0}, T{1}, T{-0.5} }) {
+                    Problem<T> problem(m, n, k, a_transposed, b_transposed);
+                    INFO("m " << m << " n " << n << " k " << k << " transposed " << a_transposed << b_transposed
+                              << " beta " << beta);
+                    REQUIRE(problem.run(T{1.5}, beta) <= tolerance);
+                }
+            }
+        }
+    }
+
+    /// Naive product of two rank 2 tensors, either of which may be a strided view.
+    Tensor<double> naive(const Tensor<double>& a, const Tensor<double>& b) {
+        Tensor<double> res({ a.shape(0), b.shape(1) });
+        for (std::size_t i = 0; i < a.shape(0); i++) {
+            for (std::size_t j = 0; j < b.shape(1); j++) {
+                for (std::size_t p = 0; p < a.shape(1); p++) {
+                    res(i, j) += a(i, p) * b(p, j);
+                }
+            }
+        }
+        return res;
+    }
+
+    double max_difference(const Tensor<double>& a, const Tensor<double>& b) {
+        REQUIRE(a.shape() == b.shape());
+        return a.zipMap(b, [](double const x, double const y) { return std::abs(x - y); })
+                .reduce(0.0, [](double const x, double const y) { return std::max(x, y); });
+    }
+}
+
+TEST_CASE("Gemm", "[Gemm]") {
+
+    SECTION("Direct") {
+
+        // At most gemm_small multiply-adds, streamed without packing
+        check<float>(5, 7, 3, 1e-4);
+        check<double>(31, 32, 32, 1e-12);
+        check<float>(1, 1, 1, 0);
+    }
+
+    SECTION("Blocked") {
+
+        // Edges in every micro and macro tile direction: not multiples of MR, NR, MC or KC
+        check<float>(37, 53, 41, 1e-4);
+        check<double>(131, 29, 263, 1e-10);
+        check<float>(97, 35, 513, 1e-3);
+
+        // Past one NC wide panel of B
+        check<double>(3, 4100, 7, 1e-12);
+    }
+
+    SECTION("Parallel") {
+
+        LinearLib::ThreadPool::configure({ .threads = 4 });
+
+        check<float>(150, 141, 300, 1e-3);
+        check<double>(257, 130, 70, 1e-10);
+
+        LinearLib::ThreadPool::configure({});
+    }
+
+    SECTION("Degenerate") {
+
+        // alpha = 0 or k = 0 only scales C, and beta = 0 overwrites NaNs instead of multiplying them
+        Problem<double> problem(40, 40, 40);
+        REQUIRE(problem.run(0.0, -0.5) == 0);
+
+        Problem<double> empty(6, 9, 0);
+        REQUIRE(empty.run(1.0, 2.0) == 0);
+
+        Problem<float> nan(50, 50, 50);
+        for (std::size_t i = 0; i < 50; i++) {
+            std::fill_n(nan.c.data() + i * nan.ldc, 50, std::nanf(""));
+        }
+        REQUIRE(nan.run(1.0f, 0.0f) <= 1e-4);
+    }
+
+    SECTION("Integer") {
+
+        Problem<int> problem(45, 38, 50);
+        REQUIRE(problem.run(3, 2) == 0);
+    }
+}
+
+TEST_CASE("Batched Gemm", "[Gemm]") {
+
+    SECTION("Strided Batches") {
+
+        LinearLib::ThreadPool::configure({ .threads = 4 });
+
+        for (const std::size_t size : { std::size_t{7}, std::size_t{64} }) {
+            constexpr std::size_t batch = 20;
+            const std::size_t m = size, n = size + 3, k = size + 1;
+
+            // A shared by every product through a batch stride of 0, B stored transposed with padded batches
+            const Tensor<double> a = Tensor<double>::random({ m, k }, -1, 1, 1);
+            const Tensor<double> b = Tensor<double>::random({ batch, n, k + 2 }, -1, 1, 2);
+            Tensor<double> c = Tensor<double>::random({ batch, m, n }, -1, 1, 3);
+            const Tensor<double> original = c.clone();
+
+            LinearLib::gemmBatched(batch, m, n, k, 2.0, a.data(), 0, k, 1, b.data(), n * (k + 2), 1, k + 2,
+                                   0.5, c.data(), m * n, n);
+
+            for (std::size_t i = 0; i < batch; i++) {
+                const Tensor<double> bi = b[i].slice(1, 0, k).transpose();
+                const Tensor<double> expected = (naive(a, bi) * 2.0) + (original[i] * 0.5);
+                REQUIRE(max_difference(c[i], expected) < 1e-12);
+            }
+        }
+
+        LinearLib::ThreadPool::configure({});
+    }
+
+    SECTION("Reduced Precision") {
+
+        using LinearLib::Float16;
+
+        constexpr std::size_t batch = 3, m = 5, n = 6, k = 40;
+        const Tensor<float> a = Tensor<float>::random({ batch, m, k }, -1, 1, 4);
+        const Tensor<float> b = Tensor<float>::random({ batch, k, n }, -1, 1, 5);
+        const Tensor<Float16> ah = a.map([](float const x) { return Float16(x); });
+        const Tensor<Float16> bh = b.map([](float const x) { return Float16(x); });
+        Tensor<Float16> c({ batch, m, n });
+
+        LinearLib::gemmBatched(batch, m, n, k, 1.0f, ah.data(), m * k, k, 1, bh.data(), k * n, n, 1, 0.0f,
+                               c.data(), m * n, n);
+
+        for (std::size_t i = 0; i < batch; i++) {
+            for (std::size_t r = 0; r < m; r++) {
+                for (std::size_t s = 0; s < n; s++) {
+                    float sum = 0;
+                    for (std::size_t p = 0; p < k; p++) {
+                        sum += static_cast<float>(ah(i, r, p)) * static_cast<float>(bh(i, p, s));
+                    }
+                    // Accumulated in float, so only the final rounding to half precision remains
+                    REQUIRE(std::abs(static_cast<float>(c(i, r, s)) - sum) <= std::abs(sum) / 1024 + 1e-5f);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Matmul", "[Gemm]") {
+
+    SECTION("Stacks") {
+
+        const Tensor<double> a = Tensor<double>::random({ 2, 3, 4, 5 }, -1, 1, 1);
+        const Tensor<double> b = Tensor<double>::random({ 2, 3, 5, 6 }, -1, 1, 2);
+        const Tensor<double> res = LinearLib::matmul(a, b);
+
+        REQUIRE(res.shape() == Tensor<double>::Shape{ 2, 3, 4, 6 });
+        for (std::size_t i = 0; i < 2; i++) {
+            for (std::size_t h = 0; h < 3; h++) {
+                REQUIRE(max_difference(res[i][h], naive(a[i][h], b[i][h])) < 1e-12);
+            }
+        }
+    }
+
+    SECTION("Broadcasting") {
+
+        // A dimension of 1 on the left against a missing one on the right
+        const Tensor<double> a = Tensor<double>::random({ 2, 1, 4, 5 }, -1, 1, 3);
+        const Tensor<double> b = Tensor<double>::random({ 3, 5, 6 }, -1, 1, 4);
+        const Tensor<double> res = LinearLib::matmul(a, b);
+
+        REQUIRE(res.shape() == Tensor<double>::Shape{ 2, 3, 4, 6 });
+        for (std::size_t i = 0; i < 2; i++) {
+            for (std::size_t h = 0; h < 3; h++) {
+                REQUIRE(max_difference(res[i][h], naive(a[i][0], b[h])) < 1e-12);
+            }
+        }
+
+        // One weight matrix for a batch of sequences
+        const Tensor<double> x = Tensor<double>::random({ 4, 7, 8 }, -1, 1, 5);
+        const Tensor<double> w = Tensor<double>::random({ 8, 8 }, -1, 1, 6);
+        const Tensor<double> y = LinearLib::matmul(x, w);
+
+        REQUIRE(y.shape() == Tensor<double>::Shape{ 4, 7, 8 });
+        for (std::size_t i = 0; i < 4; i++) {
+            REQUIRE(max_difference(y[i], naive(x[i], w)) < 1e-12);
+        }
+    }
+
+    SECTION("Views") {
+
+        // Transposed and sliced operands are read through their strides
+        const Tensor<double> a = Tensor<double>::random({ 3, 9, 4 }, -1, 1, 7);
+        const Tensor<double> b = Tensor<double>::random({ 3, 9, 12 }, -1, 1, 8);
+        const Tensor<double> at = a.transpose();
+        const Tensor<double> bs = b.slice(2, 1, 12, 2);
+        const Tensor<double> res = LinearLib::matmul(at, bs);
+
+        REQUIRE(res.shape() == Tensor<double>::Shape{ 3, 4, 6 });
+        for (std::size_t i = 0; i < 3; i++) {
+            REQUIRE(max_difference(res[i], naive(at[i], bs[i])) < 1e-12);
+        }
+    }
+
+    SECTION("Vectors") {
+
+        const Tensor<double> v = Tensor<double>::random({ 5 }, -1, 1, 9);
+        const Tensor<double> m = Tensor<double>::random({ 5, 6 }, -1, 1, 10);
+        const Tensor<double> stack = Tensor<double>::random({ 2, 6, 5 }, -1, 1, 11);
+
+        const Tensor<double> row = LinearLib::matmul(v, m);
+        REQUIRE(row.shape() == Tensor<double>::Shape{ 6 });
+        REQUIRE(max_difference(row, naive(v.reshape({ 1, 5 }), m).reshape({ 6 })) < 1e-12);
+
+        const Tensor<double> column = LinearLib::matmul(stack, v);
+        REQUIRE(column.shape() == Tensor<double>::Shape{ 2, 6 });
+        for (std::size_t i = 0; i < 2; i++) {
+            REQUIRE(max_difference(column[i], naive(stack[i], v.reshape({ 5, 1 })).reshape({ 6 })) < 1e-12);
+        }
+
+        const Tensor<double> dot = LinearLib::matmul(v, v);
+        REQUIRE(dot.rank() == 0);
+        REQUIRE(std::abs(dot.data()[0] - v.reduce(0.0, [](double const s, double const x) { return s + x * x; })) < 1e-12);
+    }
+
+    SECTION("Errors") {
+
+        REQUIRE_THROWS_AS(LinearLib::matmul(Tensor<double>({ 2, 3 }), Tensor<double>({ 4, 2 })), std::invalid_argument);
+        REQUIRE_THROWS_AS(LinearLib::matmul(Tensor<double>({ 2, 2, 3 }), Tensor<double>({ 3, 3, 2 })), std::invalid_argument);
+        REQUIRE_THROWS_AS(LinearLib::matmul(Tensor<double>(Tensor<double>::Shape{}), Tensor<double>({ 3 })), std::invalid_argument);
+    }
+}
@@ -0,0 +1,146 @@
+#include "catch2/catch_amalgamated.hpp"
+#include "LinearLib/Half.hpp"
+
+#include <cmath>
+
+namespace {
+    float bits_to_float(std::uint32_t const bits) {
+        return std::bit_cast<float>(bits);
+    }
+}
+
+TEST_CASE("Float16", "[Half]") {
+    using LinearLib::Float16;
+
+    SECTION("Round Trip") {
+
+        for (std::uint32_t bits = 0; bits <= 0xffff; bits++) {
+            const Float16 half = Float16::fromBits(static_cast<std::uint16_t>(bits));
+            const float value = half;
+
+            if ((bits & 0x7c00) == 0x7c00 && (bits & 0x3ff) != 0) {
+                REQUIRE(std::isnan(value));
+                REQUIRE(std::isnan(static_cast<float>(Float16(value))));
+            } else {
+                REQUIRE(Float16(value).bits == bits);
+                REQUIRE(LinearLib::detail::floatToHalf(value) == bits);
+                REQUIRE(LinearLib::detail::halfToFloat(static_cast<std::uint16_t>(bits)) == value);
+            }
+        }
+    }
+
+    SECTION("Rounding") {
+
+        // Halfway between 1 and the next half rounds to the even neighbour
+        REQUIRE(Float16(1.0f + std::ldexp(1.0f, -11)).bits == 0x3c00);
+        REQUIRE(Float16(1.0f + 3 * std::ldexp(1.0f, -11)).bits == 0x3c02);
+        REQUIRE(Float16(1.0f + std::ldexp(1.0f, -11) + std::ldexp(1.0f, -20)).bits == 0x3c01);
+
+        // Subnormals, including a tie down to zero and a carry into the smallest normal
+        REQUIRE(Float16(std::ldexp(1.0f, -24)).bits == 0x0001);
+        REQUIRE(Float16(std::ldexp(1.0f, -25)).bits == 0x0000);
+        REQUIRE(Float16(std::ldexp(3.0f, -26)).bits == 0x0001);
+        REQUIRE(Float16(std::ldexp(3.0f, -25)).bits == 0x0002);
+        REQUIRE(Float16(-std::ldexp(1.0f, -30)).bits == 0x8000);
+        REQUIRE(Float16(std::ldexp(1.0f, -14) - std::ldexp(1.0f, -26)).bits == 0x0400);
+
+        // 65520 is halfway between the largest half and 65536, and rounds to infinity
+        REQUIRE(Float16(65519.0f).bits == 0x7bff);
+        REQUIRE(Float16(65520.0f).bits == 0x7c00);
+        REQUIRE(Float16(-1e10f).bits == 0xfc00);
+        REQUIRE(Float16(std::numeric_limits<float>::infinity()).bits == 0x7c00);
+
+        REQUIRE(std::isnan(static_cast<float>(Float16(std::numeric_limits<float>::quiet_NaN()))));
+        REQUIRE(std::isnan(static_cast<float>(Float16(bits_to_float(0x7f800001)))));
+    }
+
+    SECTION("Compile Time Conversion") {
+
+        // Every float's rounding matches between the constexpr path and F16C where the compiler targets it
+        for (std::uint64_t bits = 0; bits <= 0xffffffff; bits += 65521) {
+            const float value = bits_to_float(static_cast<std::uint32_t>(bits));
+            if (!std::isnan(value)) {
+                REQUIRE(Float16(value).bits == LinearLib::detail::floatToHalf(value));
+            }
+        }
+
+        static_assert(Float16(1.0f).bits == 0x3c00);
+        static_assert(static_cast<float>(Float16::fromBits(0x3555)) == 0.333251953125f);
+    }
+
+    SECTION("Limits") {
+        using limits = std::numeric_limits<Float16>;
+
+        REQUIRE(static_cast<float>(limits::min()) == std::ldexp(1.0f, -14));
+        REQUIRE(static_cast<float>(limits::max()) == 65504.0f);
+        REQUIRE(static_cast<float>(limits::lowest()) == -65504.0f);
+        REQUIRE(static_cast<float>(limits::epsilon()) == std::ldexp(1.0f, -10));
+        REQUIRE(static_cast<float>(limits::round_error()) == 0.5f);
+        REQUIRE(static_cast<float>(limits::denorm_min()) == std::ldexp(1.0f, -24));
+        REQUIRE(std::isinf(static_cast<float>(limits::infinity())));
+        REQUIRE(std::isnan(static_cast<float>(limits::quiet_NaN())));
+        REQUIRE(std::isnan(static_cast<float>(limits::signaling_NaN())));
+        REQUIRE((limits::signaling_NaN().bits & 0x200) == 0);
+
+        static_assert(limits::is_specialized && limits::is_iec559);
+        static_assert(limits::digits == 11 && limits::max_exponent == 16 && limits::min_exponent == -13);
+    }
+}
+
+TEST_CASE("BFloat16", "[Half]") {
+    using LinearLib::BFloat16;
+
+    SECTION("Round Trip") {
+
+        for (std::uint32_t bits = 0; bits <= 0xffff; bits++) {
+            const BFloat16 half = BFloat16::fromBits(static_cast<std::uint16_t>(bits));
+            const float value = half;
+
+            if ((bits & 0x7f80) == 0x7f80 && (bits & 0x7f) != 0) {
+                REQUIRE(std::isnan(value));
+                REQUIRE(std::isnan(static_cast<float>(BFloat16(value))));
+            } else {
+                REQUIRE(BFloat16(value).bits == bits);
+            }
+        }
+    }
+
+    SECTION("Rounding") {
+
+        REQUIRE(BFloat16(1.0f + std::ldexp(1.0f, -8)).bits == 0x3f80);
+        REQUIRE(BFloat16(1.0f + 3 * std::ldexp(1.0f, -8)).bits == 0x3f82);
+        REQUIRE(BFloat16(1.0f + std::ldexp(1.0f, -8) + std::ldexp(1.0f, -20)).bits == 0x3f81);
+
+        // Float subnormals keep their top 7 mantissa bits
+        REQUIRE(BFloat16(bits_to_float(0x00010000)).bits == 0x0001);
+        REQUIRE(BFloat16(bits_to_float(0x00008000)).bits == 0x0000);
+        REQUIRE(BFloat16(bits_to_float(0x00018000)).bits == 0x0002);
+
+        // The largest float rounds up past the largest bfloat16
+        REQUIRE(BFloat16(std::numeric_limits<float>::max()).bits == 0x7f80);
+        REQUIRE(BFloat16(-std::numeric_limits<float>::max()).bits == 0xff80);
+        REQUIRE(BFloat16(bits_to_float(0x7f7f7fff)).bits == 0x7f7f);
+
+        // A NaN whose payload sits in the dropped bits must not turn into infinity
+        REQUIRE(std::isnan(static_cast<float>(BFloat16(bits_to_float(0x7f800001)))));
+        REQUIRE(std::isnan(static_cast<float>(BFloat16(bits_to_float(0xff800001)))));
+    }
+
+    SECTION("Limits") {
+        using limits = std::numeric_limits<BFloat16>;
+
+        REQUIRE(static_cast<float>(limits::min()) == std::numeric_limits<float>::min());
+        REQUIRE(static_cast<float>(limits::max()) == bits_to_float(0x7f7f0000));
+        REQUIRE(static_cast<float>(limits::lowest()) == -bits_to_float(0x7f7f0000));
+        REQUIRE(static_cast<float>(limits::epsilon()) == std::ldexp(1.0f, -7));
+        REQUIRE(static_cast<float>(limits::round_error()) == 0.5f);
+        REQUIRE(static_cast<float>(limits::denorm_min()) == std::ldexp(1.0f, -133));
+        REQUIRE(std::isinf(static_cast<float>(limits::infinity())));
+        REQUIRE(std::isnan(static_cast<float>(limits::quiet_NaN())));
+        REQUIRE(std::isnan(static_cast<float>(limits::signaling_NaN())));
+        REQUIRE((limits::signaling_NaN().bits & 0x40) == 0);
+
+        static_assert(limits::is_specialized && !limits::is_iec559);
+        static_assert(limits::digits == 8 && limits::max_exponent == 128 && limits::min_exponent == -125);
+    }
+}
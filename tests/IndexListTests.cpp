@@ -0,0 +1,194 @@
+#include "catch2/catch_amalgamated.hpp"
+#include "Dast/collections/IndexList.hpp"
+
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    using List = Dast::IndexList<int>;
+
+    /// Elements of the run holding handle, walked through the links from its first element.
+    std::vector<int> run_of(const List& list, List::Handle handle) {
+        while (list.prev(handle) != List::npos) {
+            handle = list.prev(handle);
+        }
+
+        std::vector<int> res;
+        for (; handle != List::npos; handle = list.next(handle)) {
+            res.push_back(list[handle]);
+        }
+        return res;
+    }
+
+    std::vector<int> contents(const List& list) {
+        return std::vector<int>(list.begin(), list.end());
+    }
+}
+
+TEST_CASE("Index List", "[IndexList]") {
+
+    STATIC_REQUIRE(std::forward_iterator<List::Iterator>);
+    STATIC_REQUIRE(std::forward_iterator<List::ConstIterator>);
+
+    SECTION("Runs") {
+
+        List list;
+        REQUIRE(list.empty());
+        REQUIRE(list.begin() == list.end());
+
+        const List::Handle a = list.push_back(1);
+        const List::Handle b = list.push_back(2);
+        list.push_back(3);
+        list.cut();
+        const List::Handle d = list.push_back(4);
+        list.push_back(5);
+        list.cut();
+        list.cut();
+        const List::Handle f = list.push_back(6);
+
+        REQUIRE(list.size() == 6);
+        REQUIRE(list.slot_count() == 6);
+        REQUIRE(a == 0);
+        REQUIRE(f == 5);
+
+        // Runs are never linked to each other
+        REQUIRE(run_of(list, b) == std::vector<int>{ 1, 2, 3 });
+        REQUIRE(run_of(list, d) == std::vector<int>{ 4, 5 });
+        REQUIRE(run_of(list, f) == std::vector<int>{ 6 });
+        REQUIRE(list.prev(a) == List::npos);
+        REQUIRE(list.prev(d) == List::npos);
+        REQUIRE(list.next(d + 1) == List::npos);
+        REQUIRE(list.prev(f) == List::npos);
+        REQUIRE(list.next(f) == List::npos);
+
+        // Iteration follows the order of appending across runs
+        REQUIRE(contents(list) == std::vector<int>{ 1, 2, 3, 4, 5, 6 });
+    }
+
+    SECTION("Erase") {
+
+        List list;
+        for (int i = 0; i < 5; i++) {
+            list.push_back(i);
+        }
+        list.cut();
+        list.push_back(5);
+
+        // Middle, first and last of a run, each time joining the neighbours
+        list.erase(2);
+        REQUIRE(run_of(list, 0) == std::vector<int>{ 0, 1, 3, 4 });
+        REQUIRE(list.next(1) == 3);
+        REQUIRE(list.prev(3) == 1);
+
+        list.erase(0);
+        REQUIRE(run_of(list, 1) == std::vector<int>{ 1, 3, 4 });
+        REQUIRE(list.prev(1) == List::npos);
+
+        list.erase(4);
+        REQUIRE(run_of(list, 1) == std::vector<int>{ 1, 3 });
+        REQUIRE(list.next(3) == List::npos);
+
+        // Erasing twice does nothing, erased handles stay in place
+        list.erase(4);
+        REQUIRE(list.size() == 3);
+        REQUIRE(list.slot_count() == 6);
+        REQUIRE_FALSE(list.alive(4));
+        REQUIRE(list.alive(3));
+        REQUIRE_FALSE(list.alive(6));
+        REQUIRE_THROWS_AS(list.at(2), std::out_of_range);
+        REQUIRE_THROWS_AS(list.at(6), std::out_of_range);
+
+        // Handles of the other elements still refer to them
+        list.at(3) = 30;
+        REQUIRE(list[3] == 30);
+        REQUIRE(list[5] == 5);
+
+        list.erase(5);
+        list.erase(1);
+        list.erase(3);
+        REQUIRE(list.empty());
+        REQUIRE(list.begin() == list.end());
+    }
+
+    SECTION("Erase The Current Tail") {
+
+        List list;
+        list.push_back(0);
+        const List::Handle last = list.push_back(1);
+
+        // The run's new tail is linked to the next element appended
+        list.erase(last);
+        const List::Handle next = list.push_back(2);
+        REQUIRE(list.prev(next) == 0);
+        REQUIRE(run_of(list, 0) == std::vector<int>{ 0, 2 });
+
+        // A run emptied by erasing is not linked to what follows
+        list.cut();
+        const List::Handle lone = list.push_back(3);
+        list.erase(lone);
+        const List::Handle after = list.push_back(4);
+        REQUIRE(list.prev(after) == List::npos);
+        REQUIRE(contents(list) == std::vector<int>{ 0, 2, 4 });
+    }
+
+    SECTION("Iteration After Erase") {
+
+        List list;
+        std::vector<int> model;
+        std::mt19937 rng(3);
+
+        for (int i = 0; i < 300; i++) {
+            list.push_back(i);
+            model.push_back(i);
+            if (i % 7 == 6) {
+                list.cut();
+            }
+        }
+
+        while (!model.empty()) {
+            const std::size_t index = std::uniform_int_distribution<std::size_t>(0, model.size() - 1)(rng);
+            list.erase(static_cast<List::Handle>(model[index]));
+            model.erase(model.begin() + static_cast<std::ptrdiff_t>(index));
+
+            REQUIRE(list.size() == model.size());
+            REQUIRE(contents(list) == model);
+
+            const List& view = list;
+            REQUIRE(static_cast<std::size_t>(std::distance(view.begin(), view.end())) == model.size());
+        }
+
+        // Leading and trailing erased slots are skipped, writes go through the iterators
+        list.clear();
+        for (int i = 0; i < 6; i++) {
+            list.push_back(i);
+        }
+        list.erase(0);
+        list.erase(5);
+        for (int& value : list) {
+            value *= 10;
+        }
+        REQUIRE(contents(list) == std::vector<int>{ 10, 20, 30, 40 });
+        REQUIRE(*list.begin() == 10);
+    }
+
+    SECTION("Clear And Emplace") {
+
+        Dast::IndexList<std::string> list;
+        list.reserve(4);
+
+        const auto handle = list.emplace_back(3, 'a');
+        list.emplace_back("b");
+        REQUIRE(list[handle] == "aaa");
+        REQUIRE(list.begin()->size() == 3);
+
+        list.clear();
+        REQUIRE(list.empty());
+        REQUIRE(list.slot_count() == 0);
+
+        // A cleared list starts a fresh run at handle 0
+        REQUIRE(list.push_back("c") == 0);
+        REQUIRE(list.prev(0) == Dast::IndexList<std::string>::npos);
+    }
+}
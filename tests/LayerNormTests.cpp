@@ -0,0 +1,119 @@
+#include "catch2/catch_amalgamated.hpp"
+#include "LinearLib/LayerNorm.hpp"
+
+namespace {
+    using LinearLib::Tensor;
+
+    double sum(const Tensor<double>& t) {
+        return t.reduce(0.0, [](double const a, double const b) { return a + b; });
+    }
+
+    /// Central difference of f() with respect to one entry of x.
+    template<typename F>
+    double numeric_gradient(Tensor<double>& x, std::size_t const index, F&& f) {
+        constexpr double h = 1e-6;
+        const double original = x.data()[index];
+
+        x.data()[index] = original + h;
+        const double up = f();
+        x.data()[index] = original - h;
+        const double down = f();
+        x.data()[index] = original;
+
+        return (up - down) / (2 * h);
+    }
+
+    /// LayerNorm of each row of a [rows, cols] tensor from a two-pass mean and variance.
+    Tensor<double> reference(const Tensor<double>& h, const Tensor<double>& gamma, const Tensor<double>& beta) {
+        const std::size_t rows = h.shape(0), cols = h.shape(1);
+        Tensor<double> res({ rows, cols });
+        for (std::size_t i = 0; i < rows; i++) {
+            double mean = 0;
+            for (std::size_t j = 0; j < cols; j++) {
+                mean += h(i, j);
+            }
+            mean /= static_cast<double>(cols);
+
+            double variance = 0;
+            for (std::size_t j = 0; j < cols; j++) {
+                variance += (h(i, j) - mean) * (h(i, j) - mean);
+            }
+            variance /= static_cast<double>(cols);
+
+            for (std::size_t j = 0; j < cols; j++) {
+                res(i, j) = (h(i, j) - mean) / std::sqrt(variance + 1e-5) * gamma(j) + beta(j);
+            }
+        }
+        return res;
+    }
+
+    double max_difference(const Tensor<double>& a, const Tensor<double>& b) {
+        return a.zipMap(b, [](double const x, double const y) { return std::abs(x - y); })
+                .reduce(0.0, [](double const x, double const y) { return std::max(x, y); });
+    }
+}
+
+TEST_CASE("LayerNorm", "[LayerNorm]") {
+
+    // 37 columns leave a tail after the 16 Welford lanes, the offset makes a one-pass sum of squares cancel
+    Tensor<double> x = Tensor<double>::random({ 6, 37 }, -3, 3, 1) + Tensor<double>::uniform({ 6, 37 }, 1000);
+    Tensor<double> residual = Tensor<double>::random({ 6, 37 }, -3, 3, 2);
+    Tensor<double> gamma = Tensor<double>::random({ 37 }, 0.5, 1.5, 3);
+    Tensor<double> beta = Tensor<double>::random({ 37 }, -1, 1, 4);
+
+    SECTION("Forward") {
+
+        const LinearLib::LayerNormState<double> plain = LinearLib::layerNorm(x, gamma, beta);
+
+        REQUIRE(max_difference(plain.output, reference(x, gamma, beta)) < 1e-10);
+        REQUIRE(plain.sum == x);
+        REQUIRE(plain.sum.data() != x.data());
+
+        const LinearLib::LayerNormState<double> fused = LinearLib::layerNorm(x, residual, gamma, beta);
+
+        REQUIRE(max_difference(fused.output, reference(x + residual, gamma, beta)) < 1e-10);
+        REQUIRE(max_difference(fused.sum, x + residual) == 0);
+        REQUIRE(fused.mean.shape() == Tensor<double>::Shape{ 6 });
+    }
+
+    SECTION("Backward") {
+
+        const Tensor<double> weights = Tensor<double>::random({ 6, 37 }, -1, 1, 5);
+        const Tensor<double> sum_weights = Tensor<double>::random({ 6, 37 }, -1, 1, 6);
+
+        // Loss through both the normalized output and the sum passed on to the next residual connection
+        const auto loss = [&] {
+            const LinearLib::LayerNormState<double> state = LinearLib::layerNorm(x, residual, gamma, beta);
+            return sum(state.output * weights) + sum(state.sum * sum_weights);
+        };
+
+        const LinearLib::LayerNormState<double> state = LinearLib::layerNorm(x, residual, gamma, beta);
+        const LinearLib::LayerNormGradients<double> grad = LinearLib::layerNormBackward(weights, sum_weights, state, gamma);
+
+        for (const std::size_t index : { 0ul, 36ul, 100ul, 221ul }) {
+            REQUIRE(std::abs(numeric_gradient(x, index, loss) - grad.input.data()[index]) < 1e-6);
+            REQUIRE(std::abs(numeric_gradient(residual, index, loss) - grad.input.data()[index]) < 1e-6);
+        }
+        for (const std::size_t index : { 0ul, 17ul, 36ul }) {
+            REQUIRE(std::abs(numeric_gradient(gamma, index, loss) - grad.gamma.data()[index]) < 1e-6);
+            REQUIRE(std::abs(numeric_gradient(beta, index, loss) - grad.beta.data()[index]) < 1e-6);
+        }
+
+        // Without the residual path the input gradient loses the sum gradient
+        const LinearLib::LayerNormGradients<double> plain = LinearLib::layerNormBackward(weights, state, gamma);
+
+        REQUIRE(max_difference(plain.input + sum_weights, grad.input) < 1e-12);
+        REQUIRE(max_difference(plain.gamma, grad.gamma) == 0);
+    }
+
+    SECTION("Shapes") {
+
+        REQUIRE_THROWS_AS(LinearLib::layerNorm(x, Tensor<double>::ones({ 36 }), beta), std::invalid_argument);
+        REQUIRE_THROWS_AS(LinearLib::layerNorm(x, Tensor<double>::ones({ 6, 36 }), gamma, beta), std::invalid_argument);
+
+        const LinearLib::LayerNormState<double> state = LinearLib::layerNorm(x, gamma, beta);
+
+        REQUIRE_THROWS_AS(LinearLib::layerNormBackward(Tensor<double>::ones({ 6, 36 }), state, gamma), std::invalid_argument);
+        REQUIRE_THROWS_AS(LinearLib::layerNormBackward(x, Tensor<double>::ones({ 5, 37 }), state, gamma), std::invalid_argument);
+    }
+}
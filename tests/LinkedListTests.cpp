@@ -0,0 +1,406 @@
+#include "catch2/catch_amalgamated.hpp"
+#include "Dast/collections/LinkedList.hpp"
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+    /// Allocator counting the nodes it has live. Allocators are equal when they share a counter, and do not propagate.
+    template<typename T>
+    struct CountingAllocator {
+        using value_type = T;
+
+        long* live;
+
+        explicit CountingAllocator(long& live) : live(&live) {}
+
+        template<typename U>
+        explicit(false) CountingAllocator(const CountingAllocator<U>& other) : live(other.live) {}
+
+        T* allocate(std::size_t const n) {
+            *live += static_cast<long>(n);
+            return std::allocator<T>().allocate(n);
+        }
+
+        void deallocate(T* ptr, std::size_t const n) {
+            *live -= static_cast<long>(n);
+            std::allocator<T>().deallocate(ptr, n);
+        }
+
+        template<typename U>
+        bool operator==(const CountingAllocator<U>& other) const {
+            return live == other.live;
+        }
+    };
+
+    template<typename T, typename A>
+    std::vector<T> contents(const Dast::LinkedList<T, A>& list) {
+        std::vector<T> res;
+        for (auto it = list.begin(); it != list.end(); ++it) {
+            res.push_back(*it);
+        }
+        return res;
+    }
+
+    template<typename T, typename A>
+    std::set<const void*> nodes(Dast::LinkedList<T, A>& list) {
+        std::set<const void*> res;
+        for (Dast::Node<T>* node = list.get_ptr(); node != nullptr; node = node->next) {
+            res.insert(node);
+        }
+        return res;
+    }
+}
+
+TEST_CASE("Linked List Allocators", "[LinkedList]") {
+
+    using ArenaList = Dast::LinkedList<int, Dast::ArenaAllocator<int>>;
+    using StringArenaList = Dast::LinkedList<std::string, Dast::ArenaAllocator<std::string>>;
+    using CountingList = Dast::LinkedList<std::string, CountingAllocator<std::string>>;
+
+    SECTION("Reuse Through Free Lists") {
+
+        Dast::Arena arena;
+        ArenaList list({ 1, 2, 3, 4 }, Dast::ArenaAllocator<int>(arena));
+
+        // A removed node's chunk is the next one handed out
+        const Dast::Node<int>* second = list.get_ptr()->next;
+        list.remove(1);
+        list.push_back(5);
+        REQUIRE(list.get_ptr()->next->next->next == second);
+        REQUIRE(contents(list) == std::vector<int>{ 1, 3, 4, 5 });
+
+        const std::size_t capacity = arena.capacity();
+        for (int i = 0; i < 1000; i++) {
+            list.pop_front();
+            list.push_back(i);
+        }
+        REQUIRE(arena.capacity() == capacity);
+        REQUIRE(list.size() == 4);
+        REQUIRE(list.get_tail() == 999);
+    }
+
+    SECTION("Release") {
+
+        Dast::Arena arena(1024);
+        {
+            ArenaList list{ Dast::ArenaAllocator<int>(arena) };
+            for (int i = 0; i < 500; i++) {
+                list.push_back(i);
+            }
+            REQUIRE(arena.capacity() > 0);
+        }
+
+        // Trivially destructible nodes are never visited, the arena reclaims them all at once
+        arena.release();
+        REQUIRE(arena.capacity() == 0);
+
+        ArenaList list({ 7 }, Dast::ArenaAllocator<int>(arena));
+        REQUIRE(list.get_head() == 7);
+    }
+
+    SECTION("Propagation") {
+
+        Dast::Arena first;
+        Dast::Arena second;
+
+        ArenaList a({ 1, 2, 3 }, Dast::ArenaAllocator<int>(first));
+        ArenaList b({ 4 }, Dast::ArenaAllocator<int>(second));
+
+        // Copies draw from the same arena
+        ArenaList copy = a;
+        REQUIRE(copy.get_allocator().get_arena() == &first);
+        REQUIRE(contents(copy) == contents(a));
+        REQUIRE(nodes(copy) != nodes(a));
+
+        // Copy assignment takes the source's arena
+        b = a;
+        REQUIRE(b.get_allocator().get_arena() == &first);
+        REQUIRE(contents(b) == std::vector<int>{ 1, 2, 3 });
+
+        // Move assignment takes the arena and the nodes themselves
+        ArenaList c({ 9 }, Dast::ArenaAllocator<int>(second));
+        const std::set<const void*> moved = nodes(copy);
+        c = std::move(copy);
+        REQUIRE(c.get_allocator().get_arena() == &first);
+        REQUIRE(nodes(c) == moved);
+        REQUIRE(copy.empty());
+
+        // Swapping exchanges arenas along with the nodes
+        ArenaList d({ 5, 6 }, Dast::ArenaAllocator<int>(second));
+        const std::set<const void*> a_nodes = nodes(a);
+        swap(a, d);
+        REQUIRE(a.get_allocator().get_arena() == &second);
+        REQUIRE(d.get_allocator().get_arena() == &first);
+        REQUIRE(nodes(d) == a_nodes);
+        REQUIRE(contents(a) == std::vector<int>{ 5, 6 });
+        REQUIRE(a.get_tail() == 6);
+        REQUIRE(d.size() == 3);
+
+        d.push_back(4);
+        REQUIRE(d.get_tail() == 4);
+    }
+
+    SECTION("Without Propagation") {
+
+        long live = 0;
+        long other_live = 0;
+
+        CountingList a({ "a", "b" }, CountingAllocator<std::string>(live));
+        CountingList b({ "c" }, CountingAllocator<std::string>(other_live));
+
+        // Copy assignment keeps the destination's allocator
+        b = a;
+        REQUIRE(live == 2);
+        REQUIRE(other_live == 2);
+        REQUIRE(b.get_allocator() == CountingAllocator<std::string>(other_live));
+
+        // Move assignment between unequal allocators moves the elements into new nodes
+        CountingList c({ "x", "y", "z" }, CountingAllocator<std::string>(live));
+        b = std::move(c);
+        REQUIRE(c.empty());
+        REQUIRE(live == 2);
+        REQUIRE(other_live == 3);
+        REQUIRE(contents(b) == std::vector<std::string>{ "x", "y", "z" });
+        REQUIRE(b.get_tail() == "z");
+
+        // Equal allocators hand over the nodes
+        CountingList d{ CountingAllocator<std::string>(other_live) };
+        const std::set<const void*> moved = nodes(b);
+        d = std::move(b);
+        REQUIRE(nodes(d) == moved);
+        REQUIRE(other_live == 3);
+
+        CountingList e{ CountingAllocator<std::string>(live) };
+        e.push_back("w");
+        swap(a, e);
+        REQUIRE(contents(a) == std::vector<std::string>{ "w" });
+        REQUIRE(contents(e) == std::vector<std::string>{ "a", "b" });
+
+        a.clear();
+        e.clear();
+        d.clear();
+        REQUIRE(live == 0);
+        REQUIRE(other_live == 0);
+    }
+
+    SECTION("Append") {
+
+        long live = 0;
+        long other_live = 0;
+
+        // Equal allocators splice the nodes in constant time
+        CountingList a({ "a", "b" }, CountingAllocator<std::string>(live));
+        CountingList b({ "c", "d" }, CountingAllocator<std::string>(live));
+        const Dast::Node<std::string>* spliced = b.get_ptr();
+        a.append(std::move(b));
+        REQUIRE(b.empty());
+        REQUIRE(b.size() == 0);
+        REQUIRE(live == 4);
+        REQUIRE(a.get_ptr()->next->next == spliced);
+        REQUIRE(a.size() == 4);
+        REQUIRE(a.get_tail() == "d");
+
+        // Unequal allocators move the elements over one by one
+        CountingList c({ "e", "f" }, CountingAllocator<std::string>(other_live));
+        a.append(std::move(c));
+        REQUIRE(c.empty());
+        REQUIRE(other_live == 0);
+        REQUIRE(live == 6);
+        REQUIRE(contents(a) == std::vector<std::string>{ "a", "b", "c", "d", "e", "f" });
+        REQUIRE(a.get_tail() == "f");
+
+        // Into an empty list, and of an empty list
+        CountingList empty{ CountingAllocator<std::string>(live) };
+        empty.append(std::move(a));
+        REQUIRE(empty.size() == 6);
+        REQUIRE(a.empty());
+        empty.append(std::move(a));
+        REQUIRE(empty.size() == 6);
+        empty.push_back("g");
+        REQUIRE(empty.get_tail() == "g");
+    }
+
+    SECTION("Clear") {
+
+        Dast::Arena arena;
+
+        // Trivially destructible elements in an arena are dropped without touching the nodes, whose chunks are
+        // therefore not reused
+        ArenaList ints({ 1, 2, 3 }, Dast::ArenaAllocator<int>(arena));
+        const std::set<const void*> int_nodes = nodes(ints);
+        ints.clear();
+        REQUIRE(ints.empty());
+        REQUIRE(ints.size() == 0);
+        ints.push_back(4);
+        REQUIRE_FALSE(int_nodes.contains(ints.get_ptr()));
+        REQUIRE(ints.get_head() == 4);
+        REQUIRE(ints.get_tail() == 4);
+
+        // Other elements are destroyed one by one, which gives the chunks back
+        StringArenaList strings({ "a", "b", "c" }, Dast::ArenaAllocator<std::string>(arena));
+        const std::set<const void*> string_nodes = nodes(strings);
+        strings.clear();
+        REQUIRE(strings.empty());
+        strings.push_back("d");
+        REQUIRE(string_nodes.contains(strings.get_ptr()));
+
+        // Lists drawing from the same arena splice in constant time
+        StringArenaList more({ "e" }, Dast::ArenaAllocator<std::string>(arena));
+        strings.append(std::move(more));
+        REQUIRE(contents(strings) == std::vector<std::string>{ "d", "e" });
+    }
+}
+
+TEST_CASE("Linked List", "[LinkedList]") {
+
+    using List = Dast::LinkedList<int>;
+
+    SECTION("Tail And Size") {
+
+        List list;
+        REQUIRE(list.empty());
+        REQUIRE(list.size() == 0);
+
+        list.push_back(2);
+        REQUIRE(list.get_head() == 2);
+        REQUIRE(list.get_tail() == 2);
+
+        list.push_front(1);
+        list.push_back(4);
+        list.insert(1, 3);
+        REQUIRE(contents(list) == std::vector<int>{ 1, 2, 3, 4 });
+        REQUIRE(list.size() == 4);
+
+        // Inserting after the tail moves it
+        list.insert(3, 5);
+        REQUIRE(list.get_tail() == 5);
+        REQUIRE(list.size() == 5);
+        REQUIRE_THROWS_AS(list.insert(5, 6), std::out_of_range);
+
+        // Removing the tail moves it back
+        list.remove(4);
+        REQUIRE(list.get_tail() == 4);
+        REQUIRE_THROWS_AS(list.remove(4), std::out_of_range);
+
+        while (list.size() > 1) {
+            list.pop_front();
+        }
+        REQUIRE(list.get_head() == 4);
+        REQUIRE(list.get_tail() == 4);
+
+        list.pop_front();
+        REQUIRE(list.empty());
+        list.pop_front();
+        REQUIRE(list.size() == 0);
+
+        // The tail is reset with the last element, so the list starts over cleanly
+        list.push_back(7);
+        list.push_back(8);
+        REQUIRE(contents(list) == std::vector<int>{ 7, 8 });
+        REQUIRE(list.get_tail() == 8);
+    }
+
+    SECTION("Emplace") {
+
+        Dast::LinkedList<std::pair<int, std::string>> list;
+
+        auto& back = list.emplace_back(1, "one");
+        auto& front = list.emplace_front(0, "zero");
+        list.emplace_back(2, std::string(3, 'x'));
+
+        REQUIRE(front == std::pair<int, std::string>(0, "zero"));
+        REQUIRE(list.get_tail().second == "xxx");
+        REQUIRE(list.size() == 3);
+
+        // The returned references are the stored elements
+        back.second = "uno";
+        REQUIRE(list.at(1).second == "uno");
+
+        Dast::LinkedList<std::string> strings;
+        strings.emplace_front(2, 'a');
+        REQUIRE(strings.get_head() == "aa");
+        REQUIRE(strings.get_tail() == "aa");
+    }
+
+    SECTION("Erase After") {
+
+        List list({ 0, 1, 2, 3, 4 });
+
+        Dast::Node<int>* head = list.get_ptr();
+        list.erase_after(head);
+        REQUIRE(contents(list) == std::vector<int>{ 0, 2, 3, 4 });
+
+        // Erasing the last node moves the tail to the given one
+        Dast::Node<int>* third = head->next->next;
+        list.erase_after(third);
+        REQUIRE(list.get_tail() == 3);
+        REQUIRE(list.size() == 3);
+        list.push_back(5);
+        REQUIRE(contents(list) == std::vector<int>{ 0, 2, 3, 5 });
+
+        // Erasing every other node while walking
+        for (Dast::Node<int>* node = list.get_ptr(); node != nullptr && node->next != nullptr; node = node->next) {
+            list.erase_after(node);
+        }
+        REQUIRE(contents(list) == std::vector<int>{ 0, 3 });
+        REQUIRE(list.get_tail() == 3);
+        REQUIRE(list.size() == 2);
+    }
+
+    SECTION("Append") {
+
+        List a({ 1, 2 });
+        List b({ 3 });
+
+        a.append(std::move(b));
+        REQUIRE(contents(a) == std::vector<int>{ 1, 2, 3 });
+        REQUIRE(a.size() == 3);
+        REQUIRE(a.get_tail() == 3);
+        REQUIRE(b.empty());
+
+        // The emptied list can be used again, and keeps its own tail
+        b.push_back(4);
+        REQUIRE(b.get_head() == 4);
+        REQUIRE(b.get_tail() == 4);
+        a.append(std::move(b));
+        a.push_back(5);
+        REQUIRE(contents(a) == std::vector<int>{ 1, 2, 3, 4, 5 });
+
+        // Appending a list to itself leaves it unchanged
+        a.append(std::move(a));
+        REQUIRE(a.size() == 5);
+
+        List empty;
+        empty.append(std::move(a));
+        REQUIRE(empty.size() == 5);
+        REQUIRE(empty.get_tail() == 5);
+        REQUIRE(a.size() == 0);
+    }
+
+    SECTION("Lookup And Copy") {
+
+        List list({ 5, 6, 7 });
+        REQUIRE(list[2] == 7);
+        REQUIRE(list.at(0) == 5);
+        REQUIRE_THROWS_AS(list.at(3), std::out_of_range);
+        REQUIRE(list.contains(6));
+        REQUIRE_FALSE(list.contains(8));
+
+        List copy = list;
+        copy.push_back(8);
+        REQUIRE(list.size() == 3);
+        REQUIRE(copy.size() == 4);
+        REQUIRE(copy.get_tail() == 8);
+
+        list = copy;
+        REQUIRE(contents(list) == std::vector<int>{ 5, 6, 7, 8 });
+        REQUIRE(list.get_tail() == 8);
+
+        List moved = std::move(list);
+        REQUIRE(moved.size() == 4);
+        REQUIRE(list.empty());
+        REQUIRE(list.size() == 0);
+    }
+}
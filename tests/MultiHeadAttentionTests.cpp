@@ -0,0 +1,156 @@
+#include "catch2/catch_amalgamated.hpp"
+#include "Orion/MultiHeadAttention.hpp"
+
+namespace {
+    using LinearLib::Tensor;
+
+    double sum(const Tensor<double>& t) {
+        return t.reduce(0.0, [](double const a, double const b) { return a + b; });
+    }
+
+    /// Central difference of sum(weights * f()) with respect to one entry of x.
+    template<typename F>
+    double numeric_gradient(Tensor<double>& x, std::size_t const index, const Tensor<double>& weights, F&& f) {
+        constexpr double h = 1e-6;
+        const double original = x.data()[index];
+
+        x.data()[index] = original + h;
+        const double up = sum(f() * weights);
+        x.data()[index] = original - h;
+        const double down = sum(f() * weights);
+        x.data()[index] = original;
+
+        return (up - down) / (2 * h);
+    }
+}
+
+TEST_CASE("Multi-Head Attention", "[Attention]") {
+
+    Orion::MultiHeadAttention<double> mha(16, 4, 1);
+    mha.qkv_bias.value = Tensor<double>::random({ 48 }, -0.5, 0.5, 2);
+    mha.out_bias.value = Tensor<double>::random({ 16 }, -0.5, 0.5, 3);
+
+    Tensor<double> x = Tensor<double>::random({ 2, 70, 16 }, -1, 1, 4);
+    Tensor<double> memory = Tensor<double>::random({ 2, 90, 16 }, -1, 1, 5);
+
+    const std::vector<std::size_t> lengths = { 70, 41 };
+
+    SECTION("Forward") {
+
+        const Tensor<double> y = mha.forward(x, { .causal = true });
+
+        // One head at a time, with the score matrix materialized
+        const Tensor<double> qkv = LinearLib::matmul(x, mha.qkv_weight.value);
+        Tensor<double> context({ 2, 70, 16 });
+        for (std::size_t h = 0; h < 4; h++) {
+            Tensor<double> qh({ 2, 70, 4 }), kh({ 2, 70, 4 }), vh({ 2, 70, 4 });
+            for (std::size_t b = 0; b < 2; b++) {
+                for (std::size_t i = 0; i < 70; i++) {
+                    for (std::size_t j = 0; j < 4; j++) {
+                        qh(b, i, j) = qkv(b, i, h * 4 + j) + mha.qkv_bias.value(h * 4 + j);
+                        kh(b, i, j) = qkv(b, i, 16 + h * 4 + j) + mha.qkv_bias.value(16 + h * 4 + j);
+                        vh(b, i, j) = qkv(b, i, 32 + h * 4 + j) + mha.qkv_bias.value(32 + h * 4 + j);
+                    }
+                }
+            }
+            const Tensor<double> scores = LinearLib::matmul(qh, kh.transpose()) * 0.5;
+            const Tensor<double> heads = LinearLib::matmul(LinearLib::softmax(scores, { .causal = true }), vh);
+            for (std::size_t b = 0; b < 2; b++) {
+                for (std::size_t i = 0; i < 70; i++) {
+                    for (std::size_t j = 0; j < 4; j++) {
+                        context(b, i, h * 4 + j) = heads(b, i, j);
+                    }
+                }
+            }
+        }
+
+        Tensor<double> expected = LinearLib::matmul(context, mha.out_weight.value);
+        for (std::size_t b = 0; b < 2; b++) {
+            for (std::size_t i = 0; i < 70; i++) {
+                for (std::size_t j = 0; j < 16; j++) {
+                    expected(b, i, j) += mha.out_bias.value(j);
+                }
+            }
+        }
+
+        const double difference = y.zipMap(expected, [](double const a, double const b) { return std::abs(a - b); })
+                .reduce(0.0, [](double const a, double const b) { return std::max(a, b); });
+        REQUIRE(difference < 1e-12);
+    }
+
+    SECTION("Self-Attention Backward") {
+
+        const Tensor<double> weights = Tensor<double>::random({ 2, 70, 16 }, -1, 1, 6);
+        const auto f = [&] { return mha.forward(x, { .causal = true, .lengths = lengths }); };
+
+        f();
+        const Tensor<double> dx = mha.backward(weights);
+
+        for (const std::size_t index : { 0ul, 17ul, 555ul, 70ul * 16 + 40 * 16 + 3, 70ul * 16 + 69 * 16 + 15 }) {
+            REQUIRE(std::abs(numeric_gradient(x, index, weights, f) - dx.data()[index]) < 1e-7);
+        }
+        for (const std::size_t index : { 0ul, 100ul, 16ul * 48 - 1 }) {
+            REQUIRE(std::abs(numeric_gradient(mha.qkv_weight.value, index, weights, f) - mha.qkv_weight.grad.data()[index]) < 1e-7);
+        }
+        for (const std::size_t index : { 3ul, 20ul, 47ul }) {
+            REQUIRE(std::abs(numeric_gradient(mha.qkv_bias.value, index, weights, f) - mha.qkv_bias.grad.data()[index]) < 1e-7);
+        }
+        REQUIRE(std::abs(numeric_gradient(mha.out_weight.value, 37, weights, f) - mha.out_weight.grad.data()[37]) < 1e-7);
+        REQUIRE(std::abs(numeric_gradient(mha.out_bias.value, 5, weights, f) - mha.out_bias.grad.data()[5]) < 1e-7);
+    }
+
+    SECTION("Cross-Attention Backward") {
+
+        const Tensor<double> weights = Tensor<double>::random({ 2, 70, 16 }, -1, 1, 7);
+        const auto f = [&] { return mha.forward(x, memory, { .lengths = lengths }); };
+
+        f();
+        const Tensor<double> dx = mha.backward(weights);
+        const Tensor<double> dmemory = mha.memory_grad();
+
+        for (const std::size_t index : { 5ul, 70ul * 16 + 2 }) {
+            REQUIRE(std::abs(numeric_gradient(x, index, weights, f) - dx.data()[index]) < 1e-7);
+        }
+        for (const std::size_t index : { 7ul, 90ul * 16 + 40 * 16 + 1, 90ul * 16 + 41 * 16 }) {
+            REQUIRE(std::abs(numeric_gradient(memory, index, weights, f) - dmemory.data()[index]) < 1e-7);
+        }
+        REQUIRE(std::abs(numeric_gradient(mha.qkv_weight.value, 16 * 48 - 1, weights, f) - mha.qkv_weight.grad.data()[16 * 48 - 1]) < 1e-7);
+    }
+
+    SECTION("Shapes") {
+
+        REQUIRE_THROWS_AS(Orion::MultiHeadAttention<double>(16, 3), std::invalid_argument);
+        REQUIRE_THROWS_AS(mha.forward(Tensor<double>({ 2, 70, 8 })), std::invalid_argument);
+        REQUIRE_THROWS_AS(mha.backward(x), std::invalid_argument);
+    }
+
+    SECTION("Seeds") {
+
+        const auto same = [](const Tensor<double>& a, const Tensor<double>& b, std::size_t const n) {
+            return std::equal(a.data(), a.data() + n, b.data());
+        };
+
+        // Layers built without a seed start from different weights
+        const Orion::MultiHeadAttention<double> first(16, 4);
+        const Orion::MultiHeadAttention<double> second(16, 4);
+        REQUIRE_FALSE(same(first.qkv_weight.value, second.qkv_weight.value, 16 * 48));
+        REQUIRE_FALSE(same(first.out_weight.value, second.out_weight.value, 16 * 16));
+
+        // The same seed gives the same weights
+        const Orion::MultiHeadAttention<double> again(16, 4, 1);
+        REQUIRE(same(again.qkv_weight.value, mha.qkv_weight.value, 16 * 48));
+        REQUIRE(same(again.out_weight.value, mha.out_weight.value, 16 * 16));
+
+        // Consecutive seeds share no stream, neither between layers nor between a layer's weights
+        const Orion::MultiHeadAttention<double> next(16, 4, 2);
+        REQUIRE_FALSE(same(next.qkv_weight.value, mha.qkv_weight.value, 16));
+        REQUIRE_FALSE(same(next.qkv_weight.value, mha.out_weight.value, 16));
+        REQUIRE_FALSE(same(mha.qkv_weight.value, mha.out_weight.value, 16));
+
+        // Xavier limits still hold
+        const double limit = std::sqrt(6.0 / 32.0);
+        for (std::size_t i = 0; i < 16 * 16; i++) {
+            REQUIRE(std::abs(first.out_weight.value.data()[i]) <= limit);
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#include "catch2/catch_amalgamated.hpp"
+#include "Orion/Embedding.hpp"
+#include "Orion/PositionalEncoding.hpp"
+
+TEST_CASE("Positional Encoding", "[Embedding]") {
+
+    using LinearLib::Tensor;
+
+    SECTION("Table") {
+
+        const Orion::PositionalEncoding<double> encoding(100, 16);
+
+        REQUIRE(encoding.table().isContiguous());
+        REQUIRE(reinterpret_cast<std::uintptr_t>(encoding.table().data()) % 64 == 0);
+        REQUIRE(encoding.row(0)[0] == 0.0);
+        REQUIRE(encoding.row(0)[1] == 1.0);
+        REQUIRE(std::abs(encoding.row(37)[6] - std::sin(37 / std::pow(10000.0, 6.0 / 16))) < 1e-15);
+        REQUIRE(std::abs(encoding.row(99)[15] - std::cos(99 / std::pow(10000.0, 14.0 / 16))) < 1e-15);
+        REQUIRE_THROWS_AS(encoding.row(100), std::out_of_range);
+    }
+
+    SECTION("Compile Time") {
+
+        static constexpr LinearLib::Matrix<64, 16, double> table = Orion::positional_encoding<64, 16, double>();
+        static_assert(table.data[0][1] == 1.0);
+
+        const Orion::PositionalEncoding<double> runtime(64, 16);
+        const Orion::PositionalEncoding<double> fixed(table);
+
+        double difference = 0;
+        for (std::size_t i = 0; i < 64; i++) {
+            for (std::size_t j = 0; j < 16; j++) {
+                difference = std::max(difference, std::abs(runtime.row(i)[j] - fixed.row(i)[j]));
+            }
+        }
+        REQUIRE(difference < 1e-13);
+    }
+
+    SECTION("Fused Embedding") {
+
+        Orion::Embedding<double> embedding(50, 16, 1);
+        const Orion::PositionalEncoding<double> encoding(20, 16);
+        const Tensor<std::size_t> tokens({ 2, 3 }, { 4, 17, 4, 49, 0, 17 });
+
+        const Tensor<double> x = embedding.forward(tokens, encoding, 5);
+
+        for (std::size_t i = 0; i < 2; i++) {
+            for (std::size_t j = 0; j < 3; j++) {
+                for (std::size_t k = 0; k < 16; k++) {
+                    REQUIRE(std::abs(x(i, j, k) - (4 * embedding.weight(tokens(i, j), k) + encoding.row(5 + j)[k])) < 1e-15);
+                }
+            }
+        }
+
+        embedding.backward(Tensor<double>::ones({ 2, 3, 16 }));
+
+        REQUIRE(embedding.grad().values(0)[0] == 8.0);
+        REQUIRE_THROWS_AS(embedding.forward(tokens, encoding, 18), std::out_of_range);
+        REQUIRE_THROWS_AS(embedding.forward(tokens, Orion::PositionalEncoding<double>(20, 8)), std::invalid_argument);
+    }
+}
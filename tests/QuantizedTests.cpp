@@ -0,0 +1,80 @@
+#include "catch2/catch_amalgamated.hpp"
+#include "LinearLib/Quantized.hpp"
+
+#include <cmath>
+
+namespace {
+    using LinearLib::Tensor;
+
+    /// Largest error of the int8 product against the float one, relative to the bound of k rounding steps.
+    float relative_error(std::size_t const m, std::size_t const k, std::size_t const n) {
+        const Tensor<float> x = Tensor<float>::random({ m, k }, -1, 1, 1);
+        const Tensor<float> w = Tensor<float>::random({ k, n }, -1, 1, 2);
+
+        const LinearLib::QuantizedMatrix quantized(w);
+        const Tensor<float> res = LinearLib::matmul(x, quantized);
+        const Tensor<float> expected = LinearLib::matmul(x, w);
+
+        REQUIRE(res.shape(0) == m);
+        REQUIRE(res.shape(1) == n);
+
+        // Rounding both operands costs each term at most half a step of each, up to 1 / 127 in total
+        const float bound = static_cast<float>(k) / 127.0f;
+        return res.zipMap(expected, [](float const a, float const b) { return std::abs(a - b); })
+                   .reduce(0.0f, [](float const a, float const b) { return std::max(a, b); }) / bound;
+    }
+}
+
+TEST_CASE("Quantized Matrix", "[Quantized]") {
+
+    SECTION("Quantization") {
+
+        const Tensor<float> w = Tensor<float>::random({ 19, 21 }, -2, 2, 3);
+        const LinearLib::QuantizedMatrix quantized(w);
+
+        REQUIRE(quantized.rows() == 19);
+        REQUIRE(quantized.cols() == 21);
+
+        const Tensor<float> dequantized = quantized.dequantize();
+        for (std::size_t j = 0; j < 21; j++) {
+            float max = 0;
+            for (std::size_t p = 0; p < 19; p++) {
+                max = std::max(max, std::abs(w(p, j)));
+                REQUIRE(std::abs(dequantized(p, j) - w(p, j)) <= quantized.scale(j) / 2 * 1.0001f);
+                REQUIRE(std::abs(quantized.at(p, j)) <= 127);
+            }
+            REQUIRE(std::abs(quantized.scale(j) * 127 - max) < 1e-6f);
+        }
+
+        REQUIRE_THROWS_AS(quantized.at(19, 0), std::out_of_range);
+        REQUIRE_THROWS_AS(LinearLib::QuantizedMatrix(Tensor<float>({ 4 })), std::invalid_argument);
+        REQUIRE_THROWS_AS(LinearLib::matmul(Tensor<float>({ 2, 18 }), quantized), std::invalid_argument);
+    }
+
+    SECTION("Product") {
+
+        // k not a multiple of the 4 deep groups, n not a multiple of the 16 column blocks, m not a multiple of 4 rows
+        REQUIRE(relative_error(7, 37, 45) < 0.25f);
+        REQUIRE(relative_error(1, 3, 5) < 0.5f);
+        REQUIRE(relative_error(13, 66, 17) < 0.25f);
+
+        // Large enough to run on the thread pool
+        REQUIRE(relative_error(65, 130, 257) < 0.25f);
+    }
+
+    SECTION("Zero Columns") {
+
+        Tensor<float> w = Tensor<float>::random({ 9, 18 }, -1, 1, 4);
+        for (std::size_t p = 0; p < 9; p++) {
+            w(p, 17) = 0;
+        }
+        const Tensor<float> x = Tensor<float>::random({ 3, 9 }, -1, 1, 5);
+        const Tensor<float> res = LinearLib::matmul(x, LinearLib::QuantizedMatrix(w));
+
+        for (std::size_t i = 0; i < 3; i++) {
+            REQUIRE(res(i, 17) == 0);
+        }
+        REQUIRE(LinearLib::matmul(Tensor<float>::zeros({ 2, 9 }), LinearLib::QuantizedMatrix(w))
+                    .reduce(0.0f, [](float const a, float const b) { return a + std::abs(b); }) == 0);
+    }
+}
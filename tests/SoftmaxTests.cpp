@@ -0,0 +1,182 @@
+#include "catch2/catch_amalgamated.hpp"
+#include "LinearLib/Softmax.hpp"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+    using LinearLib::Tensor;
+
+    /// Softmax of each row over its first limit columns in double.
+    std::vector<double> reference(const float* row, std::size_t const limit) {
+        double max = -std::numeric_limits<double>::infinity();
+        for (std::size_t j = 0; j < limit; j++) {
+            max = std::max(max, static_cast<double>(row[j]));
+        }
+        double sum = 0;
+        std::vector<double> res(limit);
+        for (std::size_t j = 0; j < limit; j++) {
+            res[j] = std::exp(row[j] - max);
+            sum += res[j];
+        }
+        for (double& x : res) {
+            x /= sum;
+        }
+        return res;
+    }
+
+    /// Checks one row of softmax and logSoftmax output against the reference, with columns from limit on masked.
+    void check_row(const float* in, const float* out, const float* log_out, std::size_t const cols,
+                   std::size_t const limit) {
+        const std::vector<double> expected = reference(in, limit);
+        for (std::size_t j = 0; j < limit; j++) {
+            // x - max is rounded to float first, which costs up to half an ulp of the difference
+            const double tolerance = 1e-6 + std::abs(std::log(expected[j])) * 0x1p-24;
+            REQUIRE(std::abs(out[j] - expected[j]) <= tolerance * expected[j]);
+            REQUIRE(std::abs(log_out[j] - std::log(expected[j])) <= 1e-5);
+        }
+        for (std::size_t j = limit; j < cols; j++) {
+            REQUIRE(out[j] == 0);
+            REQUIRE(log_out[j] == -std::numeric_limits<float>::infinity());
+        }
+    }
+}
+
+TEST_CASE("Softmax", "[Softmax]") {
+
+    SECTION("Rows") {
+
+        // Row lengths below, at and past the four registers of the online pass, plus a scalar tail
+        for (const std::size_t cols : { 1, 3, 16, 64, 100, 131 }) {
+            const Tensor<float> x = Tensor<float>::random({ 5, cols }, -20, 20, cols);
+            const Tensor<float> out = LinearLib::softmax(x);
+            const Tensor<float> log_out = LinearLib::logSoftmax(x);
+
+            REQUIRE(out.shape() == x.shape());
+            for (std::size_t i = 0; i < 5; i++) {
+                check_row(x.data() + i * cols, out.data() + i * cols, log_out.data() + i * cols, cols, cols);
+            }
+        }
+    }
+
+    SECTION("Other Types") {
+
+        const Tensor<double> x = Tensor<double>::random({ 3, 9 }, -5, 5, 1);
+        const Tensor<double> out = LinearLib::softmax(x);
+        for (std::size_t i = 0; i < 3; i++) {
+            double sum = 0;
+            for (std::size_t j = 0; j < 9; j++) {
+                sum += out(i, j);
+                REQUIRE(std::abs(std::log(out(i, j)) - LinearLib::logSoftmax(x)(i, j)) < 1e-12);
+            }
+            REQUIRE(std::abs(sum - 1) < 1e-12);
+        }
+
+        const Tensor<LinearLib::BFloat16> half = x.map([](double const v) { return LinearLib::BFloat16(static_cast<float>(v)); });
+        const Tensor<LinearLib::BFloat16> half_out = LinearLib::softmax(half);
+        for (std::size_t i = 0; i < 3; i++) {
+            for (std::size_t j = 0; j < 9; j++) {
+                REQUIRE(std::abs(static_cast<float>(half_out(i, j)) - out(i, j)) <= 0.02 * out(i, j));
+            }
+        }
+    }
+
+    SECTION("Causal Mask") {
+
+        // Two cached keys before three queries, each query sees them and itself
+        const Tensor<float> x = Tensor<float>::random({ 2, 3, 70 }, -3, 3, 2);
+        const LinearLib::SoftmaxMask mask = { .causal = true, .offset = 2 };
+        const Tensor<float> out = LinearLib::softmax(x, mask);
+        const Tensor<float> log_out = LinearLib::logSoftmax(x, mask);
+
+        for (std::size_t b = 0; b < 2; b++) {
+            for (std::size_t i = 0; i < 3; i++) {
+                const std::size_t offset = (b * 3 + i) * 70;
+                check_row(x.data() + offset, out.data() + offset, log_out.data() + offset, 70, i + 3);
+            }
+        }
+
+        // Without an offset the first row only keeps its first column
+        const Tensor<float> square = LinearLib::softmax(Tensor<float>::random({ 4, 4 }, -1, 1, 3), { .causal = true });
+        REQUIRE(square(0, 0) == 1);
+        REQUIRE(square(0, 1) == 0);
+    }
+
+    SECTION("Lengths") {
+
+        const std::size_t lengths[] = { 70, 5, 0 };
+        const Tensor<float> x = Tensor<float>::random({ 3, 2, 70 }, -3, 3, 4);
+        const LinearLib::SoftmaxMask mask = { .lengths = lengths };
+        const Tensor<float> out = LinearLib::softmax(x, mask);
+        const Tensor<float> log_out = LinearLib::logSoftmax(x, mask);
+
+        // The last batch entry is fully masked, its rows are all 0 and -infinity
+        for (std::size_t b = 0; b < 3; b++) {
+            for (std::size_t i = 0; i < 2; i++) {
+                const std::size_t offset = (b * 2 + i) * 70;
+                check_row(x.data() + offset, out.data() + offset, log_out.data() + offset, 70, lengths[b]);
+            }
+        }
+
+        // Both masks at once keep the shorter prefix
+        const LinearLib::SoftmaxMask both = { .causal = true, .offset = 9, .lengths = lengths };
+        const Tensor<float> combined = LinearLib::softmax(x, both);
+        check_row(x.data(), combined.data(), LinearLib::logSoftmax(x, both).data(), 70, 10);
+        check_row(x.data() + 140, combined.data() + 140, LinearLib::logSoftmax(x, both).data() + 140, 70, 5);
+
+        const std::size_t too_few[] = { 1, 2 };
+        REQUIRE_THROWS_AS(LinearLib::softmax(x, { .lengths = too_few }), std::invalid_argument);
+    }
+
+    SECTION("Clamp") {
+
+        // Inputs more than 87.3 below the row maximum are clamped and give about 1e-38 rather than 0
+        Tensor<float> x({ 1, 40 }, -200.0f);
+        x.data()[0] = 0;
+        const Tensor<float> out = LinearLib::softmax(x);
+
+        REQUIRE(std::abs(out(0, 0) - 1) < 1e-6f);
+        for (std::size_t j = 1; j < 40; j++) {
+            REQUIRE(out(0, j) > 0);
+            REQUIRE(out(0, j) < 2e-38f);
+        }
+
+        // logSoftmax never exponentiates its output and keeps the exact difference
+        REQUIRE(LinearLib::logSoftmax(x)(0, 5) == -200.0f);
+
+        // Large inputs are shifted by the row maximum before exponentiating
+        const Tensor<float> large({ 2, 33 }, 1000.0f);
+        const Tensor<float> uniform = LinearLib::softmax(large);
+        for (std::size_t j = 0; j < 33; j++) {
+            REQUIRE(std::abs(uniform(1, j) - 1.0f / 33) < 1e-7f);
+        }
+    }
+
+    SECTION("Exponentiate") {
+
+        Tensor<float> x = Tensor<float>::random({ 45 }, -10, 10, 5);
+        const Tensor<float> original = x.clone();
+
+        const float sum = LinearLib::exponentiate(x.data(), 45, 2.0f);
+        double expected = 0;
+        for (std::size_t i = 0; i < 45; i++) {
+            const double e = std::exp(static_cast<double>(original(i)) - 2);
+            REQUIRE(std::abs(x(i) - e) <= 1e-6 * e);
+            expected += e;
+        }
+        REQUIRE(std::abs(sum - expected) <= 1e-6 * expected);
+    }
+
+    SECTION("Shapes") {
+
+        REQUIRE_THROWS_AS(LinearLib::softmax(Tensor<float>(Tensor<float>::Shape{})), std::invalid_argument);
+
+        // Empty tensors come back empty, whichever dimension is zero
+        for (const Tensor<float>::Shape& shape : { Tensor<float>::Shape{ 0, 4 }, Tensor<float>::Shape{ 3, 0 },
+                                                   Tensor<float>::Shape{ 0, 2, 5 }, Tensor<float>::Shape{ 0 } }) {
+            REQUIRE(LinearLib::softmax(Tensor<float>(shape)).shape() == shape);
+            REQUIRE(LinearLib::logSoftmax(Tensor<float>(shape), { .causal = true }).shape() == shape);
+        }
+    }
+}
@@ -0,0 +1,309 @@
+#include "catch2/catch_amalgamated.hpp"
+#include "LinearLib/Tensor.hpp"
+
+#include <utility>
+
+namespace {
+    using LinearLib::Tensor;
+    using Shape = Tensor<int>::Shape;
+
+    /// Tensor of the given shape holding 0, 1, 2, ... in row-major order.
+    Tensor<int> iota(Shape shape) {
+        Tensor<int> res(std::move(shape));
+        std::iota(res.data(), res.data() + res.size(), 0);
+        return res;
+    }
+}
+
+TEST_CASE("Tensor", "[Tensor]") {
+
+    SECTION("Construction") {
+
+        const Tensor<int> t({ 2, 3, 4 }, 7);
+
+        REQUIRE(t.rank() == 3);
+        REQUIRE(t.size() == 24);
+        REQUIRE(t.shape() == Shape{ 2, 3, 4 });
+        REQUIRE(t.shape(1) == 3);
+        REQUIRE(t.strides() == Shape{ 12, 4, 1 });
+        REQUIRE(t.isContiguous());
+        REQUIRE(reinterpret_cast<std::uintptr_t>(t.data()) % Tensor<int>::alignment == 0);
+        REQUIRE(t.reduce(0, [](int const a, int const b) { return a + b; }) == 24 * 7);
+
+        REQUIRE(Tensor<double>::zeros({ 3 }) == Tensor<double>({ 3 }, { 0, 0, 0 }));
+        REQUIRE(Tensor<double>::ones({ 2 }) == Tensor<double>({ 2 }, { 1, 1 }));
+        REQUIRE(Tensor<double>::uniform({ 2 }, 2.5) == Tensor<double>({ 2 }, { 2.5, 2.5 }));
+
+        // A scalar has rank 0 and one element
+        const Tensor<int> scalar(Shape{}, 3);
+        REQUIRE(scalar.rank() == 0);
+        REQUIRE(scalar.size() == 1);
+        REQUIRE(scalar() == 3);
+
+        const Tensor<int> empty({ 4, 0 });
+        REQUIRE(empty.size() == 0);
+        REQUIRE(empty.empty());
+
+        REQUIRE_THROWS_AS(Tensor<int>({ 2, 2 }, { 1, 2, 3 }), std::invalid_argument);
+        REQUIRE_THROWS_AS(t.shape(3), std::out_of_range);
+    }
+
+    SECTION("Indexing") {
+
+        Tensor<int> t = iota({ 2, 3, 4 });
+
+        REQUIRE(t(1, 2, 3) == 23);
+        REQUIRE(t(0, 1, 2) == 6);
+
+        t(1, 0, 0) = -1;
+        REQUIRE(t.data()[12] == -1);
+
+        REQUIRE_THROWS_AS(t(2, 0, 0), std::out_of_range);
+        REQUIRE_THROWS_AS(t(0, 3, 0), std::out_of_range);
+        REQUIRE_THROWS_AS(t(0, 0), std::invalid_argument);
+        REQUIRE_THROWS_AS(t[2], std::out_of_range);
+        REQUIRE_THROWS_AS(Tensor<int>(Shape{}, 1)[0], std::out_of_range);
+    }
+
+    SECTION("Views") {
+
+        Tensor<int> t = iota({ 3, 4 });
+
+        // Indexing drops the first dimension and shares the elements
+        Tensor<int> row = t[1];
+        REQUIRE(row.shape() == Shape{ 4 });
+        REQUIRE(row(2) == 6);
+        row(2) = 100;
+        REQUIRE(t(1, 2) == 100);
+
+        // Slices keep the dimension and multiply its stride by the step
+        Tensor<int> columns = t.slice(1, 1, 4, 2);
+        REQUIRE(columns.shape() == Shape{ 3, 2 });
+        REQUIRE(columns.strides() == Shape{ 4, 2 });
+        REQUIRE_FALSE(columns.isContiguous());
+        REQUIRE(columns(2, 1) == 11);
+
+        columns.fill(-1);
+        REQUIRE(t == Tensor<int>({ 3, 4 }, { 0, -1, 2, -1, 4, -1, 100, -1, 8, -1, 10, -1 }));
+
+        REQUIRE(t.slice(0, 1, 1).size() == 0);
+        REQUIRE(t.slice(0, 0, 3, 5).shape() == Shape{ 1, 4 });
+
+        REQUIRE_THROWS_AS(t.slice(2, 0, 1), std::out_of_range);
+        REQUIRE_THROWS_AS(t.slice(0, 2, 1), std::out_of_range);
+        REQUIRE_THROWS_AS(t.slice(0, 0, 4), std::out_of_range);
+        REQUIRE_THROWS_AS(t.slice(0, 0, 1, 0), std::out_of_range);
+
+        // A const tensor's views read the same elements, and are not protected against writes either
+        const Tensor<int>& read_only = t;
+        REQUIRE(read_only[2](1) == -1);
+        REQUIRE(read_only.transpose()(3, 0) == -1);
+
+        Tensor<int> shared = read_only.view({ 4, 3 });
+        shared.data()[0] = 42;
+        REQUIRE(t(0, 0) == 42);
+        Tensor<int> dense = read_only.contiguous();
+        dense(2, 3) = 7;
+        REQUIRE(t(2, 3) == 7);
+    }
+
+    SECTION("Clone") {
+
+        Tensor<int> t = iota({ 4, 5 });
+        const Tensor<int> copy = t;
+        const Tensor<int> cloned = t.clone();
+
+        t(0, 0) = 42;
+        REQUIRE(copy(0, 0) == 42);
+        REQUIRE(cloned(0, 0) == 0);
+        REQUIRE(cloned.data() != t.data());
+
+        // Cloning a view makes it contiguous, through the tiled transpose for transposed views
+        const Tensor<int> transposed = t.transpose().clone();
+        REQUIRE(transposed.isContiguous());
+        REQUIRE(transposed.shape() == Shape{ 5, 4 });
+        for (std::size_t i = 0; i < 5; i++) {
+            for (std::size_t j = 0; j < 4; j++) {
+                REQUIRE(transposed(i, j) == t(j, i));
+            }
+        }
+
+        const Tensor<int> strided = t.slice(1, 0, 5, 2).clone();
+        REQUIRE(strided == Tensor<int>({ 4, 3 }, { 42, 2, 4, 5, 7, 9, 10, 12, 14, 15, 17, 19 }));
+
+        // contiguous() only copies when it has to
+        REQUIRE(t.contiguous().data() == t.data());
+        REQUIRE(t.transpose().contiguous().data() != t.data());
+
+        REQUIRE(Tensor<int>({ 0, 3 }).clone().shape() == Shape{ 0, 3 });
+    }
+
+    SECTION("Fill And Assign") {
+
+        Tensor<double> t({ 3, 3 });
+        t.fill(1.5);
+        REQUIRE(t == Tensor<double>::uniform({ 3, 3 }, 1.5));
+
+        // Filling a view only touches its elements
+        t.transpose()[0].fill(0);
+        REQUIRE(t == Tensor<double>({ 3, 3 }, { 0, 1.5, 1.5, 0, 1.5, 1.5, 0, 1.5, 1.5 }));
+
+        Tensor<double> target({ 3, 3 });
+        target.assign(t.transpose());
+        REQUIRE(target == t.transpose().clone());
+        REQUIRE_THROWS_AS(target.assign(Tensor<double>({ 3 })), std::invalid_argument);
+    }
+
+    SECTION("Random") {
+
+        const Tensor<double> a = Tensor<double>::random({ 1000 }, -2, 3, 7);
+        const Tensor<double> b = Tensor<double>::random({ 1000 }, -2, 3, 7);
+        const Tensor<double> c = Tensor<double>::random({ 1000 }, -2, 3, 8);
+
+        // The same seed gives the same values, another seed different ones
+        REQUIRE(a == b);
+        REQUIRE_FALSE(a == c);
+
+        REQUIRE(a.reduce(0, [](int const n, double const x) { return n + (x >= -2 && x < 3); }) == 1000);
+        const double mean = a.reduce(0.0, [](double const s, double const x) { return s + x; }) / 1000;
+        REQUIRE(std::abs(mean - 0.5) < 0.2);
+
+        const Tensor<int> dice = Tensor<int>::random({ 600 }, 1, 6, 1);
+        REQUIRE(dice.reduce(0, [](int const n, int const x) { return n + (x >= 1 && x <= 6); }) == 600);
+        REQUIRE(dice.reduce(0, [](int const best, int const x) { return std::max(best, x); }) == 6);
+    }
+
+    SECTION("Conversions") {
+
+        const LinearLib::Matrix<2, 3, int> m = { { 1, 2, 3 }, { 4, 5, 6 } };
+        const Tensor<int> t(m);
+        REQUIRE(t.shape() == Shape{ 2, 3 });
+        REQUIRE(t(1, 0) == 4);
+        REQUIRE(t.toMatrix<2, 3>() == m);
+        REQUIRE(t.transpose().toMatrix<3, 2>()[2][1] == 6);
+        REQUIRE_THROWS_AS((t.toMatrix<3, 2>()), std::invalid_argument);
+
+        // viewOf shares the matrix' elements
+        LinearLib::Matrix<2, 2, int> source = { { 1, 2 }, { 3, 4 } };
+        Tensor<int> view = Tensor<int>::viewOf(source);
+        view(0, 1) = 9;
+        REQUIRE(source[0][1] == 9);
+
+        const Tensor<int> v(LinearLib::Vector<3, int>{ 1, 2, 3 });
+        REQUIRE(v.shape() == Shape{ 3 });
+        REQUIRE(v.toVector<3>()[2] == 3);
+        REQUIRE_THROWS_AS(v.toVector<2>(), std::invalid_argument);
+    }
+
+    SECTION("Arithmetic") {
+
+        const Tensor<int> a({ 2, 2 }, { 1, 2, 3, 4 });
+        const Tensor<int> b({ 2, 2 }, { 5, 6, 7, 8 });
+
+        REQUIRE(a + b == Tensor<int>({ 2, 2 }, { 6, 8, 10, 12 }));
+        REQUIRE(b - a == Tensor<int>({ 2, 2 }, { 4, 4, 4, 4 }));
+        REQUIRE(a * b == Tensor<int>({ 2, 2 }, { 5, 12, 21, 32 }));
+        REQUIRE(a * 3 == Tensor<int>({ 2, 2 }, { 3, 6, 9, 12 }));
+        REQUIRE((a & b) == Tensor<int>({ 2, 2 }, { 19, 22, 43, 50 }));
+
+        // Views combine element by element through their strides
+        REQUIRE(a.transpose() + a == Tensor<int>({ 2, 2 }, { 2, 5, 5, 8 }));
+
+        REQUIRE_FALSE(a == Tensor<int>({ 4 }, { 1, 2, 3, 4 }));
+        REQUIRE_THROWS_AS(a + Tensor<int>({ 4 }), std::invalid_argument);
+        REQUIRE_THROWS_AS(a * Tensor<int>({ 2, 3 }), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Tensor Layout", "[Tensor]") {
+
+    SECTION("View And Reshape") {
+
+        Tensor<int> t = iota({ 2, 3, 4 });
+
+        // Contiguous elements are viewed in place
+        Tensor<int> flat = t.view({ 6, 4 });
+        REQUIRE(flat.strides() == Shape{ 4, 1 });
+        REQUIRE(flat.data() == t.data());
+        REQUIRE(flat(5, 3) == 23);
+
+        Tensor<int> reshaped = t.reshape({ 4, 6 });
+        REQUIRE(reshaped.data() == t.data());
+        reshaped(3, 5) = -1;
+        REQUIRE(t(1, 2, 3) == -1);
+
+        REQUIRE(t.reshape({ 24 }).shape() == Shape{ 24 });
+        REQUIRE(Tensor<int>({ 1 }, { 5 }).reshape({})() == 5);
+
+        // A strided tensor cannot be viewed, reshape copies it in row-major order of its own indices
+        const Tensor<int> transposed = iota({ 2, 3 }).transpose();
+        REQUIRE_THROWS_AS(transposed.view({ 6 }), std::invalid_argument);
+        const Tensor<int> copied = transposed.reshape({ 6 });
+        REQUIRE(copied == Tensor<int>({ 6 }, { 0, 3, 1, 4, 2, 5 }));
+
+        REQUIRE_THROWS_AS(t.view({ 5, 5 }), std::invalid_argument);
+        REQUIRE_THROWS_AS(t.reshape({ 25 }), std::invalid_argument);
+    }
+
+    SECTION("Permute") {
+
+        const Tensor<int> t = iota({ 2, 3, 4 });
+        const Tensor<int> p = t.permute({ 2, 0, 1 });
+
+        REQUIRE(p.shape() == Shape{ 4, 2, 3 });
+        REQUIRE(p.strides() == Shape{ 1, 12, 4 });
+        REQUIRE(p.data() == t.data());
+        REQUIRE_FALSE(p.isContiguous());
+
+        for (std::size_t i = 0; i < 2; i++) {
+            for (std::size_t j = 0; j < 3; j++) {
+                for (std::size_t k = 0; k < 4; k++) {
+                    REQUIRE(p(k, i, j) == t(i, j, k));
+                }
+            }
+        }
+
+        // contiguous() materializes the permuted layout
+        const Tensor<int> dense = p.contiguous();
+        REQUIRE(dense.isContiguous());
+        REQUIRE(dense.strides() == Shape{ 6, 3, 1 });
+        REQUIRE(dense(3, 1, 2) == t(1, 2, 3));
+
+        // Permuting back restores the original layout, and the identity permutation is a plain view
+        REQUIRE(p.permute({ 1, 2, 0 }).strides() == t.strides());
+        REQUIRE(p.permute({ 1, 2, 0 }) == t);
+        REQUIRE(t.permute({ 0, 1, 2 }).isContiguous());
+
+        REQUIRE_THROWS_AS(t.permute({ 0, 1 }), std::invalid_argument);
+        REQUIRE_THROWS_AS(t.permute({ 0, 1, 1 }), std::invalid_argument);
+        REQUIRE_THROWS_AS(t.permute({ 0, 1, 3 }), std::invalid_argument);
+    }
+
+    SECTION("Transpose") {
+
+        const Tensor<int> t = iota({ 2, 3, 4 });
+
+        const Tensor<int> last = t.transpose();
+        REQUIRE(last.shape() == Shape{ 2, 4, 3 });
+        REQUIRE(last(1, 3, 2) == t(1, 2, 3));
+
+        const Tensor<int> outer = t.transpose(0, 2);
+        REQUIRE(outer.shape() == Shape{ 4, 3, 2 });
+        REQUIRE(outer(3, 1, 0) == t(0, 1, 3));
+
+        // Batched transposed copies go through the tiled kernel one matrix at a time
+        const Tensor<float> large = Tensor<float>::random({ 3, 37, 45 }, -1, 1, 1);
+        const Tensor<float> copy = large.transpose().clone();
+        REQUIRE(copy.shape() == Tensor<float>::Shape{ 3, 45, 37 });
+        for (std::size_t b = 0; b < 3; b++) {
+            for (std::size_t i = 0; i < 45; i++) {
+                for (std::size_t j = 0; j < 37; j++) {
+                    REQUIRE(copy(b, i, j) == large(b, j, i));
+                }
+            }
+        }
+
+        REQUIRE_THROWS_AS(Tensor<int>({ 3 }).transpose(), std::invalid_argument);
+        REQUIRE_THROWS_AS(t.transpose(0, 3), std::out_of_range);
+    }
+}
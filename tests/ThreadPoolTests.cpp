@@ -0,0 +1,112 @@
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "catch2/catch_amalgamated.hpp"
+#include "LinearLib/Gemm.hpp"
+#include "LinearLib/Tensor.hpp"
+#include "LinearLib/ThreadPool.hpp"
+
+namespace {
+    /// Row-major m x n product computed in double.
+    std::vector<float> naive(std::size_t const m, std::size_t const n, std::size_t const k, const float* a, const float* b) {
+        std::vector<float> c(m * n);
+        for (std::size_t i = 0; i < m; i++) {
+            for (std::size_t j = 0; j < n; j++) {
+                double sum = 0;
+                for (std::size_t p = 0; p < k; p++) {
+                    sum += static_cast<double>(a[i * k + p]) * b[p * n + j];
+                }
+                c[i * n + j] = static_cast<float>(sum);
+            }
+        }
+        return c;
+    }
+
+    float max_difference(const std::vector<float>& a, const float* b) {
+        float res = 0;
+        for (std::size_t i = 0; i < a.size(); i++) {
+            res = std::max(res, std::abs(a[i] - b[i]));
+        }
+        return res;
+    }
+}
+
+TEST_CASE("Thread Pool", "[ThreadPool]") {
+
+    LinearLib::ThreadPool::configure({ .threads = 4 });
+
+    SECTION("Parallel For") {
+
+        std::vector<std::atomic<int>> visits(10000);
+        LinearLib::parallelFor(0, visits.size(), 7, [&](std::size_t const lo, std::size_t const hi) {
+            for (std::size_t i = lo; i < hi; i++) {
+                visits[i]++;
+            }
+        });
+
+        REQUIRE(std::all_of(visits.begin(), visits.end(), [](const std::atomic<int>& v) { return v == 1; }));
+
+        REQUIRE_THROWS_AS(LinearLib::parallelFor(0, 100, 1, [](std::size_t const lo, std::size_t) {
+            if (lo == 50) {
+                throw std::runtime_error("chunk");
+            }
+        }), std::runtime_error);
+    }
+
+    SECTION("Concurrent Callers") {
+
+        // Two external threads share the pool, one running parallel products and the other many serial products
+        // as parallel tasks, whose packing must not disturb the first's packed panels
+        constexpr std::size_t n = 200;
+        constexpr std::size_t small = 64;
+        constexpr std::size_t batch = 32;
+
+        const LinearLib::Tensor<float> a = LinearLib::Tensor<float>::random({ n, n }, -1, 1, 1);
+        const LinearLib::Tensor<float> b = LinearLib::Tensor<float>::random({ n, n }, -1, 1, 2);
+        const LinearLib::Tensor<float> sa = LinearLib::Tensor<float>::random({ batch, small, small }, -1, 1, 3);
+        const LinearLib::Tensor<float> sb = LinearLib::Tensor<float>::random({ batch, small, small }, -1, 1, 4);
+
+        const std::vector<float> expected = naive(n, n, n, a.data(), b.data());
+        std::vector<std::vector<float>> expected_small;
+        for (std::size_t i = 0; i < batch; i++) {
+            expected_small.push_back(naive(small, small, small, sa.data() + i * small * small, sb.data() + i * small * small));
+        }
+
+        float large_error = 0;
+        float small_error = 0;
+
+        std::thread large([&] {
+            std::vector<float> c(n * n);
+            for (int round = 0; round < 20; round++) {
+                LinearLib::gemm(n, n, n, a.data(), b.data(), c.data());
+                large_error = std::max(large_error, max_difference(expected, c.data()));
+            }
+        });
+
+        std::thread many([&] {
+            std::vector<float> c(batch * small * small);
+            for (int round = 0; round < 50; round++) {
+                LinearLib::parallelFor(0, batch, 1, [&](std::size_t const lo, std::size_t const hi) {
+                    for (std::size_t i = lo; i < hi; i++) {
+                        const std::size_t offset = i * small * small;
+                        LinearLib::gemm(small, small, small, sa.data() + offset, sb.data() + offset, c.data() + offset);
+                    }
+                });
+                for (std::size_t i = 0; i < batch; i++) {
+                    small_error = std::max(small_error, max_difference(expected_small[i], c.data() + i * small * small));
+                }
+            }
+        });
+
+        large.join();
+        many.join();
+
+        REQUIRE(large_error < 1e-4f);
+        REQUIRE(small_error < 1e-4f);
+    }
+
+    LinearLib::ThreadPool::configure({});
+}
@@ -13,4 +13,153 @@ TEST_CASE("Tokenizer", "[Tokenizer]") {
 
         REQUIRE(tokens2.size() == 13);
     }
-}
\ No newline at end of file
+
+    SECTION("Normalize") {
+
+        const std::vector<std::string> raw = { "Hello, world", "an incomprehensibly long sentence" };
+
+        const auto linked = normalize(raw, true);
+        const auto symbols = normalize<Symbols>(raw, true);
+
+        REQUIRE(linked.size() == symbols.size());
+        for (std::size_t i = 0; i < linked.size(); i++) {
+            REQUIRE(linked[i].size() == symbols[i].size());
+            for (std::size_t j = 0; j < linked[i].size(); j++) {
+                std::vector<int> letters;
+                for (const int letter : linked[i][j]) {
+                    letters.push_back(letter);
+                }
+                REQUIRE(std::ranges::equal(letters, symbols[i][j]));
+            }
+        }
+
+        Dast::Arena arena;
+        const auto pooled = normalize(raw, true, arena);
+
+        REQUIRE(pooled.size() == linked.size());
+        REQUIRE(pooled[1][1].size() == linked[1][1].size());
+        REQUIRE(arena.capacity() > 0);
+
+        REQUIRE(symbols[0][1] == Symbols{ ',' });
+        REQUIRE_FALSE(symbols[1][0].on_heap());
+        REQUIRE(symbols[1][1].on_heap());
+    }
+
+    SECTION("Byte Pair Training Controls") {
+
+        const std::vector<std::string> raw = { "low lower lowest", "new newer newest", "wider" };
+
+        // Frequent pairs only, the vocabulary is left short once every remaining pair is a singleton
+        const std::set<std::string> tokens = BytePairTokenizer::tokenize(raw, { .n_vocab = 100, .min_frequency = 2 });
+
+        REQUIRE(tokens.size() < 100);
+        REQUIRE(tokens.contains("<pad>"));
+        REQUIRE(tokens.contains("<unk>"));
+        REQUIRE(tokens.contains("we"));
+        REQUIRE_FALSE(tokens.contains("wi"));
+
+        const std::set<std::string> short_tokens = BytePairTokenizer::tokenize(raw, {
+            .n_vocab = 100, .min_frequency = 1, .special_tokens = {}, .max_token_length = 2
+        });
+
+        REQUIRE(std::ranges::all_of(short_tokens, [](const std::string& token) { return token.size() <= 2; }));
+
+        const std::set<std::string> limited = BytePairTokenizer::tokenize(raw, {
+            .n_vocab = 4, .min_frequency = 1, .special_tokens = {}, .limit_alphabet = 4
+        });
+
+        REQUIRE(limited == std::set<std::string>{ "e", "l", "n", "w" });
+    }
+
+    SECTION("Byte Pair Corpora") {
+
+        const std::vector<std::string> en = { "the house is small", "the tree is tall" };
+        const std::vector<std::string> de = { "das haus ist klein", "der baum ist hoch" };
+
+        const WordCounts counts({ en, de }, true);
+
+        REQUIRE(counts.corpora() == 2);
+
+        const BytePairConfig config = { .n_vocab = 40, .min_frequency = 1, .special_tokens = {} };
+
+        const std::set<std::string> joint = BytePairTokenizer::train(counts, std::array{ 1.0, 1.0 }, config);
+        const std::set<std::string> source = BytePairTokenizer::train(counts, std::array{ 1.0, 0.0 }, config);
+        const std::set<std::string> target = BytePairTokenizer::train(counts, std::array{ 0.0, 1.0 }, config);
+
+        REQUIRE(joint == BytePairTokenizer::tokenize(std::array<Corpus, 2>{ en, de }, std::array{ 1.0, 1.0 }, config));
+        REQUIRE(source == BytePairTokenizer::tokenize(en, config));
+        REQUIRE(target == BytePairTokenizer::tokenize(de, config));
+
+        REQUIRE(joint.contains("k"));
+        REQUIRE(target.contains("k"));
+        REQUIRE_FALSE(source.contains("k"));
+
+        REQUIRE_THROWS_AS(BytePairTokenizer::train(counts, std::array{ 1.0 }, config), std::invalid_argument);
+        REQUIRE_THROWS_AS(BytePairTokenizer::train(counts, std::array{ 1.0, 1.0 }, { .min_frequency = 0 }),
+                          std::invalid_argument);
+
+        // Fractional weights only scale the frequencies, so training with exactly representable ones matches the
+        // integral weights it is a multiple of
+        REQUIRE(BytePairTokenizer::train(counts, std::array{ 0.5, 0.25 }, { .n_vocab = 40, .min_frequency = 1, .special_tokens = {} }) ==
+                BytePairTokenizer::train(counts, std::array{ 2.0, 1.0 }, { .n_vocab = 40, .min_frequency = 4, .special_tokens = {} }));
+
+        // Merging until no pair is left turns every word into a token, and no token is emitted that does not occur
+        // however the weights round
+        const std::set<std::string> exhausted = BytePairTokenizer::train(counts, std::array{ 0.1, 0.2 }, {
+            .n_vocab = 1000, .min_frequency = 1, .special_tokens = {}
+        });
+        const std::set<std::string> scaled = BytePairTokenizer::train(counts, std::array{ 10.1, 20.2 }, {
+            .n_vocab = 1000, .min_frequency = 1, .special_tokens = {}
+        });
+
+        for (std::size_t i = 0; i < counts.size(); i++) {
+            REQUIRE(scaled.contains(counts.word(i)));
+        }
+        for (const std::set<std::string>& tokens : { exhausted, scaled }) {
+            for (const std::string& token : tokens) {
+                REQUIRE(std::ranges::any_of(std::views::iota(std::size_t{0}, counts.size()), [&](std::size_t const i) {
+                    return counts.word(i).find(token) != std::string::npos;
+                }));
+            }
+        }
+    }
+
+    SECTION("WordPiece") {
+
+        const WordPieceTokenizer tokenizer({ "a", "abcdx", "##b", "##c", "##cdy", "##dz", "[UNK]" });
+
+        std::vector<int> ids;
+        tokenizer.encode_word("abcdz", ids);
+
+        REQUIRE(ids == std::vector{
+            tokenizer.id("a").value(), tokenizer.id("##b").value(), tokenizer.id("##c").value(), tokenizer.id("##dz").value()
+        });
+
+        REQUIRE(tokenizer.encode("abcdx abq") == std::vector{ tokenizer.id("abcdx").value(), tokenizer.unknown() });
+
+        const std::set<std::string> vocab = WordPieceTokenizer().tokenize({ "This is a test." }, 16, true);
+
+        REQUIRE(vocab.size() == 16);
+
+        const WordPieceTokenizer trained(vocab);
+
+        std::string decoded;
+        for (const int id : trained.encode("This is a test.")) {
+            REQUIRE(id != trained.unknown());
+            const std::string& token = trained.token(id);
+            decoded += token.starts_with(WordPieceTokenizer::suffix_indicator) ? token.substr(2) : " " + token;
+        }
+
+        REQUIRE(decoded == " this is a test .");
+    }
+
+    SECTION("WordPiece Untrained") {
+
+        const WordPieceTokenizer tokenizer;
+
+        REQUIRE(tokenizer.size() == 1);
+        REQUIRE(tokenizer.token(tokenizer.unknown()) == "[UNK]");
+        REQUIRE(tokenizer.encode("").empty());
+        REQUIRE(tokenizer.encode("abc ## d.") == std::vector(5, tokenizer.unknown()));
+    }
+}
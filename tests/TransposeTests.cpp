@@ -0,0 +1,68 @@
+#include "catch2/catch_amalgamated.hpp"
+#include "LinearLib/Transpose.hpp"
+
+#include <vector>
+
+namespace {
+    /// Transposes a rows x cols matrix between padded buffers and checks every element, and that the padding of the
+    /// output is left alone.
+    template<typename T>
+    void check(std::size_t const rows, std::size_t const cols) {
+        const std::size_t ldi = cols + 3;
+        const std::size_t ldo = rows + 5;
+        const T sentinel = T{-1};
+
+        std::vector<T> in(rows * ldi);
+        for (std::size_t i = 0; i < in.size(); i++) {
+            in[i] = static_cast<T>(i);
+        }
+        std::vector<T> out(cols * ldo, sentinel);
+
+        LinearLib::transpose(rows, cols, in.data(), ldi, out.data(), ldo);
+
+        INFO("rows " << rows << " cols " << cols);
+        for (std::size_t j = 0; j < cols; j++) {
+            for (std::size_t i = 0; i < rows; i++) {
+                REQUIRE(out[j * ldo + i] == in[i * ldi + j]);
+            }
+            for (std::size_t i = rows; i < ldo; i++) {
+                REQUIRE(out[j * ldo + i] == sentinel);
+            }
+        }
+    }
+}
+
+TEST_CASE("Transpose", "[Transpose]") {
+
+    // Sizes around the 8 x 8 register blocks and the 32 x 32 tiles, so full blocks, edge columns, edge rows and edge
+    // tiles all occur
+    const std::size_t sizes[] = { 1, 3, 7, 8, 9, 16, 31, 32, 33, 41, 64, 70 };
+
+    SECTION("Float") {
+
+        // Float goes through the AVX 8 x 8 kernel when the compiler targets it
+        for (const std::size_t rows : sizes) {
+            for (const std::size_t cols : sizes) {
+                check<float>(rows, cols);
+            }
+        }
+    }
+
+    SECTION("Other Types") {
+
+        for (const std::size_t rows : sizes) {
+            for (const std::size_t cols : sizes) {
+                check<double>(rows, cols);
+                check<int>(rows, cols);
+            }
+        }
+    }
+
+    SECTION("Empty") {
+
+        std::vector<float> out(4, 1.0f);
+        LinearLib::transpose<float>(0, 4, nullptr, 4, out.data(), 1);
+        LinearLib::transpose<float>(4, 0, nullptr, 0, out.data(), 4);
+        REQUIRE(out == std::vector<float>(4, 1.0f));
+    }
+}
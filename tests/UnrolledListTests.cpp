@@ -0,0 +1,244 @@
+#include "catch2/catch_amalgamated.hpp"
+#include "Dast/collections/UnrolledList.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    /// Allocator counting the nodes it has live. Allocators are equal when they share a counter.
+    template<typename T>
+    struct CountingAllocator {
+        using value_type = T;
+
+        long* live;
+
+        explicit CountingAllocator(long& live) : live(&live) {}
+
+        template<typename U>
+        explicit(false) CountingAllocator(const CountingAllocator<U>& other) : live(other.live) {}
+
+        T* allocate(std::size_t const n) {
+            *live += static_cast<long>(n);
+            return std::allocator<T>().allocate(n);
+        }
+
+        void deallocate(T* ptr, std::size_t const n) {
+            *live -= static_cast<long>(n);
+            std::allocator<T>().deallocate(ptr, n);
+        }
+
+        template<typename U>
+        bool operator==(const CountingAllocator<U>& other) const {
+            return live == other.live;
+        }
+    };
+
+    template<typename T, std::size_t N, typename A>
+    std::vector<T> contents(const Dast::UnrolledList<T, N, A>& list) {
+        std::vector<T> res;
+        for (auto it = list.begin(); it != list.end(); ++it) {
+            res.push_back(*it);
+        }
+        return res;
+    }
+
+    /// Random operations against a vector, checking the whole list after each one.
+    template<std::size_t N>
+    void check_against_vector(std::size_t const seed) {
+        long live = 0;
+        Dast::UnrolledList<int, N, CountingAllocator<int>> list{ CountingAllocator<int>(live) };
+        std::vector<int> model;
+
+        std::mt19937 rng(static_cast<unsigned>(seed));
+        for (int step = 0; step < 2000; step++) {
+            const auto pick = [&](std::size_t const n) { return std::uniform_int_distribution<std::size_t>(0, n - 1)(rng); };
+            const std::size_t op = model.empty() ? pick(2) : pick(6);
+
+            switch (op) {
+                case 0:
+                    list.push_back(step);
+                    model.push_back(step);
+                    break;
+                case 1:
+                    list.push_front(step);
+                    model.insert(model.begin(), step);
+                    break;
+                case 2:
+                case 3: {
+                    const std::size_t index = pick(model.size());
+                    list.insert(index, step);
+                    model.insert(model.begin() + static_cast<std::ptrdiff_t>(index) + 1, step);
+                    break;
+                }
+                case 4: {
+                    const std::size_t index = pick(model.size());
+                    list.remove(index);
+                    model.erase(model.begin() + static_cast<std::ptrdiff_t>(index));
+                    break;
+                }
+                default:
+                    list.pop_front();
+                    model.erase(model.begin());
+                    break;
+            }
+
+            REQUIRE(list.size() == model.size());
+            REQUIRE(contents(list) == model);
+            if (!model.empty()) {
+                REQUIRE(list.get_head() == model.front());
+                REQUIRE(list.get_tail() == model.back());
+                REQUIRE(list.at(model.size() / 2) == model[model.size() / 2]);
+            }
+
+            // Every node holds at least one element
+            REQUIRE(live <= static_cast<long>(model.size()));
+        }
+
+        list.clear();
+        REQUIRE(live == 0);
+    }
+}
+
+TEST_CASE("Unrolled List", "[UnrolledList]") {
+
+    SECTION("Against Vector") {
+
+        check_against_vector<1>(1);
+        check_against_vector<2>(2);
+        check_against_vector<4>(3);
+        check_against_vector<7>(4);
+    }
+
+    SECTION("Insert Across Nodes") {
+
+        long live = 0;
+        Dast::UnrolledList<int, 4, CountingAllocator<int>> list({ 0, 1, 2, 3, 4, 5, 6, 7 }, CountingAllocator<int>(live));
+        REQUIRE(live == 2);
+
+        // After the last element of a full node: the node splits and the item ends its lower half
+        list.insert(3, 100);
+        REQUIRE(live == 3);
+        REQUIRE(contents(list) == std::vector<int>{ 0, 1, 2, 3, 100, 4, 5, 6, 7 });
+
+        // Into the upper half of a full node
+        list.insert(7, 200);
+        REQUIRE(live == 4);
+        REQUIRE(contents(list) == std::vector<int>{ 0, 1, 2, 3, 100, 4, 5, 6, 200, 7 });
+
+        // The lower halves have room left, no further split
+        list.insert(0, 300);
+        REQUIRE(live == 4);
+        REQUIRE(list.get_tail() == 7);
+
+        list.push_back(8);
+        REQUIRE(list.get_tail() == 8);
+        REQUIRE(list.size() == 12);
+
+        REQUIRE_THROWS_AS(list.insert(12, 0), std::out_of_range);
+        REQUIRE_THROWS_AS(list.at(12), std::out_of_range);
+    }
+
+    SECTION("Merge Below Half Capacity") {
+
+        long live = 0;
+        Dast::UnrolledList<int, 8, CountingAllocator<int>> list{ CountingAllocator<int>(live) };
+        for (int i = 0; i < 16; i++) {
+            list.push_back(i);
+        }
+        REQUIRE(live == 2);
+
+        // Shrinking the last node never merges, it has no successor
+        for (int i = 0; i < 6; i++) {
+            list.remove(8);
+        }
+        REQUIRE(live == 2);
+        REQUIRE(contents(list) == std::vector<int>{ 0, 1, 2, 3, 4, 5, 6, 7, 14, 15 });
+
+        // The first node merges with its successor once both fit in half a node, 2 + 2 <= 4
+        for (int i = 0; i < 5; i++) {
+            list.remove(0);
+            REQUIRE(live == 2);
+        }
+        list.remove(0);
+        REQUIRE(live == 1);
+        REQUIRE(contents(list) == std::vector<int>{ 6, 7, 14, 15 });
+
+        // The merged node is the tail now
+        list.push_back(16);
+        REQUIRE(list.get_tail() == 16);
+        REQUIRE(live == 1);
+
+        // Emptying a node unlinks it
+        while (!list.empty()) {
+            list.pop_front();
+        }
+        REQUIRE(live == 0);
+        list.push_front(1);
+        REQUIRE(list.get_head() == 1);
+        REQUIRE(list.get_tail() == 1);
+    }
+
+    SECTION("Copy, Move And Append") {
+
+        long live = 0;
+        long other_live = 0;
+        using List = Dast::UnrolledList<std::string, 3, CountingAllocator<std::string>>;
+
+        List a({ "a", "b", "c", "d" }, CountingAllocator<std::string>(live));
+        const List copy = a;
+        REQUIRE(contents(copy) == contents(a));
+        REQUIRE(live == 4);
+
+        // Equal allocators hand over the nodes themselves
+        List b({ "e", "f" }, CountingAllocator<std::string>(live));
+        a.append(std::move(b));
+        REQUIRE(b.empty());
+        REQUIRE(live == 5);
+        REQUIRE(contents(a) == std::vector<std::string>{ "a", "b", "c", "d", "e", "f" });
+        REQUIRE(a.get_tail() == "f");
+
+        // Unequal allocators move the elements into nodes of this list
+        List c({ "g", "h", "i", "j" }, CountingAllocator<std::string>(other_live));
+        a.append(std::move(c));
+        REQUIRE(c.empty());
+        REQUIRE(other_live == 0);
+        REQUIRE(contents(a).size() == 10);
+        REQUIRE(a.get_tail() == "j");
+
+        // Move assignment between unequal allocators also moves element by element
+        List d({ "x" }, CountingAllocator<std::string>(other_live));
+        d = std::move(a);
+        REQUIRE(a.empty());
+        REQUIRE(contents(d).size() == 10);
+        REQUIRE(d.contains("h"));
+        REQUIRE_FALSE(d.contains("z"));
+
+        const List moved = std::move(d);
+        REQUIRE(moved.size() == 10);
+        REQUIRE(d.empty());
+    }
+
+    SECTION("Arena") {
+
+        Dast::Arena arena;
+        using Allocator = Dast::ArenaAllocator<int>;
+
+        Dast::UnrolledList<int, 4, Allocator> a{ Allocator(arena) };
+        Dast::UnrolledList<int, 4, Allocator> b{ Allocator(arena) };
+        for (int i = 0; i < 10; i++) {
+            a.push_back(i);
+            b.push_front(i);
+        }
+
+        a.append(std::move(b));
+        REQUIRE(a.size() == 20);
+        REQUIRE(a.at(10) == 9);
+        REQUIRE(a.get_tail() == 0);
+
+        a.clear();
+        REQUIRE(a.empty());
+        a.push_back(5);
+        REQUIRE(a.get_head() == 5);
+    }
+}
@@ -0,0 +1,215 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Dast {
+    /// Doubly linked list whose elements and links live together in one contiguous vector, linked by index rather than
+    /// by pointer. Elements are appended in runs (e.g. one per word) that are never linked to each other, and are
+    /// addressed by stable handles. Erasing unlinks an element from its neighbours in constant time but leaves its slot
+    /// in place, so handles and iterators to every other element stay valid.
+    template<typename T>
+    class IndexList {
+    public:
+        using Handle = std::uint32_t;
+
+        /// Handle past either end of a run.
+        static constexpr Handle npos = std::numeric_limits<Handle>::max();
+
+        IndexList() = default;
+
+        void reserve(const std::size_t capacity) {
+            slots.reserve(capacity);
+        }
+
+        /// Appends an element to the current run.
+        /// @return Handle of the element
+        Handle push_back(T value) {
+            return emplace_back(std::move(value));
+        }
+
+        template<typename... Args>
+        Handle emplace_back(Args&&... args) {
+            if (slots.size() >= npos) {
+                throw std::length_error("Index list is full");
+            }
+
+            const auto handle = static_cast<Handle>(slots.size());
+
+            slots.push_back(Slot{T(std::forward<Args>(args)...), tail, npos, true});
+            if (tail != npos) {
+                slots[tail].next = handle;
+            }
+
+            tail = handle;
+            count++;
+            return handle;
+        }
+
+        /// Ends the current run, the next element appended starts a new one.
+        void cut() {
+            tail = npos;
+        }
+
+        /// Unlinks an element, joining its neighbours.
+        void erase(const Handle handle) {
+            Slot& slot = slots[handle];
+            if (!slot.alive) {
+                return;
+            }
+
+            if (slot.prev != npos) {
+                slots[slot.prev].next = slot.next;
+            }
+            if (slot.next != npos) {
+                slots[slot.next].prev = slot.prev;
+            }
+
+            if (handle == tail) {
+                tail = slot.prev;
+            }
+
+            slot.alive = false;
+            count--;
+        }
+
+        /// @return Handle of the following element in the run, npos at its end
+        [[nodiscard]] Handle next(const Handle handle) const {
+            return slots[handle].next;
+        }
+
+        /// @return Handle of the preceding element in the run, npos at its start
+        [[nodiscard]] Handle prev(const Handle handle) const {
+            return slots[handle].prev;
+        }
+
+        [[nodiscard]] bool alive(const Handle handle) const {
+            return handle < slots.size() && slots[handle].alive;
+        }
+
+        T& operator[](const Handle handle) {
+            return slots[handle].value;
+        }
+
+        const T& operator[](const Handle handle) const {
+            return slots[handle].value;
+        }
+
+        T& at(const Handle handle) {
+            if (!alive(handle)) {
+                throw std::out_of_range("Handle does not refer to an element");
+            }
+            return slots[handle].value;
+        }
+
+        /// @return Number of live elements
+        [[nodiscard]] std::size_t size() const {
+            return count;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return count == 0;
+        }
+
+        /// @return Number of slots handed out, including erased ones
+        [[nodiscard]] std::size_t slot_count() const {
+            return slots.size();
+        }
+
+        void clear() {
+            slots.clear();
+            tail = npos;
+            count = 0;
+        }
+
+        /// Visits live elements in the order they were appended, skipping erased slots.
+        template<bool Const>
+        struct BasicIterator {
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using reference = std::conditional_t<Const, const T&, T&>;
+            using pointer = std::conditional_t<Const, const T*, T*>;
+
+            using List = std::conditional_t<Const, const IndexList, IndexList>;
+
+            List* list = nullptr;
+            Handle handle = 0;
+
+            BasicIterator() = default;
+
+            BasicIterator(List* list, const Handle handle) : list(list), handle(handle) {
+                skip();
+            }
+
+            BasicIterator& operator++() {
+                handle++;
+                skip();
+                return *this;
+            }
+
+            BasicIterator operator++(int) {
+                BasicIterator iterator = *this;
+                ++*this;
+                return iterator;
+            }
+
+            bool operator==(const BasicIterator& other) const {
+                return handle == other.handle;
+            }
+
+            reference operator*() const {
+                return list->slots[handle].value;
+            }
+
+            pointer operator->() const {
+                return &list->slots[handle].value;
+            }
+
+        private:
+            void skip() {
+                while (handle < list->slots.size() && !list->slots[handle].alive) {
+                    handle++;
+                }
+            }
+        };
+
+        using Iterator = BasicIterator<false>;
+        using ConstIterator = BasicIterator<true>;
+
+        Iterator begin() {
+            return Iterator(this, 0);
+        }
+
+        ConstIterator begin() const {
+            return ConstIterator(this, 0);
+        }
+
+        Iterator end() {
+            return Iterator(this, static_cast<Handle>(slots.size()));
+        }
+
+        ConstIterator end() const {
+            return ConstIterator(this, static_cast<Handle>(slots.size()));
+        }
+
+    private:
+        struct Slot {
+            T value;
+            Handle prev;
+            Handle next;
+            bool alive;
+        };
+
+        std::vector<Slot> slots;
+        std::size_t count = 0;
+
+        // Last element of the current run, the next one appended links to it
+        Handle tail = npos;
+    };
+}
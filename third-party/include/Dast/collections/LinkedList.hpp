@@ -1,5 +1,12 @@
 #pragma once
+#include <initializer_list>
+#include <iterator>
+#include <memory>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Dast/memory/Arena.hpp"
 
 namespace Dast {
     template<typename T>
@@ -15,6 +22,9 @@ namespace Dast {
 
         Node() : data(), next(nullptr) {}
 
+        template<typename... Args>
+        explicit Node(std::in_place_t, Args&&... args) : data(std::forward<Args>(args)...), next(nullptr) {}
+
         bool operator==(const Node& other) const {
             return data == other.data && next == other.next;
         }
@@ -24,50 +34,83 @@ namespace Dast {
         }
     };
 
-    template<typename T>
+    /// Singly linked list, nodes are obtained through the allocator so they can be drawn from an arena. The tail and the
+    /// size are tracked so appending and counting take constant time.
+    template<typename T, typename Allocator = std::allocator<T>>
     class LinkedList {
+        using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node<T>>;
+        using NodeTraits = std::allocator_traits<NodeAllocator>;
+
     public:
+        using allocator_type = Allocator;
+
         LinkedList() : head(nullptr) {}
 
-        LinkedList(std::initializer_list<T> init) {
+        explicit LinkedList(const Allocator& alloc) : head(nullptr), alloc(alloc) {}
+
+        LinkedList(std::initializer_list<T> init, const Allocator& alloc = Allocator()) : alloc(alloc) {
             for (auto it = std::rbegin(init); it != std::rend(init); ++it) {
                 push_front(*it);
             }
         }
 
-        LinkedList(const LinkedList& other) {
-            Node<T>** curr = &head;
-            for (Node<T>* node = other.head; node != nullptr; node = node->next) {
-                *curr = new Node<T>(node->data);
-                curr = &(*curr)->next;
-            }
+        LinkedList(const LinkedList& other)
+            : alloc(NodeTraits::select_on_container_copy_construction(other.alloc)) {
+            copy_from(other);
         }
 
         LinkedList& operator=(const LinkedList& other) {
             if (this != &other) {
                 clear();
-                Node<T>** curr = &head;
-                for (Node<T>* node = other.head; node != nullptr; node = node->next) {
-                    *curr = new Node<T>(node->data);
-                    curr = &(*curr)->next;
+                if constexpr (NodeTraits::propagate_on_container_copy_assignment::value) {
+                    alloc = other.alloc;
                 }
+                copy_from(other);
             }
             return *this;
         }
 
-        LinkedList(LinkedList&& other) noexcept : head(other.head) {
-            other.head = nullptr;
-        }
+        LinkedList(LinkedList&& other) noexcept
+            : head(std::exchange(other.head, nullptr)), tail(std::exchange(other.tail, nullptr)),
+              count(std::exchange(other.count, 0)), alloc(std::move(other.alloc)) {}
 
-        LinkedList& operator=(LinkedList&& other) noexcept {
+        LinkedList& operator=(LinkedList&& other) noexcept(NodeTraits::propagate_on_container_move_assignment::value ||
+                                                           NodeTraits::is_always_equal::value) {
             if (this != &other) {
                 clear();
-                head = other.head;
-                other.head = nullptr;
+                if constexpr (NodeTraits::propagate_on_container_move_assignment::value) {
+                    alloc = std::move(other.alloc);
+                } else if (alloc != other.alloc) {
+                    // Nodes cannot change hands between unequal allocators, move the elements instead
+                    for (Node<T>* node = other.head; node != nullptr; node = node->next) {
+                        push_back(std::move(node->data));
+                    }
+                    other.clear();
+                    return *this;
+                }
+                head = std::exchange(other.head, nullptr);
+                tail = std::exchange(other.tail, nullptr);
+                count = std::exchange(other.count, 0);
             }
             return *this;
         }
 
+        /// Exchanges the nodes with another list, and the allocators when they propagate on swap. Otherwise the
+        /// allocators must be equal.
+        void swap(LinkedList& other) noexcept {
+            using std::swap;
+            if constexpr (NodeTraits::propagate_on_container_swap::value) {
+                swap(alloc, other.alloc);
+            }
+            swap(head, other.head);
+            swap(tail, other.tail);
+            swap(count, other.count);
+        }
+
+        friend void swap(LinkedList& a, LinkedList& b) noexcept {
+            a.swap(b);
+        }
+
         struct Iterator {
 
             Node<T>* curr;
@@ -128,16 +171,16 @@ namespace Dast {
             return head;
         }
 
+        [[nodiscard]] Allocator get_allocator() const {
+            return Allocator(alloc);
+        }
+
         T get_head() {
             return head->data;
         }
 
         T get_tail() {
-            Node<T>* curr = head;
-            while (curr->next != nullptr) {
-                curr = curr->next;
-            }
-            return curr->data;
+            return tail->data;
         }
 
         T operator[](const size_t index) {
@@ -175,82 +218,141 @@ namespace Dast {
                 }
                 curr = curr->next;
             }
-            curr->next = new Node<T>(item, curr->next);
+            curr->next = create(std::move(item), curr->next);
+            if (curr == tail) {
+                tail = curr->next;
+            }
+            count++;
         }
 
-        size_t size() {
-            Node<T>* curr = head;
-            size_t size = 0;
-            while (curr != nullptr) {
-                curr = curr->next;
-                size++;
-            }
-            return size;
+        size_t size() const {
+            return count;
         }
 
-        bool empty() {
+        bool empty() const {
             return head == nullptr;
         }
 
         void push_front(T item) {
-            head = new Node<T>(item, head);
+            emplace_front(std::move(item));
         }
 
-
         void push_back(T item) {
+            emplace_back(std::move(item));
+        }
+
+        /// Constructs an element in place at the back.
+        /// @return The new element
+        template<typename... Args>
+        T& emplace_back(Args&&... args) {
+            Node<T>* node = create(std::in_place, std::forward<Args>(args)...);
 
             if (head == nullptr) {
-                head = new Node<T>(item);
+                head = node;
+            } else {
+                tail->next = node;
+            }
+
+            tail = node;
+            count++;
+            return node->data;
+        }
+
+        /// Constructs an element in place at the front.
+        /// @return The new element
+        template<typename... Args>
+        T& emplace_front(Args&&... args) {
+            Node<T>* node = create(std::in_place, std::forward<Args>(args)...);
+            node->next = head;
+            head = node;
+            if (tail == nullptr) {
+                tail = head;
+            }
+            count++;
+            return node->data;
+        }
+
+        /// Moves every node of another list to the back of this one, in constant time when the allocators are equal.
+        /// @param other List left empty.
+        void append(LinkedList&& other) {
+            if (this == &other || other.head == nullptr) {
                 return;
             }
 
-            Node<T>* curr = head;
+            if (!NodeTraits::is_always_equal::value && alloc != other.alloc) {
+                for (Node<T>* node = other.head; node != nullptr; node = node->next) {
+                    push_back(std::move(node->data));
+                }
+                other.clear();
+                return;
+            }
 
-            while (curr->next != nullptr) {
-                curr = curr->next;
+            if (head == nullptr) {
+                head = other.head;
+            } else {
+                tail->next = other.head;
             }
 
-            curr->next = new Node<T>(item);
+            tail = std::exchange(other.tail, nullptr);
+            count += std::exchange(other.count, 0);
+            other.head = nullptr;
         }
 
         void pop_front() {
             if (head != nullptr) {
                 Node<T>* temp = head;
                 head = head->next;
-                delete temp;
+                destroy(temp);
+
+                if (head == nullptr) {
+                    tail = nullptr;
+                }
+                count--;
             }
         }
 
         void remove(const size_t index) {
-            Node<T>* curr = head;
-
-            if (this->size() == 0 || index >= this->size()) {
+            if (index >= count) {
                 throw std::out_of_range("Index out of range");
             }
 
             // Delete the head
             if (index == 0) {
-                Node<T>* next = curr->next;
-                delete curr;
-                head = next;
+                pop_front();
                 return;
             }
 
+            Node<T>* curr = head;
             for (size_t i = 0; i < index - 1; i++) {
-                if (curr->next == nullptr) {
-                    throw std::out_of_range("Index out of range");
-                }
                 curr = curr->next;
             }
 
-            Node<T>* next = curr->next;
-            curr->next = next->next;
-            delete next;
+            erase_after(curr);
         }
 
+        /// Removes the node following the given one.
+        /// @param node Node of this list with a successor.
+        void erase_after(Node<T>* node) {
+            Node<T>* next = node->next;
+            node->next = next->next;
+            if (next == tail) {
+                tail = node;
+            }
+            destroy(next);
+            count--;
+        }
+
+        /// Removes every element, nodes drawn from a bulk allocator are dropped without being visited since their owner
+        /// reclaims them all at once.
         void clear() {
-            while (head != nullptr) {
-                pop_front();
+            if constexpr (is_bulk_allocator_v<NodeAllocator> && std::is_trivially_destructible_v<T>) {
+                head = nullptr;
+                tail = nullptr;
+                count = 0;
+            } else {
+                while (head != nullptr) {
+                    pop_front();
+                }
             }
         }
 
@@ -260,5 +362,31 @@ namespace Dast {
 
     private:
         Node<T>* head = nullptr;
+        Node<T>* tail = nullptr;
+        size_t count = 0;
+        [[no_unique_address]] NodeAllocator alloc;
+
+        template<typename... Args>
+        Node<T>* create(Args&&... args) {
+            Node<T>* node = NodeTraits::allocate(alloc, 1);
+            try {
+                NodeTraits::construct(alloc, node, std::forward<Args>(args)...);
+            } catch (...) {
+                NodeTraits::deallocate(alloc, node, 1);
+                throw;
+            }
+            return node;
+        }
+
+        void destroy(Node<T>* node) {
+            NodeTraits::destroy(alloc, node);
+            NodeTraits::deallocate(alloc, node, 1);
+        }
+
+        void copy_from(const LinkedList& other) {
+            for (Node<T>* node = other.head; node != nullptr; node = node->next) {
+                push_back(node->data);
+            }
+        }
     };
 }
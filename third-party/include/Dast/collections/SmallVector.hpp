@@ -0,0 +1,270 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace Dast {
+    /// Vector keeping up to N elements inline and only spilling to the heap beyond that. The inline elements share
+    /// their storage with the heap pointer and a 32 bit length marks which one is in use, so e.g. SmallVector<int, 15>
+    /// takes 64 bytes. The pointer is copied in and out of the buffer so it adds no alignment of its own.
+    template<typename T, std::size_t N>
+    requires (N > 0)
+    class SmallVector {
+    public:
+        using value_type = T;
+        using size_type = std::uint32_t;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        SmallVector() = default;
+
+        SmallVector(std::initializer_list<T> init) {
+            reserve(init.size());
+            for (const T& item : init) {
+                push_back(item);
+            }
+        }
+
+        SmallVector(const SmallVector& other) {
+            reserve(other.size());
+            std::uninitialized_copy(other.begin(), other.end(), data());
+            set_size(other.size());
+        }
+
+        SmallVector& operator=(const SmallVector& other) {
+            if (this != &other) {
+                clear();
+                reserve(other.size());
+                std::uninitialized_copy(other.begin(), other.end(), data());
+                set_size(other.size());
+            }
+            return *this;
+        }
+
+        SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+            take(std::move(other));
+        }
+
+        SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+            if (this != &other) {
+                clear();
+                release();
+                take(std::move(other));
+            }
+            return *this;
+        }
+
+        ~SmallVector() {
+            clear();
+            release();
+        }
+
+        T* data() {
+            return on_heap() ? get_heap().ptr : inline_items();
+        }
+
+        const T* data() const {
+            return on_heap() ? get_heap().ptr : inline_items();
+        }
+
+        iterator begin() {
+            return data();
+        }
+
+        const_iterator begin() const {
+            return data();
+        }
+
+        iterator end() {
+            return data() + size();
+        }
+
+        const_iterator end() const {
+            return data() + size();
+        }
+
+        [[nodiscard]] size_type size() const {
+            return length & ~heap_flag;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return size() == 0;
+        }
+
+        [[nodiscard]] size_type capacity() const {
+            return on_heap() ? get_heap().capacity : static_cast<size_type>(N);
+        }
+
+        /// @return Whether the elements spilled to the heap
+        [[nodiscard]] bool on_heap() const {
+            return (length & heap_flag) != 0;
+        }
+
+        T& operator[](const std::size_t index) {
+            return data()[index];
+        }
+
+        const T& operator[](const std::size_t index) const {
+            return data()[index];
+        }
+
+        T& at(const std::size_t index) {
+            if (index >= size()) {
+                throw std::out_of_range("Index out of range");
+            }
+            return data()[index];
+        }
+
+        const T& at(const std::size_t index) const {
+            if (index >= size()) {
+                throw std::out_of_range("Index out of range");
+            }
+            return data()[index];
+        }
+
+        T& front() {
+            return data()[0];
+        }
+
+        T& back() {
+            return data()[size() - 1];
+        }
+
+        void reserve(const std::size_t capacity) {
+            if (capacity > max_size()) {
+                throw std::length_error("Small vector too large");
+            }
+            if (capacity > this->capacity()) {
+                grow(static_cast<size_type>(capacity));
+            }
+        }
+
+        void push_back(const T& item) {
+            emplace_back(item);
+        }
+
+        void push_back(T&& item) {
+            emplace_back(std::move(item));
+        }
+
+        template<typename... Args>
+        T& emplace_back(Args&&... args) {
+            const size_type count = size();
+            if (count == capacity()) {
+                // The new element may alias an existing one, so it is built before the elements move
+                T item(std::forward<Args>(args)...);
+                grow(count > max_size() / 2 ? max_size() : std::max<size_type>(2 * count, count + 1));
+                T* res = ::new (data() + count) T(std::move(item));
+                set_size(count + 1);
+                return *res;
+            }
+
+            T* res = ::new (data() + count) T(std::forward<Args>(args)...);
+            set_size(count + 1);
+            return *res;
+        }
+
+        void pop_back() {
+            std::destroy_at(data() + size() - 1);
+            set_size(size() - 1);
+        }
+
+        /// Removes the element at an index, shifting the following ones down.
+        void erase(const std::size_t index) {
+            if (index >= size()) {
+                throw std::out_of_range("Index out of range");
+            }
+            std::move(begin() + index + 1, end(), begin() + index);
+            pop_back();
+        }
+
+        void clear() {
+            std::destroy(begin(), end());
+            set_size(0);
+        }
+
+        bool operator==(const SmallVector& other) const {
+            return std::equal(begin(), end(), other.begin(), other.end());
+        }
+
+    private:
+        static constexpr size_type heap_flag = size_type{1} << 31;
+
+        struct Heap {
+            T* ptr;
+            size_type capacity;
+        };
+
+        // Inline elements, or the heap storage once spilled
+        alignas(T) std::byte buffer[std::max(N * sizeof(T), sizeof(Heap))];
+
+        // Element count, the top bit is set once the elements live on the heap
+        size_type length = 0;
+
+        static constexpr size_type max_size() {
+            return heap_flag - 1;
+        }
+
+        T* inline_items() {
+            return std::launder(reinterpret_cast<T*>(buffer));
+        }
+
+        const T* inline_items() const {
+            return std::launder(reinterpret_cast<const T*>(buffer));
+        }
+
+        [[nodiscard]] Heap get_heap() const {
+            Heap heap;
+            std::memcpy(&heap, buffer, sizeof(Heap));
+            return heap;
+        }
+
+        void set_heap(const Heap& heap) {
+            std::memcpy(buffer, &heap, sizeof(Heap));
+        }
+
+        void set_size(const size_type count) {
+            length = (length & heap_flag) | count;
+        }
+
+        void grow(const size_type capacity) {
+            T* ptr = static_cast<T*>(::operator new(capacity * sizeof(T), std::align_val_t{alignof(T)}));
+            const size_type count = size();
+
+            std::uninitialized_move(begin(), end(), ptr);
+            std::destroy(begin(), end());
+            release();
+
+            set_heap(Heap{ptr, capacity});
+            length = count | heap_flag;
+        }
+
+        /// Frees heap storage, the elements must have been destroyed or moved out.
+        void release() {
+            if (on_heap()) {
+                ::operator delete(get_heap().ptr, std::align_val_t{alignof(T)});
+                length &= ~heap_flag;
+            }
+        }
+
+        void take(SmallVector&& other) {
+            if (other.on_heap()) {
+                set_heap(other.get_heap());
+                length = other.length;
+                other.length = 0;
+                return;
+            }
+
+            std::uninitialized_move(other.begin(), other.end(), inline_items());
+            length = other.size();
+            other.clear();
+        }
+    };
+}
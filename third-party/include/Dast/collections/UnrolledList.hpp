@@ -0,0 +1,418 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Dast/memory/Arena.hpp"
+
+namespace Dast {
+    /// Number of elements of an UnrolledList node that keeps it within two cache lines.
+    template<typename T>
+    inline constexpr std::size_t default_unrolled_capacity =
+        std::max<std::size_t>(4, (128 - sizeof(void*) - sizeof(std::size_t)) / sizeof(T));
+
+    /// Node of an UnrolledList, holding up to N elements inline.
+    template<typename T, std::size_t N>
+    struct Chunk {
+        Chunk* next = nullptr;
+        std::size_t count = 0;
+        alignas(T) std::byte storage[N * sizeof(T)];
+
+        T* items() {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+
+        const T* items() const {
+            return std::launder(reinterpret_cast<const T*>(storage));
+        }
+
+        [[nodiscard]] bool full() const {
+            return count == N;
+        }
+    };
+
+    /// Singly linked list of nodes that each hold up to N elements, so traversal touches contiguous memory while
+    /// insertion in the middle only shifts the elements of one node. Shares the interface of LinkedList.
+    template<typename T, std::size_t N = default_unrolled_capacity<T>, typename Allocator = std::allocator<T>>
+    requires (N > 0)
+    class UnrolledList {
+        using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Chunk<T, N>>;
+        using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+    public:
+        using allocator_type = Allocator;
+
+        UnrolledList() = default;
+
+        explicit UnrolledList(const Allocator& alloc) : alloc(alloc) {}
+
+        UnrolledList(std::initializer_list<T> init, const Allocator& alloc = Allocator()) : alloc(alloc) {
+            for (const T& item : init) {
+                push_back(item);
+            }
+        }
+
+        UnrolledList(const UnrolledList& other)
+            : alloc(NodeTraits::select_on_container_copy_construction(other.alloc)) {
+            copy_from(other);
+        }
+
+        UnrolledList& operator=(const UnrolledList& other) {
+            if (this != &other) {
+                clear();
+                if constexpr (NodeTraits::propagate_on_container_copy_assignment::value) {
+                    alloc = other.alloc;
+                }
+                copy_from(other);
+            }
+            return *this;
+        }
+
+        UnrolledList(UnrolledList&& other) noexcept
+            : head(std::exchange(other.head, nullptr)), tail(std::exchange(other.tail, nullptr)),
+              count(std::exchange(other.count, 0)), alloc(std::move(other.alloc)) {}
+
+        UnrolledList& operator=(UnrolledList&& other) noexcept(NodeTraits::propagate_on_container_move_assignment::value ||
+                                                               NodeTraits::is_always_equal::value) {
+            if (this != &other) {
+                clear();
+                if constexpr (NodeTraits::propagate_on_container_move_assignment::value) {
+                    alloc = std::move(other.alloc);
+                } else if (alloc != other.alloc) {
+                    // Nodes cannot change hands between unequal allocators, move the elements instead
+                    for (T& item : other) {
+                        push_back(std::move(item));
+                    }
+                    other.clear();
+                    return *this;
+                }
+                head = std::exchange(other.head, nullptr);
+                tail = std::exchange(other.tail, nullptr);
+                count = std::exchange(other.count, 0);
+            }
+            return *this;
+        }
+
+        struct Iterator {
+
+            Chunk<T, N>* chunk;
+            std::size_t index;
+
+            explicit Iterator(Chunk<T, N>* chunk, const std::size_t index = 0) noexcept : chunk(chunk), index(index) {}
+
+            Iterator& operator++() {
+                if (chunk != nullptr && ++index == chunk->count) {
+                    chunk = chunk->next;
+                    index = 0;
+                }
+                return *this;
+            }
+
+            Iterator operator++(int) {
+                Iterator iterator = *this;
+                ++*this;
+                return iterator;
+            }
+
+            bool operator==(const Iterator& other) const {
+                return chunk == other.chunk && index == other.index;
+            }
+
+            bool operator!=(const Iterator& other) const {
+                return !(*this == other);
+            }
+
+            T& operator*() {
+                if (chunk == nullptr) {
+                    throw std::runtime_error("Dereferencing end iterator");
+                }
+                return chunk->items()[index];
+            }
+        };
+
+        Iterator begin() {
+            return Iterator(head);
+        }
+
+        Iterator begin() const {
+            return Iterator(head);
+        }
+
+        Iterator end() {
+            return Iterator(nullptr);
+        }
+
+        Iterator end() const {
+            return Iterator(nullptr);
+        }
+
+        [[nodiscard]] Allocator get_allocator() const {
+            return Allocator(alloc);
+        }
+
+        T get_head() {
+            return head->items()[0];
+        }
+
+        T get_tail() {
+            return tail->items()[tail->count - 1];
+        }
+
+        T operator[](const size_t index) {
+            return at(index);
+        }
+
+        T at(const size_t index) {
+            if (index >= count) {
+                throw std::out_of_range("Index out of range");
+            }
+
+            auto [chunk, offset] = locate(index);
+            return chunk->items()[offset];
+        }
+
+        bool contains(const T item) {
+            for (Chunk<T, N>* chunk = head; chunk != nullptr; chunk = chunk->next) {
+                if (std::find(chunk->items(), chunk->items() + chunk->count, item) != chunk->items() + chunk->count) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// Inserts an item after the element at the index, as LinkedList does.
+        void insert(const size_t index, T item) {
+            if (index >= count) {
+                throw std::out_of_range("Index out of range");
+            }
+
+            // The element at the index may be the last of its node, in which case the item goes at the end of it
+            auto [chunk, offset] = locate(index);
+            offset++;
+
+            if (chunk->full()) {
+                Chunk<T, N>* half = split(chunk);
+                if (offset > chunk->count || chunk->full()) {
+                    offset -= chunk->count;
+                    chunk = half;
+                }
+            }
+
+            emplace_at(chunk, offset, std::move(item));
+            count++;
+        }
+
+        size_t size() const {
+            return count;
+        }
+
+        bool empty() const {
+            return count == 0;
+        }
+
+        void push_front(T item) {
+            if (head == nullptr || head->full()) {
+                Chunk<T, N>* chunk = create();
+                chunk->next = head;
+                head = chunk;
+                if (tail == nullptr) {
+                    tail = chunk;
+                }
+            }
+
+            emplace_at(head, 0, std::move(item));
+            count++;
+        }
+
+        void push_back(T item) {
+            if (tail == nullptr || tail->full()) {
+                Chunk<T, N>* chunk = create();
+                if (head == nullptr) {
+                    head = chunk;
+                } else {
+                    tail->next = chunk;
+                }
+                tail = chunk;
+            }
+
+            ::new (tail->items() + tail->count) T(std::move(item));
+            tail->count++;
+            count++;
+        }
+
+        /// Moves every node of another list to the back of this one, in constant time when the allocators are equal.
+        /// @param other List left empty.
+        void append(UnrolledList&& other) {
+            if (this == &other || other.head == nullptr) {
+                return;
+            }
+
+            if (!NodeTraits::is_always_equal::value && alloc != other.alloc) {
+                for (T& item : other) {
+                    push_back(std::move(item));
+                }
+                other.clear();
+                return;
+            }
+
+            if (head == nullptr) {
+                head = other.head;
+            } else {
+                tail->next = other.head;
+            }
+
+            tail = std::exchange(other.tail, nullptr);
+            count += std::exchange(other.count, 0);
+            other.head = nullptr;
+        }
+
+        void pop_front() {
+            if (head != nullptr) {
+                erase_at(nullptr, head, 0);
+            }
+        }
+
+        void remove(const size_t index) {
+            if (index >= count) {
+                throw std::out_of_range("Index out of range");
+            }
+
+            Chunk<T, N>* prev = nullptr;
+            Chunk<T, N>* chunk = head;
+            size_t offset = index;
+            while (offset >= chunk->count) {
+                offset -= chunk->count;
+                prev = chunk;
+                chunk = chunk->next;
+            }
+
+            erase_at(prev, chunk, offset);
+        }
+
+        /// Removes every element, nodes drawn from a bulk allocator are dropped without being visited since their owner
+        /// reclaims them all at once.
+        void clear() {
+            if constexpr (is_bulk_allocator_v<NodeAllocator> && std::is_trivially_destructible_v<T>) {
+                head = nullptr;
+            } else {
+                while (head != nullptr) {
+                    destroy(std::exchange(head, head->next));
+                }
+            }
+            tail = nullptr;
+            count = 0;
+        }
+
+        ~UnrolledList() {
+            clear();
+        }
+
+    private:
+        Chunk<T, N>* head = nullptr;
+        Chunk<T, N>* tail = nullptr;
+        size_t count = 0;
+        [[no_unique_address]] NodeAllocator alloc;
+
+        Chunk<T, N>* create() {
+            Chunk<T, N>* chunk = NodeTraits::allocate(alloc, 1);
+            return ::new (chunk) Chunk<T, N>;
+        }
+
+        void destroy(Chunk<T, N>* chunk) {
+            std::destroy_n(chunk->items(), chunk->count);
+            chunk->~Chunk();
+            NodeTraits::deallocate(alloc, chunk, 1);
+        }
+
+        [[nodiscard]] std::pair<Chunk<T, N>*, size_t> locate(size_t index) const {
+            Chunk<T, N>* chunk = head;
+            while (index >= chunk->count) {
+                index -= chunk->count;
+                chunk = chunk->next;
+            }
+            return {chunk, index};
+        }
+
+        /// Moves the upper half of a full node into a new node following it.
+        /// @return New node
+        Chunk<T, N>* split(Chunk<T, N>* chunk) {
+            Chunk<T, N>* half = create();
+            const size_t keep = (N + 1) / 2;
+
+            std::uninitialized_move(chunk->items() + keep, chunk->items() + chunk->count, half->items());
+            std::destroy(chunk->items() + keep, chunk->items() + chunk->count);
+            half->count = chunk->count - keep;
+            chunk->count = keep;
+
+            half->next = chunk->next;
+            chunk->next = half;
+            if (chunk == tail) {
+                tail = half;
+            }
+            return half;
+        }
+
+        /// Constructs an item at an offset of a node with room, shifting the following elements up.
+        void emplace_at(Chunk<T, N>* chunk, const size_t offset, T&& item) {
+            T* items = chunk->items();
+            if (offset == chunk->count) {
+                ::new (items + offset) T(std::move(item));
+            } else {
+                ::new (items + chunk->count) T(std::move(items[chunk->count - 1]));
+                std::move_backward(items + offset, items + chunk->count - 1, items + chunk->count);
+                items[offset] = std::move(item);
+            }
+            chunk->count++;
+        }
+
+        /// Removes the element at an offset of a node, unlinking the node once empty and merging it with its successor
+        /// once both fit in one.
+        void erase_at(Chunk<T, N>* prev, Chunk<T, N>* chunk, const size_t offset) {
+            T* items = chunk->items();
+            std::move(items + offset + 1, items + chunk->count, items + offset);
+            std::destroy_at(items + chunk->count - 1);
+            chunk->count--;
+            count--;
+
+            if (chunk->count == 0) {
+                if (prev == nullptr) {
+                    head = chunk->next;
+                } else {
+                    prev->next = chunk->next;
+                }
+                if (chunk == tail) {
+                    tail = prev;
+                }
+                destroy(chunk);
+                return;
+            }
+
+            if (Chunk<T, N>* next = chunk->next; next != nullptr && chunk->count + next->count <= N / 2) {
+                std::uninitialized_move(next->items(), next->items() + next->count, items + chunk->count);
+                std::destroy_n(next->items(), next->count);
+                chunk->count += next->count;
+                next->count = 0;
+
+                chunk->next = next->next;
+                if (next == tail) {
+                    tail = chunk;
+                }
+                destroy(next);
+            }
+        }
+
+        void copy_from(const UnrolledList& other) {
+            for (Chunk<T, N>* chunk = other.head; chunk != nullptr; chunk = chunk->next) {
+                for (size_t i = 0; i < chunk->count; i++) {
+                    push_back(chunk->items()[i]);
+                }
+            }
+        }
+    };
+}
@@ -0,0 +1,170 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Dast {
+    /// Hands out memory carved from large contiguous blocks. Small chunks that are given back are kept on free lists
+    /// per size class for reuse, and every block is returned at once when the arena is released or destroyed.
+    class Arena {
+    public:
+        static constexpr std::size_t default_block_size = std::size_t{1} << 20;
+
+        explicit Arena(const std::size_t block_size = default_block_size) : block_size(block_size) {}
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        Arena(Arena&& other) noexcept
+            : block_size(other.block_size), blocks(std::exchange(other.blocks, nullptr)),
+              cursor(std::exchange(other.cursor, nullptr)), limit(std::exchange(other.limit, nullptr)),
+              free_lists(std::exchange(other.free_lists, {})), reserved(std::exchange(other.reserved, 0)) {}
+
+        Arena& operator=(Arena&& other) noexcept {
+            if (this != &other) {
+                release();
+                block_size = other.block_size;
+                blocks = std::exchange(other.blocks, nullptr);
+                cursor = std::exchange(other.cursor, nullptr);
+                limit = std::exchange(other.limit, nullptr);
+                free_lists = std::exchange(other.free_lists, {});
+                reserved = std::exchange(other.reserved, 0);
+            }
+            return *this;
+        }
+
+        void* allocate(const std::size_t bytes, const std::size_t alignment = alignof(std::max_align_t)) {
+            const std::size_t size = round_up(bytes == 0 ? 1 : bytes, granularity);
+
+            // Reuse a chunk of the same size class if one was given back
+            if (alignment <= granularity && size <= max_pooled) {
+                if (FreeChunk*& chunk = free_lists[size / granularity - 1]; chunk != nullptr) {
+                    return std::exchange(chunk, chunk->next);
+                }
+            }
+
+            auto offset = round_up(reinterpret_cast<std::uintptr_t>(cursor), alignment) - reinterpret_cast<std::uintptr_t>(cursor);
+            if (cursor == nullptr || offset + size > static_cast<std::size_t>(limit - cursor)) {
+                grow(size + alignment);
+                offset = round_up(reinterpret_cast<std::uintptr_t>(cursor), alignment) - reinterpret_cast<std::uintptr_t>(cursor);
+            }
+
+            void* res = cursor + offset;
+            cursor += offset + size;
+            return res;
+        }
+
+        /// Gives a chunk back for reuse, chunks too large to pool stay reserved until the arena is released.
+        void deallocate(void* ptr, const std::size_t bytes) noexcept {
+            const std::size_t size = round_up(bytes == 0 ? 1 : bytes, granularity);
+
+            if (ptr != nullptr && size <= max_pooled) {
+                FreeChunk*& head = free_lists[size / granularity - 1];
+                head = ::new (ptr) FreeChunk{head};
+            }
+        }
+
+        /// Returns every block at once, invalidating all memory handed out so far.
+        void release() noexcept {
+            while (blocks != nullptr) {
+                ::operator delete(std::exchange(blocks, blocks->next));
+            }
+            cursor = nullptr;
+            limit = nullptr;
+            free_lists = {};
+            reserved = 0;
+        }
+
+        /// @return Bytes reserved from the system across all blocks
+        [[nodiscard]] std::size_t capacity() const {
+            return reserved;
+        }
+
+        ~Arena() {
+            release();
+        }
+
+    private:
+        struct Block {
+            Block* next;
+        };
+
+        struct FreeChunk {
+            FreeChunk* next;
+        };
+
+        static constexpr std::size_t granularity = alignof(std::max_align_t);
+        static constexpr std::size_t max_pooled = 16 * granularity;
+
+        std::size_t block_size;
+        Block* blocks = nullptr;
+        std::byte* cursor = nullptr;
+        std::byte* limit = nullptr;
+        std::array<FreeChunk*, max_pooled / granularity> free_lists = {};
+        std::size_t reserved = 0;
+
+        static constexpr std::size_t round_up(const std::size_t value, const std::size_t multiple) {
+            return (value + multiple - 1) / multiple * multiple;
+        }
+
+        void grow(const std::size_t min_size) {
+            const std::size_t header = round_up(sizeof(Block), granularity);
+            const std::size_t size = header + (min_size > block_size ? min_size : block_size);
+
+            auto* block = static_cast<std::byte*>(::operator new(size));
+            blocks = ::new (block) Block{blocks};
+            cursor = block + header;
+            limit = block + size;
+            reserved += size;
+        }
+    };
+
+    /// Standard allocator drawing from an arena, the arena must outlive every container using it.
+    template<typename T>
+    class ArenaAllocator {
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        explicit ArenaAllocator(Arena& arena) noexcept : arena(&arena) {}
+
+        template<typename U>
+        explicit(false) ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.get_arena()) {}
+
+        T* allocate(const std::size_t n) {
+            return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* ptr, const std::size_t n) noexcept {
+            arena->deallocate(ptr, n * sizeof(T));
+        }
+
+        [[nodiscard]] Arena* get_arena() const noexcept {
+            return arena;
+        }
+
+        template<typename U>
+        bool operator==(const ArenaAllocator<U>& other) const noexcept {
+            return arena == other.get_arena();
+        }
+
+    private:
+        Arena* arena;
+    };
+
+    /// Allocators whose memory is reclaimed in bulk by their owner, containers holding trivially destructible
+    /// elements may drop their storage without visiting it.
+    template<typename Allocator>
+    struct is_bulk_allocator : std::false_type {};
+
+    template<typename T>
+    struct is_bulk_allocator<ArenaAllocator<T>> : std::true_type {};
+
+    template<typename Allocator>
+    inline constexpr bool is_bulk_allocator_v = is_bulk_allocator<Allocator>::value;
+}
@@ -0,0 +1,349 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Gemm.hpp"
+
+namespace LinearLib {
+    namespace detail {
+        /// Panel width of the blocked factorizations, the trailing update of each panel is a single GEMM.
+        inline constexpr std::size_t factor_block = 64;
+
+        /**
+         * Factors columns [k, k + nb) of A in place with partial pivoting, swapping whole rows. L below the diagonal
+         * has an implicit unit diagonal and U is on and above it.
+         * @return Whether every pivot was nonzero
+         */
+        template<typename T>
+        bool luPanel(std::size_t const n, std::size_t const k, std::size_t const nb, T* a, std::size_t const lda,
+                     std::size_t* pivots, int& sign) {
+            bool regular = true;
+
+            for (std::size_t j = k; j < k + nb; j++) {
+                std::size_t pivot = j;
+                for (std::size_t i = j + 1; i < n; i++) {
+                    if (std::abs(a[i * lda + j]) > std::abs(a[pivot * lda + j])) {
+                        pivot = i;
+                    }
+                }
+
+                pivots[j] = pivot;
+                if (pivot != j) {
+                    std::swap_ranges(a + j * lda, a + j * lda + n, a + pivot * lda);
+                    sign = -sign;
+                }
+
+                const T diagonal = a[j * lda + j];
+                if (diagonal == T{0}) {
+                    regular = false;
+                    continue;
+                }
+
+                for (std::size_t i = j + 1; i < n; i++) {
+                    T* row = a + i * lda;
+                    const T l = row[j] /= diagonal;
+                    for (std::size_t c = j + 1; c < k + nb; c++) {
+                        row[c] -= l * a[j * lda + c];
+                    }
+                }
+            }
+
+            return regular;
+        }
+
+        /// Lower triangular solve with the unit diagonal L of rows [k, k + nb) applied to columns [begin, end).
+        template<typename T>
+        void unitLowerSolve(std::size_t const k, std::size_t const nb, std::size_t const begin, std::size_t const end,
+                            const T* l, std::size_t const ldl, T* b, std::size_t const ldb) {
+            for (std::size_t i = k + 1; i < k + nb; i++) {
+                T* row = b + i * ldb;
+                for (std::size_t j = k; j < i; j++) {
+                    const T lij = l[i * ldl + j];
+                    const T* source = b + j * ldb;
+                    for (std::size_t c = begin; c < end; c++) {
+                        row[c] -= lij * source[c];
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * LU decomposition with partial pivoting, PA = LU, of an n x n matrix. Panels of factor_block columns are factored
+     * one at a time and the rest of the matrix is updated with a single GEMM per panel, so large matrices run at GEMM
+     * speed. Determinant, solve and inverse then cost O(n^2) per right hand side.
+     */
+    template<std::floating_point T>
+    class LUDecomposition {
+    public:
+        /// Factors the row-major n x n matrix a with leading dimension lda.
+        LUDecomposition(std::size_t const n, const T* a, std::size_t const lda) : n(n), lu(n * n), pivots(n) {
+            for (std::size_t i = 0; i < n; i++) {
+                std::copy_n(a + i * lda, n, lu.data() + i * n);
+            }
+
+            T* data = lu.data();
+            for (std::size_t k = 0; k < n; k += detail::factor_block) {
+                const std::size_t nb = std::min(detail::factor_block, n - k);
+
+                regular &= detail::luPanel(n, k, nb, data, n, pivots.data(), sign);
+
+                const std::size_t rest = k + nb;
+                if (rest == n) {
+                    break;
+                }
+
+                // U12 = L11^-1 A12, then A22 -= L21 U12
+                detail::unitLowerSolve(k, nb, rest, n, data, n, data, n);
+                gemm(n - rest, n - rest, nb, T{-1}, data + rest * n + k, n, std::size_t{1},
+                     data + k * n + rest, n, std::size_t{1}, T{1}, data + rest * n + rest, n);
+            }
+        }
+
+        [[nodiscard]] std::size_t size() const {
+            return n;
+        }
+
+        /// @return Whether the matrix is invertible, i.e. no pivot was exactly zero
+        [[nodiscard]] bool isRegular() const {
+            return regular;
+        }
+
+        [[nodiscard]] T determinant() const {
+            T res = static_cast<T>(sign);
+            for (std::size_t i = 0; i < n; i++) {
+                res *= lu[i * n + i];
+            }
+            return res;
+        }
+
+        /**
+         * Solves AX = B in place for nrhs right hand sides.
+         * @param b Row-major n x nrhs matrix with leading dimension ldb, overwritten with X.
+         */
+        void solve(T* b, std::size_t const nrhs, std::size_t const ldb) const {
+            if (!regular) {
+                throw std::domain_error("Matrix is singular");
+            }
+
+            for (std::size_t i = 0; i < n; i++) {
+                if (pivots[i] != i) {
+                    std::swap_ranges(b + i * ldb, b + i * ldb + nrhs, b + pivots[i] * ldb);
+                }
+            }
+
+            detail::unitLowerSolve(0, n, 0, nrhs, lu.data(), n, b, ldb);
+
+            for (std::size_t i = n; i-- > 0;) {
+                T* row = b + i * ldb;
+                for (std::size_t j = i + 1; j < n; j++) {
+                    const T uij = lu[i * n + j];
+                    const T* source = b + j * ldb;
+                    for (std::size_t c = 0; c < nrhs; c++) {
+                        row[c] -= uij * source[c];
+                    }
+                }
+                const T diagonal = lu[i * n + i];
+                for (std::size_t c = 0; c < nrhs; c++) {
+                    row[c] /= diagonal;
+                }
+            }
+        }
+
+        /// Writes A^-1 to the row-major n x n matrix out with leading dimension ldo.
+        void inverse(T* out, std::size_t const ldo) const {
+            for (std::size_t i = 0; i < n; i++) {
+                std::fill_n(out + i * ldo, n, T{0});
+                out[i * ldo + i] = T{1};
+            }
+            solve(out, n, ldo);
+        }
+
+    private:
+        std::size_t n;
+        std::vector<T> lu;
+        std::vector<std::size_t> pivots;
+        int sign = 1;
+        bool regular = true;
+    };
+
+    /**
+     * Cholesky decomposition, A = LL^T, of a symmetric positive-definite n x n matrix, only the lower triangle of which
+     * is read. Blocked like LUDecomposition without pivoting, and the trailing update only forms the lower triangle,
+     * one GEMM per block column, so the factorization takes about half of LU's flops.
+     */
+    template<std::floating_point T>
+    class CholeskyDecomposition {
+    public:
+        /// @throws std::domain_error If the matrix is not positive-definite
+        CholeskyDecomposition(std::size_t const n, const T* a, std::size_t const lda) : n(n), l(n * n, T{0}) {
+            for (std::size_t i = 0; i < n; i++) {
+                std::copy_n(a + i * lda, i + 1, l.data() + i * n);
+            }
+
+            T* data = l.data();
+            for (std::size_t k = 0; k < n; k += detail::factor_block) {
+                const std::size_t nb = std::min(detail::factor_block, n - k);
+
+                // L11 and L21 column by column, the trailing update is deferred to the GEMM below
+                for (std::size_t j = k; j < k + nb; j++) {
+                    T diagonal = data[j * n + j];
+                    for (std::size_t p = k; p < j; p++) {
+                        diagonal -= data[j * n + p] * data[j * n + p];
+                    }
+                    if (!(diagonal > T{0})) {
+                        throw std::domain_error("Matrix is not positive-definite");
+                    }
+                    diagonal = std::sqrt(diagonal);
+                    data[j * n + j] = diagonal;
+
+                    for (std::size_t i = j + 1; i < n; i++) {
+                        T sum = data[i * n + j];
+                        for (std::size_t p = k; p < j; p++) {
+                            sum -= data[i * n + p] * data[j * n + p];
+                        }
+                        data[i * n + j] = sum / diagonal;
+                    }
+                }
+
+                const std::size_t rest = k + nb;
+                if (rest == n) {
+                    break;
+                }
+
+                // Lower triangle of A22 -= L21 L21^T one block column at a time, rows from the block's diagonal down.
+                // L21^T is read through swapped strides
+                for (std::size_t j = rest; j < n; j += detail::factor_block) {
+                    const std::size_t w = std::min(detail::factor_block, n - j);
+                    gemm(n - j, w, nb, T{-1}, data + j * n + k, n, std::size_t{1},
+                         data + j * n + k, std::size_t{1}, n, T{1}, data + j * n + j, n);
+                }
+            }
+
+            // The diagonal blocks of the updates also wrote above the diagonal
+            for (std::size_t i = 0; i < n; i++) {
+                std::fill(data + i * n + i + 1, data + (i + 1) * n, T{0});
+            }
+        }
+
+        [[nodiscard]] std::size_t size() const {
+            return n;
+        }
+
+        /// @return Row-major n x n lower triangular factor
+        [[nodiscard]] const std::vector<T>& lower() const {
+            return l;
+        }
+
+        [[nodiscard]] T determinant() const {
+            T res = T{1};
+            for (std::size_t i = 0; i < n; i++) {
+                res *= l[i * n + i];
+            }
+            return res * res;
+        }
+
+        /// Solves AX = B in place, see LUDecomposition::solve.
+        void solve(T* b, std::size_t const nrhs, std::size_t const ldb) const {
+            for (std::size_t i = 0; i < n; i++) {
+                T* row = b + i * ldb;
+                for (std::size_t j = 0; j < i; j++) {
+                    const T lij = l[i * n + j];
+                    const T* source = b + j * ldb;
+                    for (std::size_t c = 0; c < nrhs; c++) {
+                        row[c] -= lij * source[c];
+                    }
+                }
+                for (std::size_t c = 0; c < nrhs; c++) {
+                    row[c] /= l[i * n + i];
+                }
+            }
+
+            for (std::size_t i = n; i-- > 0;) {
+                T* row = b + i * ldb;
+                for (std::size_t j = i + 1; j < n; j++) {
+                    const T lji = l[j * n + i];
+                    const T* source = b + j * ldb;
+                    for (std::size_t c = 0; c < nrhs; c++) {
+                        row[c] -= lji * source[c];
+                    }
+                }
+                for (std::size_t c = 0; c < nrhs; c++) {
+                    row[c] /= l[i * n + i];
+                }
+            }
+        }
+
+        void inverse(T* out, std::size_t const ldo) const {
+            for (std::size_t i = 0; i < n; i++) {
+                std::fill_n(out + i * ldo, n, T{0});
+                out[i * ldo + i] = T{1};
+            }
+            solve(out, n, ldo);
+        }
+
+    private:
+        std::size_t n;
+        std::vector<T> l;
+    };
+
+    /**
+     * Exact determinant of an integer matrix by fraction-free Bareiss elimination, every division of which is exact.
+     * Every stored entry is a minor of the matrix and has to fit in long long. The products formed before each division
+     * are up to a minor squared; they are taken in 128 bits where the compiler has them, otherwise they have to fit in
+     * long long as well.
+     */
+    template<std::integral T>
+    T bareissDeterminant(std::size_t const n, const T* a, std::size_t const lda) {
+        if (n == 0) {
+            return T{1};
+        }
+
+        std::vector<long long> m(n * n);
+        for (std::size_t i = 0; i < n; i++) {
+            for (std::size_t j = 0; j < n; j++) {
+                m[i * n + j] = static_cast<long long>(a[i * lda + j]);
+            }
+        }
+
+        long long sign = 1;
+        long long previous = 1;
+
+        for (std::size_t k = 0; k + 1 < n; k++) {
+            if (m[k * n + k] == 0) {
+                std::size_t pivot = k + 1;
+                while (pivot < n && m[pivot * n + k] == 0) {
+                    pivot++;
+                }
+                if (pivot == n) {
+                    return T{0};
+                }
+                std::swap_ranges(m.begin() + k * n, m.begin() + (k + 1) * n, m.begin() + pivot * n);
+                sign = -sign;
+            }
+
+            const long long diagonal = m[k * n + k];
+            for (std::size_t i = k + 1; i < n; i++) {
+                for (std::size_t j = k + 1; j < n; j++) {
+#if defined(__SIZEOF_INT128__)
+                    using Wide = __int128;
+#else
+                    using Wide = long long;
+#endif
+                    const Wide product = static_cast<Wide>(m[i * n + j]) * diagonal -
+                                         static_cast<Wide>(m[i * n + k]) * m[k * n + j];
+                    m[i * n + j] = static_cast<long long>(product / previous);
+                }
+            }
+            previous = diagonal;
+        }
+
+        return static_cast<T>(sign * m[n * n - 1]);
+    }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "Half.hpp"
+#include "ThreadPool.hpp"
+
+namespace LinearLib {
+    /// Element-wise function of one element that can replace it.
+    template<typename F, typename T>
+    concept UnaryOperation = std::invocable<F&, T> && std::convertible_to<std::invoke_result_t<F&, T>, T>;
+
+    /// Element-wise function producing an arithmetic value of any type.
+    template<typename F, typename... T>
+    concept ElementMap = std::invocable<F&, T...> && Numeric<std::remove_cvref_t<std::invoke_result_t<F&, T...>>>;
+
+    /// Folds an accumulator with one element, and with another accumulator so partial results can be combined.
+    template<typename F, typename Acc, typename T>
+    concept Reduction = std::invocable<F&, Acc, T> && std::convertible_to<std::invoke_result_t<F&, Acc, T>, Acc> &&
+                        std::invocable<F&, Acc, Acc> && std::convertible_to<std::invoke_result_t<F&, Acc, Acc>, Acc> &&
+                        std::constructible_from<Acc, T>;
+
+    template<typename F, typename... T>
+    using map_result_t = std::remove_cvref_t<std::invoke_result_t<F&, T...>>;
+
+    namespace detail {
+        /// Element-wise kernels split across the shared ThreadPool in chunks of at least this many elements.
+        inline constexpr std::size_t elementwise_grain = std::size_t{1} << 15;
+
+        /// Runs func(lo, hi) over [0, n), on the shared pool when parallel and the range is large enough.
+        template<typename F>
+        void elementwise(std::size_t const n, bool const parallel, F&& func) {
+            if (parallel && n > elementwise_grain) {
+                parallelFor(0, n, elementwise_grain, func);
+            } else {
+                func(std::size_t{0}, n);
+            }
+        }
+
+        template<typename T, typename F>
+        void apply(T* data, std::size_t const n, F& func, bool const parallel) {
+            elementwise(n, parallel, [&](std::size_t const lo, std::size_t const hi) {
+                for (std::size_t i = lo; i < hi; i++) {
+                    data[i] = static_cast<T>(std::invoke(func, data[i]));
+                }
+            });
+        }
+
+        template<typename T, typename U, typename F>
+        void map(const T* in, U* out, std::size_t const n, F& func, bool const parallel) {
+            elementwise(n, parallel, [&](std::size_t const lo, std::size_t const hi) {
+                for (std::size_t i = lo; i < hi; i++) {
+                    out[i] = std::invoke(func, in[i]);
+                }
+            });
+        }
+
+        template<typename T, typename U, typename V, typename F>
+        void zipMap(const T* lhs, const U* rhs, V* out, std::size_t const n, F& func, bool const parallel) {
+            elementwise(n, parallel, [&](std::size_t const lo, std::size_t const hi) {
+                for (std::size_t i = lo; i < hi; i++) {
+                    out[i] = std::invoke(func, lhs[i], rhs[i]);
+                }
+            });
+        }
+
+        /**
+         * Left fold of init and the elements. The parallel fold reduces fixed chunks, each starting from its first
+         * element, and folds init with the partial results in order, so op only has to be associative and the result
+         * does not depend on the number of threads.
+         */
+        template<typename T, typename Acc, typename Op>
+        Acc reduce(const T* in, std::size_t const n, Acc init, Op& op, bool const parallel) {
+            if (!parallel || n <= elementwise_grain) {
+                for (std::size_t i = 0; i < n; i++) {
+                    init = std::invoke(op, std::move(init), in[i]);
+                }
+                return init;
+            }
+
+            // Optional slots need no default constructible Acc and, unlike std::vector<bool>, never share a byte
+            // between the chunks written by different threads
+            const std::size_t chunks = (n + elementwise_grain - 1) / elementwise_grain;
+            std::vector<std::optional<Acc>> partial(chunks);
+
+            parallelFor(0, chunks, 1, [&](std::size_t const lo, std::size_t const hi) {
+                for (std::size_t c = lo; c < hi; c++) {
+                    const std::size_t begin = c * elementwise_grain;
+                    const std::size_t end = std::min(n, begin + elementwise_grain);
+                    Acc acc = static_cast<Acc>(in[begin]);
+                    for (std::size_t i = begin + 1; i < end; i++) {
+                        acc = std::invoke(op, std::move(acc), in[i]);
+                    }
+                    partial[c] = std::move(acc);
+                }
+            });
+
+            for (std::optional<Acc>& acc : partial) {
+                init = std::invoke(op, std::move(init), std::move(*acc));
+            }
+            return init;
+        }
+    }
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+#include "Half.hpp"
+
+namespace LinearLib {
+    /**
+     * Lazily evaluated element-wise expression over an R x C shape. Nodes only describe the computation, which runs
+     * as a single loop over the flat element index once the expression is assigned to a Matrix or Vector, so chains
+     * like lazy(a) * lazy(b) + lazy(c) * s - lazy(d) need neither temporaries nor extra passes.
+     */
+    template<typename E>
+    concept MatrixExpression = requires(const E& e, std::size_t i) {
+        typename E::value_type;
+        requires Numeric<typename E::value_type>;
+        { E::rows } -> std::convertible_to<std::size_t>;
+        { E::cols } -> std::convertible_to<std::size_t>;
+        { e[i] } -> std::convertible_to<typename E::value_type>;
+    };
+
+    template<typename L, typename R>
+    concept SameShape = MatrixExpression<L> && MatrixExpression<R> && L::rows == R::rows && L::cols == R::cols &&
+                        std::same_as<typename L::value_type, typename R::value_type>;
+
+    /// Contiguous row-major storage read as an expression, see lazy().
+    template<typename T, std::size_t R, std::size_t C>
+    struct LeafExpression {
+        using value_type = T;
+        static constexpr std::size_t rows = R;
+        static constexpr std::size_t cols = C;
+
+        const T* ptr;
+
+        T operator[](std::size_t const i) const {
+            return ptr[i];
+        }
+    };
+
+    template<typename L, typename R, typename Op>
+    struct BinaryExpression {
+        using value_type = typename L::value_type;
+        static constexpr std::size_t rows = L::rows;
+        static constexpr std::size_t cols = L::cols;
+
+        L lhs;
+        R rhs;
+        [[no_unique_address]] Op op;
+
+        value_type operator[](std::size_t const i) const {
+            return op(lhs[i], rhs[i]);
+        }
+    };
+
+    /// Expression combined with the same scalar at every element, the scalar on the right unless Left is set.
+    template<typename E, typename Op, bool Left = false>
+    struct ScalarExpression {
+        using value_type = typename E::value_type;
+        static constexpr std::size_t rows = E::rows;
+        static constexpr std::size_t cols = E::cols;
+
+        E expr;
+        value_type scalar;
+        [[no_unique_address]] Op op;
+
+        value_type operator[](std::size_t const i) const {
+            if constexpr (Left) {
+                return op(scalar, expr[i]);
+            } else {
+                return op(expr[i], scalar);
+            }
+        }
+    };
+
+    template<typename E, typename Op>
+    struct UnaryExpression {
+        using value_type = typename E::value_type;
+        static constexpr std::size_t rows = E::rows;
+        static constexpr std::size_t cols = E::cols;
+
+        E expr;
+        [[no_unique_address]] Op op;
+
+        value_type operator[](std::size_t const i) const {
+            return op(expr[i]);
+        }
+    };
+
+    /// Writes every element of an expression to contiguous row-major storage.
+    template<MatrixExpression E>
+    void evaluate(const E& expr, typename E::value_type* out) {
+        for (std::size_t i = 0; i < E::rows * E::cols; i++) {
+            out[i] = expr[i];
+        }
+    }
+
+    template<typename L, typename R>
+    requires SameShape<L, R>
+    BinaryExpression<L, R, std::plus<>> operator+(const L& lhs, const R& rhs) {
+        return {lhs, rhs, {}};
+    }
+
+    template<typename L, typename R>
+    requires SameShape<L, R>
+    BinaryExpression<L, R, std::minus<>> operator-(const L& lhs, const R& rhs) {
+        return {lhs, rhs, {}};
+    }
+
+    /**
+     * Element-wise multiplication, also for vectors
+     */
+    template<typename L, typename R>
+    requires SameShape<L, R>
+    BinaryExpression<L, R, std::multiplies<>> operator*(const L& lhs, const R& rhs) {
+        return {lhs, rhs, {}};
+    }
+
+    /**
+     * Element-wise division
+     */
+    template<typename L, typename R>
+    requires SameShape<L, R>
+    BinaryExpression<L, R, std::divides<>> operator/(const L& lhs, const R& rhs) {
+        return {lhs, rhs, {}};
+    }
+
+    /**
+     * Scalar Multiplication
+     */
+    template<MatrixExpression E>
+    ScalarExpression<E, std::multiplies<>> operator*(const E& expr, const typename E::value_type& scalar) {
+        return {expr, scalar, {}};
+    }
+
+    template<MatrixExpression E>
+    ScalarExpression<E, std::multiplies<>, true> operator*(const typename E::value_type& scalar, const E& expr) {
+        return {expr, scalar, {}};
+    }
+
+    /**
+     * Scalar Division
+     */
+    template<MatrixExpression E>
+    ScalarExpression<E, std::divides<>> operator/(const E& expr, const typename E::value_type& scalar) {
+        return {expr, scalar, {}};
+    }
+
+    template<MatrixExpression E>
+    UnaryExpression<E, std::negate<>> operator-(const E& expr) {
+        return {expr, {}};
+    }
+}
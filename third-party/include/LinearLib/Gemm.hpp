@@ -0,0 +1,418 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "Half.hpp"
+#include "ThreadPool.hpp"
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace LinearLib {
+    namespace detail {
+        /// Register block of the portable micro-kernel, small enough for the compiler to keep in registers.
+        template<typename T>
+        struct GemmKernel {
+            static constexpr std::size_t MR = 4;
+            static constexpr std::size_t NR = 4;
+
+            static void run(std::size_t const kc, const T* a, const T* b, T* c, std::size_t const ldc) {
+                T acc[MR][NR] = {};
+
+                for (std::size_t p = 0; p < kc; p++) {
+                    for (std::size_t i = 0; i < MR; i++) {
+                        for (std::size_t j = 0; j < NR; j++) {
+                            acc[i][j] += a[i] * b[j];
+                        }
+                    }
+                    a += MR;
+                    b += NR;
+                }
+
+                for (std::size_t i = 0; i < MR; i++) {
+                    for (std::size_t j = 0; j < NR; j++) {
+                        c[i * ldc + j] += acc[i][j];
+                    }
+                }
+            }
+        };
+
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+        /// Micro-kernel over two SIMD registers per row, accumulating an MR x 2W block of C in registers.
+        template<typename Simd, std::size_t Rows>
+        struct SimdGemmKernel {
+            using T = typename Simd::value_type;
+
+            static constexpr std::size_t MR = Rows;
+            static constexpr std::size_t NR = 2 * Simd::width;
+
+            static void run(std::size_t const kc, const T* a, const T* b, T* c, std::size_t const ldc) {
+                typename Simd::reg acc[MR][2];
+                for (std::size_t i = 0; i < MR; i++) {
+                    acc[i][0] = Simd::zero();
+                    acc[i][1] = Simd::zero();
+                }
+
+                for (std::size_t p = 0; p < kc; p++) {
+                    const auto b0 = Simd::load(b);
+                    const auto b1 = Simd::load(b + Simd::width);
+                    for (std::size_t i = 0; i < MR; i++) {
+                        const auto ai = Simd::broadcast(a + i);
+                        acc[i][0] = Simd::fmadd(ai, b0, acc[i][0]);
+                        acc[i][1] = Simd::fmadd(ai, b1, acc[i][1]);
+                    }
+                    a += MR;
+                    b += NR;
+                }
+
+                for (std::size_t i = 0; i < MR; i++) {
+                    T* row = c + i * ldc;
+                    Simd::store(row, Simd::add(Simd::load(row), acc[i][0]));
+                    Simd::store(row + Simd::width, Simd::add(Simd::load(row + Simd::width), acc[i][1]));
+                }
+            }
+        };
+#endif
+
+#if defined(__AVX512F__)
+        struct Avx512Float {
+            using value_type = float;
+            using reg = __m512;
+            static constexpr std::size_t width = 16;
+            static reg zero() { return _mm512_setzero_ps(); }
+            static reg load(const float* p) { return _mm512_loadu_ps(p); }
+            static reg broadcast(const float* p) { return _mm512_set1_ps(*p); }
+            static reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_ps(a, b, c); }
+            static reg add(reg a, reg b) { return _mm512_add_ps(a, b); }
+            static void store(float* p, reg v) { _mm512_storeu_ps(p, v); }
+        };
+
+        struct Avx512Double {
+            using value_type = double;
+            using reg = __m512d;
+            static constexpr std::size_t width = 8;
+            static reg zero() { return _mm512_setzero_pd(); }
+            static reg load(const double* p) { return _mm512_loadu_pd(p); }
+            static reg broadcast(const double* p) { return _mm512_set1_pd(*p); }
+            static reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_pd(a, b, c); }
+            static reg add(reg a, reg b) { return _mm512_add_pd(a, b); }
+            static void store(double* p, reg v) { _mm512_storeu_pd(p, v); }
+        };
+
+        template<>
+        struct GemmKernel<float> : SimdGemmKernel<Avx512Float, 8> {};
+
+        template<>
+        struct GemmKernel<double> : SimdGemmKernel<Avx512Double, 8> {};
+#elif defined(__AVX2__) && defined(__FMA__)
+        struct Avx2Float {
+            using value_type = float;
+            using reg = __m256;
+            static constexpr std::size_t width = 8;
+            static reg zero() { return _mm256_setzero_ps(); }
+            static reg load(const float* p) { return _mm256_loadu_ps(p); }
+            static reg broadcast(const float* p) { return _mm256_broadcast_ss(p); }
+            static reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_ps(a, b, c); }
+            static reg add(reg a, reg b) { return _mm256_add_ps(a, b); }
+            static void store(float* p, reg v) { _mm256_storeu_ps(p, v); }
+        };
+
+        struct Avx2Double {
+            using value_type = double;
+            using reg = __m256d;
+            static constexpr std::size_t width = 4;
+            static reg zero() { return _mm256_setzero_pd(); }
+            static reg load(const double* p) { return _mm256_loadu_pd(p); }
+            static reg broadcast(const double* p) { return _mm256_broadcast_sd(p); }
+            static reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_pd(a, b, c); }
+            static reg add(reg a, reg b) { return _mm256_add_pd(a, b); }
+            static void store(double* p, reg v) { _mm256_storeu_pd(p, v); }
+        };
+
+        template<>
+        struct GemmKernel<float> : SimdGemmKernel<Avx2Float, 6> {};
+
+        template<>
+        struct GemmKernel<double> : SimdGemmKernel<Avx2Double, 6> {};
+#endif
+
+        /// Cache blocking: a KC x NC panel of B stays in L3, an MC x KC block of A in L2 and a KC x NR sliver of B in L1.
+        template<typename T>
+        struct GemmBlocking {
+            static constexpr std::size_t KC = 256;
+            static constexpr std::size_t MC = GemmKernel<T>::MR * (sizeof(T) > 4 ? 12 : 16);
+            static constexpr std::size_t NC = GemmKernel<T>::NR * 128;
+        };
+
+        /// Below this many multiply-adds packing costs more than it saves.
+        inline constexpr std::size_t gemm_small = 32 * 32 * 32;
+
+        /// Below this many multiply-adds waking the pool costs more than it saves.
+        inline constexpr std::size_t gemm_parallel = 128 * 128 * 128;
+
+        /// Per-thread packing buffer, Slot keeps the A and B buffers of one thread apart.
+        template<typename T, int Slot>
+        T* packBuffer(std::size_t const size) {
+            thread_local std::vector<T> buffer;
+            if (buffer.size() < size) {
+                buffer.resize(size);
+            }
+            return buffer.data();
+        }
+
+        /// Packs rows [0, mc) x [0, kc) of A into panels of MR rows, each stored column by column and zero padded.
+        template<typename T, typename S>
+        void packA(std::size_t const mc, std::size_t const kc, const S* a, std::size_t const rs, std::size_t const cs,
+                   T const alpha, T* out) {
+            constexpr std::size_t MR = GemmKernel<T>::MR;
+
+            for (std::size_t i = 0; i < mc; i += MR) {
+                const std::size_t rows = std::min(MR, mc - i);
+                for (std::size_t p = 0; p < kc; p++) {
+                    for (std::size_t r = 0; r < rows; r++) {
+                        out[r] = alpha * static_cast<T>(a[(i + r) * rs + p * cs]);
+                    }
+                    for (std::size_t r = rows; r < MR; r++) {
+                        out[r] = T{};
+                    }
+                    out += MR;
+                }
+            }
+        }
+
+        /// Packs rows [0, kc) x [0, nc) of B into panels of NR columns, each stored row by row and zero padded.
+        template<typename T, typename S>
+        void packB(std::size_t const kc, std::size_t const nc, const S* b, std::size_t const rs, std::size_t const cs, T* out) {
+            constexpr std::size_t NR = GemmKernel<T>::NR;
+
+            for (std::size_t j = 0; j < nc; j += NR) {
+                const std::size_t cols = std::min(NR, nc - j);
+                for (std::size_t p = 0; p < kc; p++) {
+                    const S* row = b + p * rs + j * cs;
+                    if (cs == 1) {
+                        std::copy_n(row, cols, out);
+                    } else {
+                        for (std::size_t c = 0; c < cols; c++) {
+                            out[c] = static_cast<T>(row[c * cs]);
+                        }
+                    }
+                    std::fill(out + cols, out + NR, T{});
+                    out += NR;
+                }
+            }
+        }
+
+        /// Multiplies a packed MC x KC block of A with a packed KC x NC panel of B into C.
+        template<typename T>
+        void macroKernel(std::size_t const mc, std::size_t const nc, std::size_t const kc, const T* a, const T* b,
+                         T* c, std::size_t const ldc) {
+            constexpr std::size_t MR = GemmKernel<T>::MR;
+            constexpr std::size_t NR = GemmKernel<T>::NR;
+
+            alignas(64) T edge[MR * NR];
+
+            for (std::size_t j = 0; j < nc; j += NR) {
+                const std::size_t cols = std::min(NR, nc - j);
+                for (std::size_t i = 0; i < mc; i += MR) {
+                    const std::size_t rows = std::min(MR, mc - i);
+                    T* tile = c + i * ldc + j;
+
+                    if (rows == MR && cols == NR) {
+                        GemmKernel<T>::run(kc, a + i * kc, b + j * kc, tile, ldc);
+                        continue;
+                    }
+
+                    // Partial tiles go through a full size scratch tile so the kernel never writes out of bounds
+                    for (std::size_t r = 0; r < MR; r++) {
+                        for (std::size_t s = 0; s < NR; s++) {
+                            edge[r * NR + s] = r < rows && s < cols ? tile[r * ldc + s] : T{};
+                        }
+                    }
+                    GemmKernel<T>::run(kc, a + i * kc, b + j * kc, edge, NR);
+                    for (std::size_t r = 0; r < rows; r++) {
+                        std::copy_n(edge + r * NR, cols, tile + r * ldc);
+                    }
+                }
+            }
+        }
+
+        template<typename T>
+        void scale(std::size_t const m, std::size_t const n, T const beta, T* c, std::size_t const ldc) {
+            for (std::size_t i = 0; i < m; i++) {
+                T* row = c + i * ldc;
+                if (beta == T{0}) {
+                    std::fill_n(row, n, T{0});
+                } else if (beta != T{1}) {
+                    for (std::size_t j = 0; j < n; j++) {
+                        row[j] *= beta;
+                    }
+                }
+            }
+        }
+    }
+
+    namespace detail {
+        /// C += alpha * A * B computed in T, reading A and B as S and converting while packing.
+        template<typename T, typename S>
+        void gemmAccumulate(std::size_t const m, std::size_t const n, std::size_t const k, T const alpha,
+                            const S* a, std::size_t const a_rs, std::size_t const a_cs,
+                            const S* b, std::size_t const b_rs, std::size_t const b_cs, T* c, std::size_t const ldc) {
+            // Small products stream B row by row, which the compiler vectorizes well enough
+            if (m * n * k <= detail::gemm_small) {
+                for (std::size_t i = 0; i < m; i++) {
+                    T* row = c + i * ldc;
+                    for (std::size_t p = 0; p < k; p++) {
+                        const T aip = alpha * static_cast<T>(a[i * a_rs + p * a_cs]);
+                        const S* brow = b + p * b_rs;
+                        for (std::size_t j = 0; j < n; j++) {
+                            row[j] += aip * static_cast<T>(brow[j * b_cs]);
+                        }
+                    }
+                }
+                return;
+            }
+
+            using Blocking = detail::GemmBlocking<T>;
+            constexpr std::size_t NR = detail::GemmKernel<T>::NR;
+
+            const bool parallel = m * n * k >= detail::gemm_parallel && !ThreadPool::inParallel();
+            ThreadPool* pool = parallel ? &ThreadPool::shared() : nullptr;
+            const std::size_t threads = pool != nullptr ? pool->size() : 1;
+
+            T* packed_b = detail::packBuffer<T, 1>(Blocking::KC * Blocking::NC);
+
+            for (std::size_t jc = 0; jc < n; jc += Blocking::NC) {
+                const std::size_t nc = std::min(Blocking::NC, n - jc);
+                const std::size_t panels = (nc + NR - 1) / NR;
+
+                // Each macro tile is a block of MC rows by a group of whole B panels. The row blocks alone are split
+                // across threads when there are enough of them, otherwise the panels are grouped as well
+                const std::size_t row_blocks = (m + Blocking::MC - 1) / Blocking::MC;
+                const std::size_t groups = std::min(panels, (threads + row_blocks - 1) / row_blocks);
+
+                for (std::size_t pc = 0; pc < k; pc += Blocking::KC) {
+                    const std::size_t kc = std::min(Blocking::KC, k - pc);
+
+                    auto pack = [&](std::size_t const lo, std::size_t const hi) {
+                        const std::size_t cols = std::min(nc, hi * NR) - lo * NR;
+                        detail::packB(kc, cols, b + pc * b_rs + (jc + lo * NR) * b_cs, b_rs, b_cs, packed_b + lo * NR * kc);
+                    };
+
+                    auto tile = [&](std::size_t const lo, std::size_t const hi) {
+                        T* packed_a = detail::packBuffer<T, 0>(Blocking::MC * Blocking::KC);
+
+                        for (std::size_t t = lo; t < hi; t++) {
+                            const std::size_t ic = t / groups * Blocking::MC;
+                            const std::size_t mc = std::min(Blocking::MC, m - ic);
+                            const std::size_t first = panels * (t % groups) / groups * NR;
+                            const std::size_t last = std::min(nc, panels * (t % groups + 1) / groups * NR);
+
+                            detail::packA(mc, kc, a + ic * a_rs + pc * a_cs, a_rs, a_cs, alpha, packed_a);
+                            detail::macroKernel(mc, last - first, kc, packed_a, packed_b + first * kc,
+                                                c + ic * ldc + jc + first, ldc);
+                        }
+                    };
+
+                    if (pool != nullptr) {
+                        pool->parallelFor(0, panels, 8, pack);
+                        pool->parallelFor(0, row_blocks * groups, 1, tile);
+                    } else {
+                        pack(0, panels);
+                        tile(0, row_blocks * groups);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * General matrix multiplication, C = alpha * A * B + beta * C.
+     *
+     * A (m x k) and B (k x n) are addressed through a row and a column stride each, so transposed or strided views
+     * multiply without copies. C (m x n) is row-major with leading dimension ldc. Large products pack A and B into
+     * cache sized blocks and run a register blocked micro-kernel, using AVX-512 or AVX2 FMA for float and double when
+     * the compiler targets them. Products big enough to pay for it are split into macro tiles run on the shared
+     * ThreadPool, each thread packing its own blocks of A against a shared packed panel of B.
+     */
+    template<typename T>
+    requires std::is_arithmetic_v<T>
+    void gemm(std::size_t const m, std::size_t const n, std::size_t const k, T const alpha,
+              const T* a, std::size_t const a_rs, std::size_t const a_cs,
+              const T* b, std::size_t const b_rs, std::size_t const b_cs,
+              T const beta, T* c, std::size_t const ldc) {
+
+        detail::scale(m, n, beta, c, ldc);
+
+        if (m == 0 || n == 0 || k == 0 || alpha == T{0}) {
+            return;
+        }
+
+        detail::gemmAccumulate(m, n, k, alpha, a, a_rs, a_cs, b, b_rs, b_cs, c, ldc);
+    }
+
+    /**
+     * GEMM on 16 bit floats. A and B are converted to float while they are packed and the product is accumulated in
+     * float, so only the final result is rounded to the storage type.
+     */
+    template<ReducedFloat T>
+    void gemm(std::size_t const m, std::size_t const n, std::size_t const k, float const alpha,
+              const T* a, std::size_t const a_rs, std::size_t const a_cs,
+              const T* b, std::size_t const b_rs, std::size_t const b_cs,
+              float const beta, T* c, std::size_t const ldc) {
+
+        if (m == 0 || n == 0) {
+            return;
+        }
+
+        thread_local std::vector<float> acc;
+        acc.assign(m * n, 0.0f);
+
+        if (beta != 0.0f) {
+            for (std::size_t i = 0; i < m; i++) {
+                for (std::size_t j = 0; j < n; j++) {
+                    acc[i * n + j] = beta * static_cast<float>(c[i * ldc + j]);
+                }
+            }
+        }
+
+        if (k != 0 && alpha != 0.0f) {
+            detail::gemmAccumulate(m, n, k, alpha, a, a_rs, a_cs, b, b_rs, b_cs, acc.data(), n);
+        }
+
+        for (std::size_t i = 0; i < m; i++) {
+            std::copy_n(acc.data() + i * n, n, c + i * ldc);
+        }
+    }
+
+    /**
+     * Strided batched GEMM, C_i = alpha * A_i * B_i + beta * C_i for i < batch where A_i starts at a + i * a_bs and
+     * likewise for B and C. A batch stride of 0 reuses one operand for every product. The products are spread across
+     * the shared ThreadPool, enough of them per task to pay for it, and each then runs on a single thread, so many
+     * small products such as per-head attention scores do not pay per-call overhead.
+     */
+    template<Numeric T>
+    void gemmBatched(std::size_t const batch, std::size_t const m, std::size_t const n, std::size_t const k,
+                     compute_t<T> const alpha, const T* a, std::size_t const a_bs, std::size_t const a_rs,
+                     std::size_t const a_cs, const T* b, std::size_t const b_bs, std::size_t const b_rs,
+                     std::size_t const b_cs, compute_t<T> const beta, T* c, std::size_t const c_bs,
+                     std::size_t const ldc) {
+        const std::size_t work = std::max<std::size_t>(m * n * k, 1);
+
+        parallelFor(0, batch, std::max<std::size_t>(1, detail::gemm_parallel / work),
+                    [&](std::size_t const lo, std::size_t const hi) {
+            for (std::size_t i = lo; i < hi; i++) {
+                gemm(m, n, k, alpha, a + i * a_bs, a_rs, a_cs, b + i * b_bs, b_rs, b_cs, beta, c + i * c_bs, ldc);
+            }
+        });
+    }
+
+    /// Row-major product of contiguous matrices, C = A * B.
+    template<Numeric T>
+    void gemm(std::size_t const m, std::size_t const n, std::size_t const k, const T* a, const T* b, T* c) {
+        gemm(m, n, k, compute_t<T>{1}, a, k, std::size_t{1}, b, n, std::size_t{1}, compute_t<T>{0}, c, n);
+    }
+}
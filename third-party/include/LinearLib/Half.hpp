@@ -0,0 +1,268 @@
+#pragma once
+
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+namespace LinearLib {
+    namespace detail {
+        /// IEEE binary16 bits of a float, rounded to nearest even. Overflow gives infinity, NaNs stay quiet NaNs.
+        constexpr std::uint16_t floatToHalf(float const value) {
+            const std::uint32_t x = std::bit_cast<std::uint32_t>(value);
+            const auto sign = static_cast<std::uint16_t>((x >> 16) & 0x8000);
+            const std::uint32_t exponent = (x >> 23) & 0xff;
+            std::uint32_t mantissa = x & 0x7fffff;
+
+            if (exponent == 0xff) {
+                return sign | 0x7c00 | (mantissa != 0 ? 0x200 | (mantissa >> 13) : 0);
+            }
+
+            const int e = static_cast<int>(exponent) - 127 + 15;
+            if (e >= 31) {
+                return sign | 0x7c00;
+            }
+
+            std::uint32_t half;
+            std::uint32_t remainder;
+            std::uint32_t halfway;
+
+            if (e <= 0) {
+                // Subnormal half, the implicit leading bit shifts into the mantissa
+                if (e < -10) {
+                    return sign;
+                }
+                mantissa |= 0x800000;
+                const auto shift = static_cast<std::uint32_t>(14 - e);
+                half = mantissa >> shift;
+                remainder = mantissa & ((1u << shift) - 1);
+                halfway = 1u << (shift - 1);
+            } else {
+                half = static_cast<std::uint32_t>(e) << 10 | mantissa >> 13;
+                remainder = mantissa & 0x1fff;
+                halfway = 0x1000;
+            }
+
+            // A carry out of the mantissa correctly bumps the exponent, up to infinity
+            if (remainder > halfway || (remainder == halfway && (half & 1) != 0)) {
+                half++;
+            }
+            return static_cast<std::uint16_t>(sign | half);
+        }
+
+        constexpr float halfToFloat(std::uint16_t const bits) {
+            const std::uint32_t sign = static_cast<std::uint32_t>(bits & 0x8000) << 16;
+            const std::uint32_t exponent = (bits >> 10) & 0x1f;
+            std::uint32_t mantissa = bits & 0x3ff;
+
+            if (exponent == 0) {
+                if (mantissa == 0) {
+                    return std::bit_cast<float>(sign);
+                }
+
+                // Subnormal half, normalized for the wider float exponent
+                std::uint32_t shift = 0;
+                while ((mantissa & 0x400) == 0) {
+                    mantissa <<= 1;
+                    shift++;
+                }
+                mantissa &= 0x3ff;
+                return std::bit_cast<float>(sign | (113 - shift) << 23 | mantissa << 13);
+            }
+
+            if (exponent == 0x1f) {
+                return std::bit_cast<float>(sign | 0x7f800000 | mantissa << 13);
+            }
+
+            return std::bit_cast<float>(sign | (exponent + 112) << 23 | mantissa << 13);
+        }
+    }
+
+    /**
+     * Storage-only reduced precision float: 8 exponent bits like float and 7 mantissa bits. Arithmetic converts to
+     * float, so values are only rounded when they are stored back.
+     */
+    struct BFloat16 {
+        std::uint16_t bits = 0;
+
+        BFloat16() = default;
+
+        constexpr BFloat16(float const value) {
+            const std::uint32_t x = std::bit_cast<std::uint32_t>(value);
+            if ((x & 0x7fffffff) > 0x7f800000) {
+                bits = static_cast<std::uint16_t>(x >> 16 | 0x40);
+            } else {
+                // Round to nearest even on the 16 dropped bits
+                bits = static_cast<std::uint16_t>((x + 0x7fff + ((x >> 16) & 1)) >> 16);
+            }
+        }
+
+        static constexpr BFloat16 fromBits(std::uint16_t const bits) {
+            BFloat16 res;
+            res.bits = bits;
+            return res;
+        }
+
+        constexpr operator float() const {
+            return std::bit_cast<float>(static_cast<std::uint32_t>(bits) << 16);
+        }
+
+        constexpr BFloat16& operator+=(float const other) {
+            return *this = static_cast<float>(*this) + other;
+        }
+
+        constexpr BFloat16& operator-=(float const other) {
+            return *this = static_cast<float>(*this) - other;
+        }
+
+        constexpr BFloat16& operator*=(float const other) {
+            return *this = static_cast<float>(*this) * other;
+        }
+
+        constexpr BFloat16& operator/=(float const other) {
+            return *this = static_cast<float>(*this) / other;
+        }
+    };
+
+    /**
+     * Storage-only IEEE binary16 float: 5 exponent bits and 10 mantissa bits. Arithmetic converts to float, through
+     * F16C instructions when the compiler targets them.
+     */
+    struct Float16 {
+        std::uint16_t bits = 0;
+
+        Float16() = default;
+
+        constexpr Float16(float const value) {
+#if defined(__F16C__)
+            if (!std::is_constant_evaluated()) {
+                bits = _cvtss_sh(value, _MM_FROUND_TO_NEAREST_INT);
+                return;
+            }
+#endif
+            bits = detail::floatToHalf(value);
+        }
+
+        static constexpr Float16 fromBits(std::uint16_t const bits) {
+            Float16 res;
+            res.bits = bits;
+            return res;
+        }
+
+        constexpr operator float() const {
+#if defined(__F16C__)
+            if (!std::is_constant_evaluated()) {
+                return _cvtsh_ss(bits);
+            }
+#endif
+            return detail::halfToFloat(bits);
+        }
+
+        constexpr Float16& operator+=(float const other) {
+            return *this = static_cast<float>(*this) + other;
+        }
+
+        constexpr Float16& operator-=(float const other) {
+            return *this = static_cast<float>(*this) - other;
+        }
+
+        constexpr Float16& operator*=(float const other) {
+            return *this = static_cast<float>(*this) * other;
+        }
+
+        constexpr Float16& operator/=(float const other) {
+            return *this = static_cast<float>(*this) / other;
+        }
+    };
+
+    /// 16 bit float stored for bandwidth and computed on as float.
+    template<typename T>
+    concept ReducedFloat = std::same_as<T, BFloat16> || std::same_as<T, Float16>;
+
+    /// Element types LinearLib containers accept.
+    template<typename T>
+    concept Numeric = std::is_arithmetic_v<T> || ReducedFloat<T>;
+
+    /// Type arithmetic on T is carried out in, float for the 16 bit floats.
+    template<typename T>
+    using compute_t = std::conditional_t<ReducedFloat<T>, float, T>;
+}
+
+template<>
+struct std::numeric_limits<LinearLib::BFloat16> {
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = false;
+    static constexpr bool has_infinity = true;
+    static constexpr bool has_quiet_NaN = true;
+    static constexpr bool has_signaling_NaN = true;
+    static constexpr std::float_denorm_style has_denorm = std::denorm_present;
+    static constexpr bool has_denorm_loss = false;
+    static constexpr std::float_round_style round_style = std::round_to_nearest;
+    static constexpr bool is_iec559 = false;
+    static constexpr bool is_bounded = true;
+    static constexpr bool is_modulo = false;
+    static constexpr int digits = 8;
+    static constexpr int digits10 = 2;
+    static constexpr int max_digits10 = 4;
+    static constexpr int radix = 2;
+    static constexpr int min_exponent = -125;
+    static constexpr int min_exponent10 = -37;
+    static constexpr int max_exponent = 128;
+    static constexpr int max_exponent10 = 38;
+    static constexpr bool traps = false;
+    static constexpr bool tinyness_before = false;
+
+    static constexpr LinearLib::BFloat16 min() noexcept { return LinearLib::BFloat16::fromBits(0x0080); }
+    static constexpr LinearLib::BFloat16 lowest() noexcept { return LinearLib::BFloat16::fromBits(0xff7f); }
+    static constexpr LinearLib::BFloat16 max() noexcept { return LinearLib::BFloat16::fromBits(0x7f7f); }
+    static constexpr LinearLib::BFloat16 epsilon() noexcept { return LinearLib::BFloat16::fromBits(0x3c00); }
+    static constexpr LinearLib::BFloat16 round_error() noexcept { return LinearLib::BFloat16::fromBits(0x3f00); }
+    static constexpr LinearLib::BFloat16 infinity() noexcept { return LinearLib::BFloat16::fromBits(0x7f80); }
+    static constexpr LinearLib::BFloat16 quiet_NaN() noexcept { return LinearLib::BFloat16::fromBits(0x7fc0); }
+    static constexpr LinearLib::BFloat16 signaling_NaN() noexcept { return LinearLib::BFloat16::fromBits(0x7fa0); }
+    static constexpr LinearLib::BFloat16 denorm_min() noexcept { return LinearLib::BFloat16::fromBits(0x0001); }
+};
+
+template<>
+struct std::numeric_limits<LinearLib::Float16> {
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = false;
+    static constexpr bool has_infinity = true;
+    static constexpr bool has_quiet_NaN = true;
+    static constexpr bool has_signaling_NaN = true;
+    static constexpr std::float_denorm_style has_denorm = std::denorm_present;
+    static constexpr bool has_denorm_loss = false;
+    static constexpr std::float_round_style round_style = std::round_to_nearest;
+    static constexpr bool is_iec559 = true;
+    static constexpr bool is_bounded = true;
+    static constexpr bool is_modulo = false;
+    static constexpr int digits = 11;
+    static constexpr int digits10 = 3;
+    static constexpr int max_digits10 = 5;
+    static constexpr int radix = 2;
+    static constexpr int min_exponent = -13;
+    static constexpr int min_exponent10 = -4;
+    static constexpr int max_exponent = 16;
+    static constexpr int max_exponent10 = 4;
+    static constexpr bool traps = false;
+    static constexpr bool tinyness_before = false;
+
+    static constexpr LinearLib::Float16 min() noexcept { return LinearLib::Float16::fromBits(0x0400); }
+    static constexpr LinearLib::Float16 lowest() noexcept { return LinearLib::Float16::fromBits(0xfbff); }
+    static constexpr LinearLib::Float16 max() noexcept { return LinearLib::Float16::fromBits(0x7bff); }
+    static constexpr LinearLib::Float16 epsilon() noexcept { return LinearLib::Float16::fromBits(0x1400); }
+    static constexpr LinearLib::Float16 round_error() noexcept { return LinearLib::Float16::fromBits(0x3800); }
+    static constexpr LinearLib::Float16 infinity() noexcept { return LinearLib::Float16::fromBits(0x7c00); }
+    static constexpr LinearLib::Float16 quiet_NaN() noexcept { return LinearLib::Float16::fromBits(0x7e00); }
+    static constexpr LinearLib::Float16 signaling_NaN() noexcept { return LinearLib::Float16::fromBits(0x7d00); }
+    static constexpr LinearLib::Float16 denorm_min() noexcept { return LinearLib::Float16::fromBits(0x0001); }
+};
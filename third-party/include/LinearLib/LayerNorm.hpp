@@ -0,0 +1,314 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "Elementwise.hpp"
+#include "Tensor.hpp"
+#include "ThreadPool.hpp"
+
+namespace LinearLib {
+    namespace detail {
+        /// Independent Welford accumulators per row, wide enough for the compiler to keep them in one vector register.
+        inline constexpr std::size_t welford_lanes = 16;
+
+        /// Rows of one backward block, each block accumulates its own gamma and beta gradients.
+        inline constexpr std::size_t norm_block_rows = 32;
+
+        /// Running mean and sum of squared deviations.
+        template<typename C>
+        struct Moments {
+            C mean = 0;
+            C m2 = 0;
+            std::size_t count = 0;
+
+            /// Chan et al.'s update for the union of two disjoint sets.
+            void merge(C const other_mean, C const other_m2, std::size_t const other_count) {
+                if (other_count == 0) {
+                    return;
+                }
+
+                const std::size_t total = count + other_count;
+                const C delta = other_mean - mean;
+                const C weight = static_cast<C>(other_count) / static_cast<C>(total);
+
+                mean += delta * weight;
+                m2 += other_m2 + delta * delta * static_cast<C>(count) * weight;
+                count = total;
+            }
+        };
+
+        /**
+         * Moments of h = x + r in one pass, h is written out when sum is given. Every lane runs Welford's update on
+         * its own column stride so the division by the count is shared, the lanes are merged at the end.
+         * @param r Residual row or nullptr.
+         * @param sum Row receiving h or nullptr.
+         */
+        template<typename T, typename C = compute_t<T>>
+        Moments<C> welford(const T* x, const T* r, T* sum, std::size_t const n) {
+            constexpr std::size_t lanes = welford_lanes;
+
+            C mean[lanes] = {};
+            C m2[lanes] = {};
+            std::size_t steps = 0;
+            std::size_t i = 0;
+
+            for (; i + lanes <= n; i += lanes) {
+                const C inv = C{1} / static_cast<C>(++steps);
+                for (std::size_t l = 0; l < lanes; l++) {
+                    C v = static_cast<C>(x[i + l]);
+                    if (r != nullptr) {
+                        v += static_cast<C>(r[i + l]);
+                    }
+                    if (sum != nullptr) {
+                        sum[i + l] = static_cast<T>(v);
+                    }
+
+                    const C delta = v - mean[l];
+                    mean[l] += delta * inv;
+                    m2[l] += delta * (v - mean[l]);
+                }
+            }
+
+            Moments<C> res;
+            if (steps > 0) {
+                for (std::size_t l = 0; l < lanes; l++) {
+                    res.merge(mean[l], m2[l], steps);
+                }
+            }
+
+            for (; i < n; i++) {
+                C v = static_cast<C>(x[i]);
+                if (r != nullptr) {
+                    v += static_cast<C>(r[i]);
+                }
+                if (sum != nullptr) {
+                    sum[i] = static_cast<T>(v);
+                }
+                res.merge(v, C{0}, 1);
+            }
+
+            return res;
+        }
+
+        template<typename T>
+        void requireNormParameters(const Tensor<T>& x, const Tensor<T>& gamma, const Tensor<T>& beta) {
+            if (x.rank() == 0) {
+                throw std::invalid_argument("LayerNorm requires at least one dimension");
+            }
+
+            const std::size_t cols = x.shape(x.rank() - 1);
+            if (gamma.rank() != 1 || gamma.shape(0) != cols || beta.rank() != 1 || beta.shape(0) != cols) {
+                throw std::invalid_argument("LayerNorm gamma and beta must match the last dimension");
+            }
+        }
+    }
+
+    /// Everything LayerNorm's forward pass leaves behind for the next layer and for its backward pass.
+    template<typename T>
+    struct LayerNormState {
+        /// Normalized, scaled and shifted input.
+        Tensor<T> output;
+
+        /// Input plus residual, the stream the next residual connection adds to; a copy of the input without residual,
+        /// so writes to the input after the forward pass do not change the backward pass.
+        Tensor<T> sum;
+
+        /// Per-row mean and reciprocal standard deviation over the last dimension.
+        Tensor<compute_t<T>> mean;
+        Tensor<compute_t<T>> rstd;
+    };
+
+    template<typename T>
+    struct LayerNormGradients {
+        /// Gradient of both the input and the residual, which reach the norm through the same sum.
+        Tensor<T> input;
+        Tensor<T> gamma;
+        Tensor<T> beta;
+    };
+
+    namespace detail {
+        template<typename T>
+        LayerNormState<T> layerNorm(const Tensor<T>& x, const Tensor<T>* residual, const Tensor<T>& gamma,
+                                    const Tensor<T>& beta, compute_t<T> const eps) {
+            using C = compute_t<T>;
+
+            requireNormParameters(x, gamma, beta);
+            if (residual != nullptr && residual->shape() != x.shape()) {
+                throw std::invalid_argument("LayerNorm residual must match the input shape");
+            }
+
+            const std::size_t cols = x.shape(x.rank() - 1);
+            const std::size_t rows = cols == 0 ? 0 : x.size() / cols;
+
+            const Tensor<T> in = x.contiguous();
+            const Tensor<T> res = residual != nullptr ? residual->contiguous() : Tensor<T>();
+            const Tensor<T> g = gamma.contiguous();
+            const Tensor<T> b = beta.contiguous();
+
+            LayerNormState<T> state{
+                Tensor<T>(typename Tensor<T>::Shape(x.shape())),
+                Tensor<T>(typename Tensor<T>::Shape(x.shape())),
+                Tensor<C>(typename Tensor<C>::Shape{rows}),
+                Tensor<C>(typename Tensor<C>::Shape{rows}),
+            };
+
+            const T* source = in.data();
+            const T* skip = residual != nullptr ? res.data() : nullptr;
+            const T* scale = g.data();
+            const T* shift = b.data();
+            T* sum = state.sum.data();
+            T* out = state.output.data();
+            C* mean = state.mean.data();
+            C* rstd = state.rstd.data();
+
+            parallelFor(0, rows, std::max<std::size_t>(1, elementwise_grain / std::max<std::size_t>(cols, 1)),
+                        [&](std::size_t const lo, std::size_t const hi) {
+                for (std::size_t r = lo; r < hi; r++) {
+                    const std::size_t offset = r * cols;
+                    const Moments<C> moments = welford(source + offset, skip != nullptr ? skip + offset : nullptr,
+                                                       sum + offset, cols);
+
+                    const C m = moments.mean;
+                    const C s = C{1} / std::sqrt(moments.m2 / static_cast<C>(cols) + eps);
+                    mean[r] = m;
+                    rstd[r] = s;
+
+                    // The sum was just written so it is read back from cache
+                    const T* h = sum + offset;
+                    T* y = out + offset;
+                    for (std::size_t j = 0; j < cols; j++) {
+                        const C normalized = (static_cast<C>(h[j]) - m) * s;
+                        y[j] = static_cast<T>(normalized * static_cast<C>(scale[j]) + static_cast<C>(shift[j]));
+                    }
+                }
+            });
+
+            return state;
+        }
+
+        template<typename T>
+        LayerNormGradients<T> layerNormBackward(const Tensor<T>& grad, const Tensor<T>* sum_grad,
+                                                const LayerNormState<T>& state, const Tensor<T>& gamma) {
+            using C = compute_t<T>;
+
+            if (grad.shape() != state.output.shape() || (sum_grad != nullptr && sum_grad->shape() != grad.shape())) {
+                throw std::invalid_argument("LayerNorm gradient must match the output shape");
+            }
+            requireNormParameters(grad, gamma, gamma);
+
+            const std::size_t cols = grad.shape(grad.rank() - 1);
+            const std::size_t rows = cols == 0 ? 0 : grad.size() / cols;
+            const std::size_t blocks = (rows + norm_block_rows - 1) / norm_block_rows;
+
+            const Tensor<T> dy = grad.contiguous();
+            const Tensor<T> dsum = sum_grad != nullptr ? sum_grad->contiguous() : Tensor<T>();
+            const Tensor<T> h = state.sum.contiguous();
+            const Tensor<T> g = gamma.contiguous();
+
+            LayerNormGradients<T> res{
+                Tensor<T>(typename Tensor<T>::Shape(grad.shape())),
+                Tensor<T>(typename Tensor<T>::Shape{cols}),
+                Tensor<T>(typename Tensor<T>::Shape{cols}),
+            };
+
+            // Per block partial gradients of gamma and beta, summed in block order so results do not depend on
+            // the thread count
+            std::vector<C> partial(2 * blocks * cols, C{0});
+
+            parallelFor(0, blocks, 1, [&](std::size_t const lo, std::size_t const hi) {
+                for (std::size_t block = lo; block < hi; block++) {
+                    C* dgamma = partial.data() + 2 * block * cols;
+                    C* dbeta = dgamma + cols;
+
+                    const std::size_t end = std::min(rows, (block + 1) * norm_block_rows);
+                    for (std::size_t r = block * norm_block_rows; r < end; r++) {
+                        const std::size_t offset = r * cols;
+                        const T* dy_row = dy.data() + offset;
+                        const T* h_row = h.data() + offset;
+                        const C m = state.mean.data()[r];
+                        const C s = state.rstd.data()[r];
+
+                        // dx = rstd * (dxhat - mean(dxhat) - xhat * mean(dxhat * xhat)), dxhat = dy * gamma
+                        C sum_dxhat = 0;
+                        C sum_dxhat_xhat = 0;
+                        for (std::size_t j = 0; j < cols; j++) {
+                            const C xhat = (static_cast<C>(h_row[j]) - m) * s;
+                            const C d = static_cast<C>(dy_row[j]);
+                            const C dxhat = d * static_cast<C>(g.data()[j]);
+
+                            sum_dxhat += dxhat;
+                            sum_dxhat_xhat += dxhat * xhat;
+                            dgamma[j] += d * xhat;
+                            dbeta[j] += d;
+                        }
+
+                        const C mean_dxhat = sum_dxhat / static_cast<C>(cols);
+                        const C mean_dxhat_xhat = sum_dxhat_xhat / static_cast<C>(cols);
+                        const T* dsum_row = sum_grad != nullptr ? dsum.data() + offset : nullptr;
+                        T* dx = res.input.data() + offset;
+                        for (std::size_t j = 0; j < cols; j++) {
+                            const C xhat = (static_cast<C>(h_row[j]) - m) * s;
+                            const C dxhat = static_cast<C>(dy_row[j]) * static_cast<C>(g.data()[j]);
+                            C value = s * (dxhat - mean_dxhat - xhat * mean_dxhat_xhat);
+                            if (dsum_row != nullptr) {
+                                value += static_cast<C>(dsum_row[j]);
+                            }
+                            dx[j] = static_cast<T>(value);
+                        }
+                    }
+                }
+            });
+
+            for (std::size_t j = 0; j < cols; j++) {
+                C dgamma = 0;
+                C dbeta = 0;
+                for (std::size_t block = 0; block < blocks; block++) {
+                    dgamma += partial[2 * block * cols + j];
+                    dbeta += partial[(2 * block + 1) * cols + j];
+                }
+                res.gamma.data()[j] = static_cast<T>(dgamma);
+                res.beta.data()[j] = static_cast<T>(dbeta);
+            }
+
+            return res;
+        }
+    }
+
+    /**
+     * LayerNorm over the last dimension, gamma * (x - mean) / sqrt(var + eps) + beta. Mean and variance come from a
+     * single Welford pass and the normalization reads the row back while it is still cached.
+     */
+    template<typename T>
+    LayerNormState<T> layerNorm(const Tensor<T>& x, const Tensor<T>& gamma, const Tensor<T>& beta,
+                                compute_t<T> const eps = compute_t<T>(1e-5)) {
+        return detail::layerNorm(x, static_cast<const Tensor<T>*>(nullptr), gamma, beta, eps);
+    }
+
+    /// LayerNorm of x + residual, the sum is formed inside the Welford pass and kept in the state's sum.
+    template<typename T>
+    LayerNormState<T> layerNorm(const Tensor<T>& x, const Tensor<T>& residual, const Tensor<T>& gamma,
+                                const Tensor<T>& beta, compute_t<T> const eps = compute_t<T>(1e-5)) {
+        return detail::layerNorm(x, &residual, gamma, beta, eps);
+    }
+
+    /// Gradients of layerNorm given the gradient of its output.
+    template<typename T>
+    LayerNormGradients<T> layerNormBackward(const Tensor<T>& grad, const LayerNormState<T>& state,
+                                            const Tensor<T>& gamma) {
+        return detail::layerNormBackward(grad, static_cast<const Tensor<T>*>(nullptr), state, gamma);
+    }
+
+    /**
+     * Gradients of layerNorm when its sum also feeds the next residual connection, sum_grad being the gradient
+     * arriving through that path. It is added to the input gradient in the same pass.
+     */
+    template<typename T>
+    LayerNormGradients<T> layerNormBackward(const Tensor<T>& grad, const Tensor<T>& sum_grad,
+                                            const LayerNormState<T>& state, const Tensor<T>& gamma) {
+        return detail::layerNormBackward(grad, &sum_grad, state, gamma);
+    }
+}
@@ -1,17 +1,26 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <concepts>
 #include <format>
 #include <functional>
 #include <initializer_list>
 #include <random>
 #include <type_traits>
 #include <ranges>
+#include <vector>
+
+#include "Decomposition.hpp"
+#include "Elementwise.hpp"
+#include "Expression.hpp"
+#include "Gemm.hpp"
+#include "Transpose.hpp"
 
 namespace LinearLib {
     template<std::size_t R, std::size_t C, typename T>
-    requires std::is_arithmetic_v<T> && (R > 0) && (C > 0)
+    requires Numeric<T> && (R > 0) && (C > 0)
     struct Matrix {
         std::array<std::array<T, C>, R> data;
 
@@ -27,6 +36,21 @@ namespace LinearLib {
         // Default constructor is still needed
         Matrix() = default;
 
+        /// Evaluates a lazy element-wise expression in a single pass.
+        template<MatrixExpression E>
+        requires (E::rows == R && E::cols == C && std::is_same_v<typename E::value_type, T>)
+        Matrix(const E& expr) {
+            evaluate(expr, data[0].data());
+        }
+
+        template<MatrixExpression E>
+        requires (E::rows == R && E::cols == C && std::is_same_v<typename E::value_type, T>)
+        Matrix& operator=(const E& expr) {
+            // Every element only reads its own index, so the expression may refer to this matrix
+            evaluate(expr, data[0].data());
+            return *this;
+        }
+
         static Matrix identity() {
             return eye(0);
         }
@@ -83,8 +107,8 @@ namespace LinearLib {
                         res.data[i][j] = dist(rng);
                     }
                 }
-            } else if constexpr (std::is_floating_point_v<T>) {
-                std::uniform_real_distribution<T> dist(min, max);
+            } else if constexpr (std::is_floating_point_v<compute_t<T>>) {
+                std::uniform_real_distribution<compute_t<T>> dist(min, max);
                 for (std::size_t i = 0; i < R; i++) {
                     for (std::size_t j = 0; j < C; j++) {
                         res.data[i][j] = dist(rng);
@@ -124,70 +148,81 @@ namespace LinearLib {
             return res;
         }
 
+        /// Tiled transpose, see LinearLib::transpose.
         Matrix<C, R, T> transpose() const {
-            Matrix<C, R, T> res;
-
-            for (std::size_t i = 0; i < C; i++) {
-                for (std::size_t j = 0; j < R; j++) {
-                    res.data[i][j] = data[j][i];
-                }
-            }
+            static_assert(sizeof(data) == R * C * sizeof(T), "Matrix rows must be stored contiguously");
 
+            Matrix<C, R, T> res;
+            LinearLib::transpose(R, C, data[0].data(), C, res.data[0].data(), R);
             return res;
         }
 
-        Matrix reshape(std::size_t const rows, std::size_t const cols) const {
-
-            assert(rows * cols == R * C && "Reshaping matrix must have the same number of elements");
-
-            Matrix res;
-
-            for (std::size_t i = 0; i < rows; i++) {
-                for (std::size_t j = 0; j < cols; j++) {
-                    res.data[i][j] = data[i * cols + j];
-                }
-            }
+        /**
+         * Same elements in row-major order under another shape. Tensor::viewOf(matrix).view(shape) gives the same
+         * without a copy.
+         */
+        template<std::size_t R2, std::size_t C2>
+        Matrix<R2, C2, T> reshape() const {
+            static_assert(R2 * C2 == R * C, "Reshaping matrix must have the same number of elements");
 
+            Matrix<R2, C2, T> res;
+            std::copy_n(data[0].data(), R * C, res.data[0].data());
             return res;
         }
 
+        /**
+         * Determinant in O(n^3), by LU decomposition for floating point matrices, in float for 16 bit ones, and by exact
+         * Bareiss elimination for integer ones.
+         */
         T determinant() const {
-
-            assert(isSquare() && "Determinant is only defined for square matrices");
-
-            // Base case 1
-            if (R == 1) {
-                return data[0][0];
+            static_assert(R == C, "Determinant is only defined for square matrices");
+
+            if constexpr (std::is_floating_point_v<T>) {
+                return LUDecomposition<T>(R, data[0].data(), C).determinant();
+            } else if constexpr (ReducedFloat<T>) {
+                const std::vector<float> wide(data[0].data(), data[0].data() + R * C);
+                return LUDecomposition<float>(R, wide.data(), C).determinant();
+            } else {
+                return bareissDeterminant<T>(R, data[0].data(), C);
             }
+        }
 
-            // Base case 2
-            if (R == 2) {
-                return data[0][0] * data[1][1] - data[0][1] * data[1][0];
-            }
-
-            T res = T{};
-            int sign = 1;
-
-            // Create a range of indices for rows, skipping the first row
-            auto rows = std::views::iota(size_t{1}, R);
+        /**
+         * Inverse by LU decomposition
+         * @throws std::domain_error If the matrix is singular
+         */
+        Matrix inverse() const requires std::is_floating_point_v<T> {
+            static_assert(R == C, "Inverse is only defined for square matrices");
 
-            // Apply Laplace Transformation...
-            for (std::size_t i = 0; i < C; i++) {
+            Matrix res;
+            LUDecomposition<T>(R, data[0].data(), C).inverse(res.data[0].data(), C);
+            return res;
+        }
 
-                // Create a range of indices for columns, skipping the current column
-                auto cols = std::views::iota(std::size_t{0}, C) |
-                            std::views::filter([i](const std::size_t col) { return col != i; });
+        /**
+         * Solves this * X = B by LU decomposition
+         * @throws std::domain_error If the matrix is singular
+         */
+        template<std::size_t K>
+        Matrix<R, K, T> solve(const Matrix<R, K, T>& b) const requires std::is_floating_point_v<T> {
+            static_assert(R == C, "Only square systems can be solved");
 
-                // Calculate determinant of submatrix
-                Matrix<(R - 1 > 1 ? R - 1 : 1), (C - 1 > 1 ? C - 1 : 1), T> subMatrix =
-                    splice<(R - 1 > 1 ? R - 1 : 1), (C - 1 > 1 ? C - 1 : 1)>(rows, cols);
+            Matrix<R, K, T> res = b;
+            LUDecomposition<T>(R, data[0].data(), C).solve(res.data[0].data(), K, K);
+            return res;
+        }
 
-                T subDeterminant = subMatrix.determinant();
+        /**
+         * Lower triangular L with this = LL^T, reading only the lower triangle
+         * @throws std::domain_error If the matrix is not positive-definite
+         */
+        Matrix cholesky() const requires std::is_floating_point_v<T> {
+            static_assert(R == C, "Cholesky decomposition is only defined for square matrices");
 
-                res += sign * data[0][i] * subDeterminant;
-                sign = -sign;
-            }
+            const CholeskyDecomposition<T> decomposition(R, data[0].data(), C);
 
+            Matrix res;
+            std::copy_n(decomposition.lower().data(), R * C, res.data[0].data());
             return res;
         }
 
@@ -216,29 +251,89 @@ namespace LinearLib {
             return data;
         }
 
+        /// @return First of the R * C elements, stored contiguously in row-major order
+        T* elements() {
+            static_assert(sizeof(data) == R * C * sizeof(T), "Matrix rows must be stored contiguously");
+            return data[0].data();
+        }
 
-        void forEach(const std::function<void()>& func) {
-            for (std::size_t i = 0; i < R; i++) {
-                for (std::size_t j = 0; j < C; j++) {
-                    func();
-                }
-            }
+        const T* elements() const {
+            static_assert(sizeof(data) == R * C * sizeof(T), "Matrix rows must be stored contiguously");
+            return data[0].data();
         }
 
-        void forEach(const std::function<void(T&)>& func) {
+
+        /// Calls func(), func(element) or func(element, row, column) for every element in row-major order.
+        template<typename F>
+        requires std::invocable<F&> || std::invocable<F&, T&> || std::invocable<F&, T&, std::size_t, std::size_t>
+        void forEach(F&& func) {
             for (std::size_t i = 0; i < R; i++) {
                 for (std::size_t j = 0; j < C; j++) {
-                    func(data[i][j]);
+                    if constexpr (std::invocable<F&, T&, std::size_t, std::size_t>) {
+                        func(data[i][j], i, j);
+                    } else if constexpr (std::invocable<F&, T&>) {
+                        func(data[i][j]);
+                    } else {
+                        func();
+                    }
                 }
             }
         }
 
-        void forEach(const std::function<void(T&, std::size_t, std::size_t)> func) {
-            for (std::size_t i = 0; i < R; i++) {
-                for (std::size_t j = 0; j < C; j++) {
-                    func(data[i][j], i, j);
-                }
-            }
+        /// Replaces every element x with func(x).
+        template<UnaryOperation<T> F>
+        Matrix& apply(F&& func) {
+            detail::apply(elements(), R * C, func, false);
+            return *this;
+        }
+
+        /// apply on the shared ThreadPool, func must be safe to call concurrently.
+        template<UnaryOperation<T> F>
+        Matrix& parallelApply(F&& func) {
+            detail::apply(elements(), R * C, func, true);
+            return *this;
+        }
+
+        /// @return Matrix of func(x) for every element x
+        template<ElementMap<T> F>
+        Matrix<R, C, map_result_t<F, T>> map(F&& func) const {
+            Matrix<R, C, map_result_t<F, T>> res;
+            detail::map(elements(), res.data[0].data(), R * C, func, false);
+            return res;
+        }
+
+        template<ElementMap<T> F>
+        Matrix<R, C, map_result_t<F, T>> parallelMap(F&& func) const {
+            Matrix<R, C, map_result_t<F, T>> res;
+            detail::map(elements(), res.data[0].data(), R * C, func, true);
+            return res;
+        }
+
+        /// @return Matrix of func(x, y) for every pair of elements at the same position
+        template<typename U, ElementMap<T, U> F>
+        Matrix<R, C, map_result_t<F, T, U>> zipMap(const Matrix<R, C, U>& other, F&& func) const {
+            Matrix<R, C, map_result_t<F, T, U>> res;
+            detail::zipMap(elements(), other.data[0].data(), res.data[0].data(), R * C, func, false);
+            return res;
+        }
+
+        template<typename U, ElementMap<T, U> F>
+        Matrix<R, C, map_result_t<F, T, U>> parallelZipMap(const Matrix<R, C, U>& other, F&& func) const {
+            Matrix<R, C, map_result_t<F, T, U>> res;
+            detail::zipMap(elements(), other.data[0].data(), res.data[0].data(), R * C, func, true);
+            return res;
+        }
+
+        /// Folds the elements into init in row-major order, e.g. reduce(T{0}, std::plus{}).
+        template<typename Acc, Reduction<Acc, T> Op>
+        Acc reduce(Acc init, Op&& op) const {
+            return detail::reduce(elements(), R * C, std::move(init), op, false);
+        }
+
+        /// reduce on the shared ThreadPool, op must be associative, see detail::reduce.
+        template<typename Acc, Reduction<Acc, T> Op>
+        Acc parallelReduce(Acc init, Op&& op) const {
+            return detail::reduce(elements(), R * C, std::move(init), op, true);
         }
 
         bool operator==(const Matrix& other) const {
@@ -323,21 +418,24 @@ namespace LinearLib {
          */
         template<std::size_t I>
         Matrix<R, I, T> operator&(const Matrix<C, I, T>& other) const {
+            static_assert(sizeof(data) == R * C * sizeof(T), "Matrix rows must be stored contiguously");
 
             Matrix<R, I, T> res;
 
-            for (std::size_t i = 0; i < R; i++) {
-                for (std::size_t j = 0; j < I; j++) {
-                    T sum = T{};
-                    for (std::size_t k = 0; k < C; k++) {
-                        sum += data[i][k] * other.data[k][j];
-                    }
-                    res.data[i][j] = sum;
-                }
-            }
+            gemm(R, I, C, data[0].data(), other.data[0].data(), res.data[0].data());
 
             return res;
         }
 
     };
+
+    /// Opts a matrix into lazy element-wise arithmetic, the matrix must outlive the expression.
+    template<std::size_t R, std::size_t C, typename T>
+    LeafExpression<T, R, C> lazy(const Matrix<R, C, T>& matrix) {
+        static_assert(sizeof(matrix.data) == R * C * sizeof(T), "Matrix rows must be stored contiguously");
+        return {matrix.data[0].data()};
+    }
+
+    template<std::size_t R, std::size_t C, typename T>
+    void lazy(const Matrix<R, C, T>&&) = delete;
 }
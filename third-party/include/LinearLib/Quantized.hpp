@@ -0,0 +1,292 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include "Tensor.hpp"
+#include "ThreadPool.hpp"
+
+namespace LinearLib {
+    namespace detail {
+        /// Output columns of one packed block and depth of one dot product step, the layout VNNI's vpdpbusd consumes.
+        inline constexpr std::size_t quant_cols = 16;
+        inline constexpr std::size_t quant_depth = 4;
+
+        /// Below this many multiply-adds the int8 kernel runs on the calling thread.
+        inline constexpr std::size_t quant_parallel = 1 << 21;
+
+        /**
+         * Integer dot products of Rows unsigned activation rows with one packed block of 16 signed weight columns.
+         * @param x Rows rows of kp bytes, kp a multiple of 4, row r at x + r * kp.
+         * @param w Block of kp / 4 groups, each 16 columns x 4 consecutive depths.
+         * @param out Rows x 16 sums.
+         */
+        template<std::size_t Rows>
+        void quantizedKernel(std::size_t const kp, const std::uint8_t* x, const std::int8_t* w, std::int32_t* out) {
+            const std::size_t groups = kp / quant_depth;
+
+#if defined(__AVX512VNNI__) && defined(__AVX512F__)
+            __m512i acc[Rows];
+            for (std::size_t r = 0; r < Rows; r++) {
+                acc[r] = _mm512_setzero_si512();
+            }
+
+            for (std::size_t g = 0; g < groups; g++) {
+                const __m512i weights = _mm512_loadu_si512(w + g * quant_cols * quant_depth);
+                for (std::size_t r = 0; r < Rows; r++) {
+                    std::int32_t four;
+                    std::memcpy(&four, x + r * kp + g * quant_depth, sizeof(four));
+                    acc[r] = _mm512_dpbusd_epi32(acc[r], _mm512_set1_epi32(four), weights);
+                }
+            }
+
+            for (std::size_t r = 0; r < Rows; r++) {
+                _mm512_storeu_si512(out + r * quant_cols, acc[r]);
+            }
+#elif defined(__AVX2__)
+            // Without VNNI the bytes are widened to 16 bits and multiplied with vpmaddwd, which never saturates. Each
+            // accumulator holds two partial sums for each of 4 columns, folded together at the end
+            __m256i acc[Rows][4];
+            for (std::size_t r = 0; r < Rows; r++) {
+                for (std::size_t q = 0; q < 4; q++) {
+                    acc[r][q] = _mm256_setzero_si256();
+                }
+            }
+
+            for (std::size_t g = 0; g < groups; g++) {
+                const std::int8_t* block = w + g * quant_cols * quant_depth;
+                __m256i weights[4];
+                for (std::size_t q = 0; q < 4; q++) {
+                    weights[q] = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block + q * 16)));
+                }
+
+                for (std::size_t r = 0; r < Rows; r++) {
+                    std::int32_t four;
+                    std::memcpy(&four, x + r * kp + g * quant_depth, sizeof(four));
+                    const __m256i activations = _mm256_cvtepu8_epi16(_mm_set1_epi32(four));
+                    for (std::size_t q = 0; q < 4; q++) {
+                        acc[r][q] = _mm256_add_epi32(acc[r][q], _mm256_madd_epi16(weights[q], activations));
+                    }
+                }
+            }
+
+            for (std::size_t r = 0; r < Rows; r++) {
+                for (std::size_t half = 0; half < 2; half++) {
+                    const __m256i sums = _mm256_hadd_epi32(acc[r][2 * half], acc[r][2 * half + 1]);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + r * quant_cols + half * 8),
+                                        _mm256_permute4x64_epi64(sums, _MM_SHUFFLE(3, 1, 2, 0)));
+                }
+            }
+#else
+            std::int32_t acc[Rows][quant_cols] = {};
+
+            for (std::size_t g = 0; g < groups; g++) {
+                const std::int8_t* block = w + g * quant_cols * quant_depth;
+                for (std::size_t r = 0; r < Rows; r++) {
+                    const std::uint8_t* four = x + r * kp + g * quant_depth;
+                    for (std::size_t c = 0; c < quant_cols; c++) {
+                        for (std::size_t d = 0; d < quant_depth; d++) {
+                            acc[r][c] += static_cast<std::int32_t>(four[d]) * block[c * quant_depth + d];
+                        }
+                    }
+                }
+            }
+
+            for (std::size_t r = 0; r < Rows; r++) {
+                std::copy_n(acc[r], quant_cols, out + r * quant_cols);
+            }
+#endif
+        }
+    }
+
+    /**
+     * Int8 weight matrix for products x * W with a float x (m x k) and W (k x n), e.g. a Transformer projection.
+     *
+     * Every column of W is quantized symmetrically with its own scale. Activations are quantized per row when
+     * multiplying, to unsigned bytes offset by 128, and the product is accumulated in int32 with VNNI's vpdpbusd
+     * when available or with 16 bit multiply-adds on AVX2. The weights take a quarter of the memory of floats.
+     */
+    class QuantizedMatrix {
+    public:
+        QuantizedMatrix() = default;
+
+        /// Quantizes the row-major k x n matrix w with leading dimension ld.
+        QuantizedMatrix(std::size_t const k, std::size_t const n, const float* w, std::size_t const ld)
+            : k(k), n(n), kp((k + detail::quant_depth - 1) / detail::quant_depth * detail::quant_depth),
+              blocks((n + detail::quant_cols - 1) / detail::quant_cols), scales(n), sums(n) {
+
+            packed.assign(blocks * kp * detail::quant_cols, 0);
+
+            for (std::size_t j = 0; j < n; j++) {
+                float max = 0.0f;
+                for (std::size_t p = 0; p < k; p++) {
+                    max = std::max(max, std::abs(w[p * ld + j]));
+                }
+                scales[j] = max > 0.0f ? max / 127.0f : 1.0f;
+
+                std::int32_t sum = 0;
+                for (std::size_t p = 0; p < k; p++) {
+                    const auto q = static_cast<std::int8_t>(std::clamp(std::nearbyint(w[p * ld + j] / scales[j]), -127.0f, 127.0f));
+                    packed[index(p, j)] = q;
+                    sum += q;
+                }
+                sums[j] = sum;
+            }
+        }
+
+        /// Quantizes a rank 2 tensor of shape (k, n).
+        explicit QuantizedMatrix(const Tensor<float>& w) : QuantizedMatrix(checked(w)) {}
+
+        template<std::size_t R, std::size_t C>
+        explicit QuantizedMatrix(const Matrix<R, C, float>& w) : QuantizedMatrix(R, C, w.data[0].data(), C) {}
+
+        [[nodiscard]] std::size_t rows() const {
+            return k;
+        }
+
+        [[nodiscard]] std::size_t cols() const {
+            return n;
+        }
+
+        /// @return Value of one quantization step of a column
+        [[nodiscard]] float scale(std::size_t const col) const {
+            return scales.at(col);
+        }
+
+        [[nodiscard]] std::int8_t at(std::size_t const row, std::size_t const col) const {
+            if (row >= k || col >= n) {
+                throw std::out_of_range("Index out of bounds");
+            }
+            return packed[index(row, col)];
+        }
+
+        /// @return Float matrix the quantized weights stand for
+        [[nodiscard]] Tensor<float> dequantize() const {
+            Tensor<float> res({k, n});
+            for (std::size_t p = 0; p < k; p++) {
+                for (std::size_t j = 0; j < n; j++) {
+                    res(p, j) = scales[j] * packed[index(p, j)];
+                }
+            }
+            return res;
+        }
+
+        /**
+         * y = x * W for a row-major x (m x k) and y (m x n).
+         * @param ldx Leading dimension of x.
+         * @param ldy Leading dimension of y.
+         */
+        void multiply(std::size_t const m, const float* x, std::size_t const ldx, float* y, std::size_t const ldy) const {
+            if (m == 0 || n == 0) {
+                return;
+            }
+
+            // Quantize each activation row around 128, the row's scale maps its largest magnitude to 127
+            std::vector<std::uint8_t> xq(m * kp, 128);
+            std::vector<float> xs(m);
+            for (std::size_t i = 0; i < m; i++) {
+                const float* row = x + i * ldx;
+                float max = 0.0f;
+                for (std::size_t p = 0; p < k; p++) {
+                    max = std::max(max, std::abs(row[p]));
+                }
+                xs[i] = max / 127.0f;
+
+                const float inverse = max > 0.0f ? 127.0f / max : 0.0f;
+                for (std::size_t p = 0; p < k; p++) {
+                    xq[i * kp + p] = static_cast<std::uint8_t>(std::nearbyint(row[p] * inverse) + 128.0f);
+                }
+            }
+
+            auto run = [&](std::size_t const lo, std::size_t const hi) {
+                alignas(64) std::int32_t dots[4 * detail::quant_cols];
+
+                for (std::size_t b = lo; b < hi; b++) {
+                    const std::int8_t* w = packed.data() + b * kp * detail::quant_cols;
+                    const std::size_t first = b * detail::quant_cols;
+                    const std::size_t cols = std::min(detail::quant_cols, n - first);
+
+                    for (std::size_t i = 0; i < m; i += 4) {
+                        const std::size_t rows = std::min<std::size_t>(4, m - i);
+                        const std::uint8_t* xi = xq.data() + i * kp;
+                        switch (rows) {
+                            case 4: detail::quantizedKernel<4>(kp, xi, w, dots); break;
+                            case 3: detail::quantizedKernel<3>(kp, xi, w, dots); break;
+                            case 2: detail::quantizedKernel<2>(kp, xi, w, dots); break;
+                            default: detail::quantizedKernel<1>(kp, xi, w, dots); break;
+                        }
+
+                        // The 128 offset of the activations contributed 128 times each column's weight sum
+                        for (std::size_t r = 0; r < rows; r++) {
+                            float* out = y + (i + r) * ldy + first;
+                            for (std::size_t c = 0; c < cols; c++) {
+                                const std::int32_t dot = dots[r * detail::quant_cols + c] - 128 * sums[first + c];
+                                out[c] = xs[i + r] * scales[first + c] * static_cast<float>(dot);
+                            }
+                        }
+                    }
+                }
+            };
+
+            if (m * kp * n >= detail::quant_parallel) {
+                parallelFor(0, blocks, 1, run);
+            } else {
+                run(0, blocks);
+            }
+        }
+
+    private:
+        std::size_t k = 0;
+        std::size_t n = 0;
+        std::size_t kp = 0;
+        std::size_t blocks = 0;
+
+        // Blocks of 16 columns, each kp / 4 groups of 16 columns x 4 depths
+        std::vector<std::int8_t> packed;
+        std::vector<float> scales;
+        std::vector<std::int32_t> sums;
+
+        [[nodiscard]] std::size_t index(std::size_t const row, std::size_t const col) const {
+            const std::size_t block = col / detail::quant_cols;
+            const std::size_t group = row / detail::quant_depth;
+            return ((block * (kp / detail::quant_depth) + group) * detail::quant_cols + col % detail::quant_cols) *
+                   detail::quant_depth + row % detail::quant_depth;
+        }
+
+        static QuantizedMatrix checked(const Tensor<float>& w) {
+            if (w.rank() != 2) {
+                throw std::invalid_argument("Quantized weights must be a matrix");
+            }
+            const Tensor<float> dense = w.contiguous();
+            return QuantizedMatrix(dense.shape(0), dense.shape(1), dense.data(), dense.shape(1));
+        }
+    };
+
+    /// Product of float activations (m x k) with int8 weights (k x n).
+    inline Tensor<float> matmul(const Tensor<float>& x, const QuantizedMatrix& w) {
+        if (x.rank() != 2 || x.shape(1) != w.rows()) {
+            throw std::invalid_argument("Matrix multiplication requires (m x k) and (k x n) operands");
+        }
+
+        const Tensor<float> dense = x.contiguous();
+        Tensor<float> res({x.shape(0), w.cols()});
+        w.multiply(x.shape(0), dense.data(), w.rows(), res.data(), w.cols());
+        return res;
+    }
+
+    /**
+     * Matrix Multiplication
+     */
+    inline Tensor<float> operator&(const Tensor<float>& x, const QuantizedMatrix& w) {
+        return matmul(x, w);
+    }
+}
@@ -0,0 +1,352 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include "Tensor.hpp"
+#include "ThreadPool.hpp"
+
+namespace LinearLib {
+    namespace detail {
+        /// One float per register, used for the elements left over after the SIMD loops.
+        struct ScalarLanes {
+            using reg = float;
+            static constexpr std::size_t width = 1;
+            static reg set(float const v) { return v; }
+            static reg load(const float* p) { return *p; }
+            static void store(float* p, reg const v) { *p = v; }
+            static reg add(reg const a, reg const b) { return a + b; }
+            static reg sub(reg const a, reg const b) { return a - b; }
+            static reg mul(reg const a, reg const b) { return a * b; }
+            static reg fmadd(reg const a, reg const b, reg const c) {
+#if defined(__FMA__)
+                return std::fma(a, b, c);
+#else
+                // std::fma is emulated in software without FMA, the reduction stays exact as ln2's high part is short
+                return a * b + c;
+#endif
+            }
+            static reg max(reg const a, reg const b) { return std::max(a, b); }
+            static reg min(reg const a, reg const b) { return std::min(a, b); }
+            static reg round(reg const v) { return std::nearbyint(v); }
+            static reg pow2(reg const n) { return std::bit_cast<float>((static_cast<std::int32_t>(n) + 127) << 23); }
+        };
+
+#if defined(__AVX512F__)
+        struct SoftmaxLanes {
+            using reg = __m512;
+            static constexpr std::size_t width = 16;
+            static constexpr __mmask16 all = 0xFFFF;
+            static reg set(float const v) { return _mm512_set1_ps(v); }
+            static reg load(const float* p) { return _mm512_loadu_ps(p); }
+            static void store(float* p, reg const v) { _mm512_storeu_ps(p, v); }
+            static reg add(reg const a, reg const b) { return _mm512_add_ps(a, b); }
+            static reg sub(reg const a, reg const b) { return _mm512_sub_ps(a, b); }
+            static reg mul(reg const a, reg const b) { return _mm512_mul_ps(a, b); }
+            static reg fmadd(reg const a, reg const b, reg const c) { return _mm512_fmadd_ps(a, b, c); }
+            // Zero-masked forms with every lane set from here on, the unmasked ones start from an undefined register
+            // that GCC 12 reports as uninitialized
+            static reg max(reg const a, reg const b) { return _mm512_maskz_max_ps(all, a, b); }
+            static reg min(reg const a, reg const b) { return _mm512_maskz_min_ps(all, a, b); }
+            static reg round(reg const v) {
+                return _mm512_maskz_roundscale_ps(all, v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            }
+            static reg pow2(reg const n) {
+                const __m512i biased = _mm512_add_epi32(_mm512_maskz_cvtps_epi32(all, n), _mm512_set1_epi32(127));
+                const __m512i bits = _mm512_maskz_slli_epi32(all, biased, 23);
+                return _mm512_castsi512_ps(bits);
+            }
+        };
+#elif defined(__AVX2__) && defined(__FMA__)
+        struct SoftmaxLanes {
+            using reg = __m256;
+            static constexpr std::size_t width = 8;
+            static reg set(float const v) { return _mm256_set1_ps(v); }
+            static reg load(const float* p) { return _mm256_loadu_ps(p); }
+            static void store(float* p, reg const v) { _mm256_storeu_ps(p, v); }
+            static reg add(reg const a, reg const b) { return _mm256_add_ps(a, b); }
+            static reg sub(reg const a, reg const b) { return _mm256_sub_ps(a, b); }
+            static reg mul(reg const a, reg const b) { return _mm256_mul_ps(a, b); }
+            static reg fmadd(reg const a, reg const b, reg const c) { return _mm256_fmadd_ps(a, b, c); }
+            static reg max(reg const a, reg const b) { return _mm256_max_ps(a, b); }
+            static reg min(reg const a, reg const b) { return _mm256_min_ps(a, b); }
+            static reg round(reg const v) { return _mm256_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+            static reg pow2(reg const n) {
+                const __m256i bits = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+                return _mm256_castsi256_ps(bits);
+            }
+        };
+#else
+        using SoftmaxLanes = ScalarLanes;
+#endif
+
+        /**
+         * e^x for x <= 88 with a relative error below 2e-7, i.e. a couple of ulp. x = n ln2 + r with |r| <= ln2 / 2,
+         * e^r comes from a degree 7 polynomial and 2^n is built directly in the exponent bits. Inputs below -87.3 are
+         * clamped and give about 1e-38 rather than 0.
+         */
+        template<typename V>
+        typename V::reg exp(typename V::reg x) {
+            x = V::min(V::max(x, V::set(-87.3f)), V::set(88.0f));
+
+            const typename V::reg n = V::round(V::mul(x, V::set(1.44269504088896341f)));
+            typename V::reg r = V::fmadd(n, V::set(-0.693359375f), x);
+            r = V::fmadd(n, V::set(2.12194440e-4f), r);
+
+            typename V::reg p = V::set(1.9875691500e-4f);
+            p = V::fmadd(p, r, V::set(1.3981999507e-3f));
+            p = V::fmadd(p, r, V::set(8.3334519073e-3f));
+            p = V::fmadd(p, r, V::set(4.1665795894e-2f));
+            p = V::fmadd(p, r, V::set(1.6666665459e-1f));
+            p = V::fmadd(p, r, V::set(5.0000001201e-1f));
+            p = V::fmadd(p, V::mul(r, r), V::add(r, V::set(1.0f)));
+
+            return V::mul(p, V::pow2(n));
+        }
+
+        /// Maximum and sum of e^(x - max) of a run of values, combined without revisiting them.
+        struct Running {
+            float max = std::numeric_limits<float>::lowest();
+            float sum = 0.0f;
+
+            void merge(float const other_max, float const other_sum) {
+                const float m = std::max(max, other_max);
+                sum = sum * exp<ScalarLanes>(max - m) + other_sum * exp<ScalarLanes>(other_max - m);
+                max = m;
+            }
+        };
+
+        /**
+         * Online max and sum over a row in a single read. Each step takes the maximum of four registers, rescales the
+         * per-lane sums once if it grew and adds the four registers' exponentials, so the running maximum costs a
+         * quarter of an exponential per element.
+         */
+        inline Running online(const float* x, std::size_t const n) {
+            using V = SoftmaxLanes;
+            constexpr std::size_t step = 4 * V::width;
+
+            Running res;
+            std::size_t i = 0;
+
+            if (n >= step) {
+                typename V::reg max = V::set(std::numeric_limits<float>::lowest());
+                typename V::reg sum = V::set(0.0f);
+
+                for (; i + step <= n; i += step) {
+                    const typename V::reg v0 = V::load(x + i);
+                    const typename V::reg v1 = V::load(x + i + V::width);
+                    const typename V::reg v2 = V::load(x + i + 2 * V::width);
+                    const typename V::reg v3 = V::load(x + i + 3 * V::width);
+
+                    const typename V::reg next = V::max(max, V::max(V::max(v0, v1), V::max(v2, v3)));
+                    sum = V::mul(sum, exp<V>(V::sub(max, next)));
+                    sum = V::add(sum, V::add(V::add(exp<V>(V::sub(v0, next)), exp<V>(V::sub(v1, next))),
+                                             V::add(exp<V>(V::sub(v2, next)), exp<V>(V::sub(v3, next)))));
+                    max = next;
+                }
+
+                float maxes[V::width];
+                float sums[V::width];
+                V::store(maxes, max);
+                V::store(sums, sum);
+                for (std::size_t lane = 0; lane < V::width; lane++) {
+                    res.merge(maxes[lane], sums[lane]);
+                }
+            }
+
+            for (; i < n; i++) {
+                res.merge(x[i], 1.0f);
+            }
+
+            return res;
+        }
+
+        /// out = e^(x - shift) * factor, or x - shift when log is set.
+        inline void normalize(const float* x, float* out, std::size_t const n, float const shift, float const factor,
+                              bool const log) {
+            using V = SoftmaxLanes;
+
+            std::size_t i = 0;
+            const typename V::reg s = V::set(shift);
+            const typename V::reg f = V::set(factor);
+
+            if (log) {
+                for (; i + V::width <= n; i += V::width) {
+                    V::store(out + i, V::sub(V::load(x + i), s));
+                }
+                for (; i < n; i++) {
+                    out[i] = x[i] - shift;
+                }
+                return;
+            }
+
+            for (; i + V::width <= n; i += V::width) {
+                V::store(out + i, V::mul(exp<V>(V::sub(V::load(x + i), s)), f));
+            }
+            for (; i < n; i++) {
+                out[i] = exp<ScalarLanes>(x[i] - shift) * factor;
+            }
+        }
+
+        template<typename T>
+        void softmaxRow(const T* in, T* out, std::size_t const cols, std::size_t limit, bool const log) {
+            limit = std::min(limit, cols);
+            const T masked = log ? static_cast<T>(-std::numeric_limits<float>::infinity()) : T{0};
+
+            if constexpr (std::is_same_v<T, float>) {
+                if (limit > 0) {
+                    const Running running = online(in, limit);
+                    if (log) {
+                        normalize(in, out, limit, running.max + std::log(running.sum), 1.0f, true);
+                    } else {
+                        normalize(in, out, limit, running.max, 1.0f / running.sum, false);
+                    }
+                }
+            } else {
+                using C = compute_t<T>;
+
+                C max = std::numeric_limits<C>::lowest();
+                C sum = 0;
+                for (std::size_t j = 0; j < limit; j++) {
+                    const C x = static_cast<C>(in[j]);
+                    if (x > max) {
+                        sum = sum * std::exp(max - x) + C{1};
+                        max = x;
+                    } else {
+                        sum += std::exp(x - max);
+                    }
+                }
+
+                const C log_sum = std::log(sum);
+                for (std::size_t j = 0; j < limit; j++) {
+                    const C x = static_cast<C>(in[j]) - max;
+                    out[j] = static_cast<T>(log ? x - log_sum : std::exp(x) / sum);
+                }
+            }
+
+            std::fill(out + limit, out + cols, masked);
+        }
+    }
+
+    /// Replaces every x by e^(x - shift) and returns their sum, the step blockwise (online) softmax is built from.
+    inline float exponentiate(float* x, std::size_t const n, float const shift) {
+        using V = detail::SoftmaxLanes;
+
+        std::size_t i = 0;
+        const typename V::reg s = V::set(shift);
+        typename V::reg acc = V::set(0.0f);
+        for (; i + V::width <= n; i += V::width) {
+            const typename V::reg e = detail::exp<V>(V::sub(V::load(x + i), s));
+            V::store(x + i, e);
+            acc = V::add(acc, e);
+        }
+
+        float lanes[V::width];
+        V::store(lanes, acc);
+
+        float sum = 0.0f;
+        for (const float lane : lanes) {
+            sum += lane;
+        }
+        for (; i < n; i++) {
+            x[i] = detail::exp<detail::ScalarLanes>(x[i] - shift);
+            sum += x[i];
+        }
+        return sum;
+    }
+
+    template<std::floating_point T>
+    T exponentiate(T* x, std::size_t const n, T const shift) {
+        T sum = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            x[i] = std::exp(x[i] - shift);
+            sum += x[i];
+        }
+        return sum;
+    }
+
+    /// Masks fused into the softmax kernels. Both keep a prefix of each row, so masked columns are never read.
+    struct SoftmaxMask {
+        /// Row i of each trailing matrix only keeps columns j <= i + offset, offset being the number of cached keys
+        /// preceding the queries.
+        bool causal = false;
+        std::size_t offset = 0;
+
+        /// Unpadded columns for each index of the first dimension, e.g. sequence lengths of a batch; empty when
+        /// nothing is padded.
+        std::span<const std::size_t> lengths = {};
+    };
+
+    namespace detail {
+        template<typename T>
+        Tensor<T> softmax(const Tensor<T>& x, const SoftmaxMask& mask, bool const log) {
+            if (x.rank() == 0) {
+                throw std::invalid_argument("Softmax requires at least one dimension");
+            }
+
+            if (!mask.lengths.empty() && mask.lengths.size() != (x.rank() >= 2 ? x.shape(0) : 1)) {
+                throw std::invalid_argument("Softmax mask needs one length per index of the first dimension");
+            }
+
+            Tensor<T> out{typename Tensor<T>::Shape(x.shape())};
+
+            // Any zero dimension leaves no rows, and a zero first one would divide by zero below
+            if (x.size() == 0) {
+                return out;
+            }
+
+            const Tensor<T> in = x.contiguous();
+
+            const std::size_t cols = x.shape(x.rank() - 1);
+            const std::size_t rows = x.size() / cols;
+            const std::size_t matrix_rows = x.rank() >= 2 ? x.shape(x.rank() - 2) : 1;
+            const std::size_t first_rows = x.rank() >= 2 ? rows / x.shape(0) : 1;
+
+            const T* source = in.data();
+            T* target = out.data();
+
+            parallelFor(0, rows, std::max<std::size_t>(1, elementwise_grain / std::max<std::size_t>(cols, 1)),
+                        [&](std::size_t const lo, std::size_t const hi) {
+                for (std::size_t r = lo; r < hi; r++) {
+                    std::size_t limit = cols;
+                    if (mask.causal) {
+                        limit = std::min(limit, r % matrix_rows + mask.offset + 1);
+                    }
+                    if (!mask.lengths.empty()) {
+                        limit = std::min(limit, mask.lengths[r / first_rows]);
+                    }
+                    softmaxRow(source + r * cols, target + r * cols, cols, limit, log);
+                }
+            });
+
+            return out;
+        }
+    }
+
+    /**
+     * Softmax over the last dimension. The row maximum and sum are found in a single online pass and exponentials
+     * use a vectorized approximation with a relative error below 2e-7 for float. Masked entries are 0, as is every
+     * entry of a fully masked row.
+     */
+    template<typename T>
+    Tensor<T> softmax(const Tensor<T>& x, const SoftmaxMask& mask = {}) {
+        return detail::softmax(x, mask, false);
+    }
+
+    /// Log of softmax over the last dimension without exponentiating the output, masked entries are -infinity.
+    template<typename T>
+    Tensor<T> logSoftmax(const Tensor<T>& x, const SoftmaxMask& mask = {}) {
+        return detail::softmax(x, mask, true);
+    }
+}
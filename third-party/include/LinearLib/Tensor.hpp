@@ -0,0 +1,694 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "Decomposition.hpp"
+#include "Elementwise.hpp"
+#include "Gemm.hpp"
+#include "Matrix.hpp"
+#include "ThreadPool.hpp"
+#include "Transpose.hpp"
+#include "Vector.hpp"
+
+namespace LinearLib {
+    /// Row-major tensor whose shape is only known at runtime. Elements live in 64 byte aligned heap storage shared
+    /// between a tensor and its views, so copying a tensor, indexing, slicing and reshaping never copy elements; clone()
+    /// does. Sharing carries no const protection: a copy or view of a const tensor is an ordinary writable tensor over
+    /// the same elements, so anything that must not see later writes has to be cloned.
+    template<typename T>
+    requires Numeric<T>
+    class Tensor {
+    public:
+        using Shape = std::vector<std::size_t>;
+
+        /// Alignment of freshly allocated storage in bytes.
+        static constexpr std::size_t alignment = 64;
+
+        // Default constructor is still needed
+        Tensor() = default;
+
+        /// Zero initialized tensor.
+        explicit Tensor(Shape shape) : Tensor(std::move(shape), T{0}) {}
+
+        Tensor(Shape shape, T const val) : dims(std::move(shape)) {
+            steps = contiguousStrides(dims);
+            storage = allocate(size());
+            ptr = storage.get();
+            std::fill_n(ptr, size(), val);
+        }
+
+        Tensor(Shape shape, std::initializer_list<T> init) : dims(std::move(shape)) {
+            if (init.size() != size()) {
+                throw std::invalid_argument("Initializer list size must match tensor shape");
+            }
+            steps = contiguousStrides(dims);
+            storage = allocate(size());
+            ptr = storage.get();
+            std::copy(init.begin(), init.end(), ptr);
+        }
+
+        template<std::size_t R, std::size_t C>
+        explicit Tensor(const Matrix<R, C, T>& matrix) : Tensor(Shape{R, C}) {
+            for (std::size_t i = 0; i < R; i++) {
+                std::copy(matrix.data[i].begin(), matrix.data[i].end(), ptr + i * C);
+            }
+        }
+
+        template<std::size_t N>
+        explicit Tensor(const Vector<N, T>& vector) : Tensor(Shape{N}) {
+            std::copy(vector.data.begin(), vector.data.end(), ptr);
+        }
+
+        static Tensor zeros(Shape shape) {
+            return uniform(std::move(shape), T{0});
+        }
+
+        static Tensor ones(Shape shape) {
+            return uniform(std::move(shape), T{1});
+        }
+
+        static Tensor uniform(Shape shape, T const val) {
+            return Tensor(std::move(shape), val);
+        }
+
+        static Tensor random(Shape shape, T const min, T const max, std::size_t const seed = 0) {
+            Tensor res(std::move(shape));
+
+            std::mt19937_64 rng(seed);
+
+            if constexpr (std::is_integral_v<T>) {
+                std::uniform_int_distribution<T> dist(min, max);
+                std::generate_n(res.ptr, res.size(), [&] { return dist(rng); });
+            } else if constexpr (std::is_floating_point_v<compute_t<T>>) {
+                std::uniform_real_distribution<compute_t<T>> dist(min, max);
+                std::generate_n(res.ptr, res.size(), [&] { return dist(rng); });
+            }
+
+            return res;
+        }
+
+        /// Views the elements of a matrix without copying them, the matrix must outlive the view.
+        template<std::size_t R, std::size_t C>
+        static Tensor viewOf(Matrix<R, C, T>& matrix) {
+            static_assert(sizeof(matrix.data) == R * C * sizeof(T), "Matrix rows must be stored contiguously");
+            return Tensor(std::shared_ptr<T>(), matrix.data[0].data(), Shape{R, C}, Shape{C, 1});
+        }
+
+        [[nodiscard]] const Shape& shape() const {
+            return dims;
+        }
+
+        [[nodiscard]] std::size_t shape(std::size_t const dim) const {
+            return dims.at(dim);
+        }
+
+        /// Distance in elements between neighbours along each dimension.
+        [[nodiscard]] const Shape& strides() const {
+            return steps;
+        }
+
+        [[nodiscard]] std::size_t rank() const {
+            return dims.size();
+        }
+
+        /// @return Number of elements
+        [[nodiscard]] std::size_t size() const {
+            return std::accumulate(dims.begin(), dims.end(), std::size_t{1}, std::multiplies{});
+        }
+
+        [[nodiscard]] bool empty() const {
+            return ptr == nullptr || size() == 0;
+        }
+
+        T* data() {
+            return ptr;
+        }
+
+        const T* data() const {
+            return ptr;
+        }
+
+        /// @return Whether the elements are laid out densely in row-major order
+        [[nodiscard]] bool isContiguous() const {
+            return steps == contiguousStrides(dims);
+        }
+
+        template<typename... Index>
+        requires (std::is_convertible_v<Index, std::size_t> && ...)
+        T& operator()(Index... index) {
+            return ptr[offset({static_cast<std::size_t>(index)...})];
+        }
+
+        template<typename... Index>
+        requires (std::is_convertible_v<Index, std::size_t> && ...)
+        const T& operator()(Index... index) const {
+            return ptr[offset({static_cast<std::size_t>(index)...})];
+        }
+
+        /// View of one entry along the first dimension, dropping that dimension.
+        Tensor operator[](std::size_t const index) const {
+            if (rank() == 0 || index >= dims[0]) {
+                throw std::out_of_range("Index out of bounds");
+            }
+            return Tensor(storage, ptr + index * steps[0], Shape(dims.begin() + 1, dims.end()),
+                          Shape(steps.begin() + 1, steps.end()));
+        }
+
+        /// View of the entries [start, stop) along a dimension, every step-th one.
+        Tensor slice(std::size_t const dim, std::size_t const start, std::size_t const stop, std::size_t const step = 1) const {
+            if (dim >= rank() || start > stop || stop > dims[dim] || step == 0) {
+                throw std::out_of_range("Slice out of bounds");
+            }
+
+            Shape shape = dims;
+            Shape strides = steps;
+            shape[dim] = (stop - start + step - 1) / step;
+            strides[dim] *= step;
+
+            return Tensor(storage, ptr + start * steps[dim], std::move(shape), std::move(strides));
+        }
+
+        /// View of the same elements under another shape, requires contiguous elements.
+        Tensor view(Shape shape) const {
+            if (std::accumulate(shape.begin(), shape.end(), std::size_t{1}, std::multiplies{}) != size()) {
+                throw std::invalid_argument("View must have the same number of elements");
+            }
+            if (!isContiguous()) {
+                throw std::invalid_argument("View requires contiguous elements");
+            }
+
+            Shape strides = contiguousStrides(shape);
+            return Tensor(storage, ptr, std::move(shape), std::move(strides));
+        }
+
+        /// Same elements under another shape, a view when they are contiguous and a contiguous copy otherwise.
+        Tensor reshape(Shape shape) const {
+            return contiguous().view(std::move(shape));
+        }
+
+        /**
+         * View with the dimensions reordered, dimension i of the result is dimension order[i] of this tensor.
+         * Nothing is copied, contiguous() materializes the new layout.
+         */
+        Tensor permute(const Shape& order) const {
+            if (order.size() != rank()) {
+                throw std::invalid_argument("Permutation must name every dimension");
+            }
+
+            Shape shape(rank());
+            Shape strides(rank());
+            std::vector<bool> seen(rank(), false);
+            for (std::size_t i = 0; i < rank(); i++) {
+                if (order[i] >= rank() || seen[order[i]]) {
+                    throw std::invalid_argument("Permutation must name every dimension once");
+                }
+                seen[order[i]] = true;
+                shape[i] = dims[order[i]];
+                strides[i] = steps[order[i]];
+            }
+
+            return Tensor(storage, ptr, std::move(shape), std::move(strides));
+        }
+
+        /// View with two dimensions swapped.
+        Tensor transpose(std::size_t const first, std::size_t const second) const {
+            if (first >= rank() || second >= rank()) {
+                throw std::out_of_range("Dimension out of bounds");
+            }
+
+            Shape order(rank());
+            std::iota(order.begin(), order.end(), std::size_t{0});
+            std::swap(order[first], order[second]);
+            return permute(order);
+        }
+
+        /// View with the last two dimensions swapped.
+        Tensor transpose() const {
+            if (rank() < 2) {
+                throw std::invalid_argument("Transpose requires at least two dimensions");
+            }
+            return transpose(rank() - 2, rank() - 1);
+        }
+
+        /// @return Contiguous copy of the elements
+        Tensor clone() const {
+            Tensor res(Shape(dims), T{});
+            const std::size_t r = rank();
+
+            // Transposed innermost dimensions are copied one matrix at a time through the tiled transpose
+            if (r >= 2 && steps[r - 2] == 1 && steps[r - 1] != 1 && !empty()) {
+                const std::size_t rows = dims[r - 2];
+                const std::size_t cols = dims[r - 1];
+                const Tensor outer(storage, ptr, Shape(dims.begin(), dims.end() - 2), Shape(steps.begin(), steps.end() - 2));
+
+                T* out = res.ptr;
+                outer.forEachOffset([&](std::size_t const offset) {
+                    LinearLib::transpose(cols, rows, ptr + offset, steps[r - 1], out, cols);
+                    out += rows * cols;
+                });
+                return res;
+            }
+
+            T* out = res.ptr;
+            forEachOffset([&out, this](std::size_t const offset) { *out++ = ptr[offset]; });
+            return res;
+        }
+
+        /**
+         * @return This tensor if its elements are already contiguous, a contiguous copy otherwise. The result may share
+         * the elements, so anything kept beyond the caller's scope that must not see later writes should clone().
+         */
+        Tensor contiguous() const {
+            return isContiguous() ? *this : clone();
+        }
+
+        void fill(T const val) {
+            forEachOffset([val, this](std::size_t const offset) { ptr[offset] = val; });
+        }
+
+        /// Copies the elements of another tensor of the same shape into this one.
+        void assign(const Tensor& other) {
+            requireSameShape(other);
+            T* out = ptr;
+            if (isContiguous() && other.isContiguous()) {
+                std::copy_n(other.ptr, size(), out);
+            } else {
+                const Tensor source = other.contiguous();
+                const T* in = source.ptr;
+                forEachOffset([&in, out](std::size_t const offset) { out[offset] = *in++; });
+            }
+        }
+
+        /// Replaces every element x with func(x).
+        template<UnaryOperation<T> F>
+        Tensor& apply(F&& func) {
+            return apply(func, false);
+        }
+
+        /// apply on the shared ThreadPool when the elements are contiguous, func must be safe to call concurrently.
+        template<UnaryOperation<T> F>
+        Tensor& parallelApply(F&& func) {
+            return apply(func, true);
+        }
+
+        /// @return Contiguous tensor of func(x) for every element x
+        template<ElementMap<T> F>
+        Tensor<map_result_t<F, T>> map(F&& func) const {
+            return map(func, false);
+        }
+
+        template<ElementMap<T> F>
+        Tensor<map_result_t<F, T>> parallelMap(F&& func) const {
+            return map(func, true);
+        }
+
+        /// @return Contiguous tensor of func(x, y) for every pair of elements at the same index
+        template<typename U, ElementMap<T, U> F>
+        Tensor<map_result_t<F, T, U>> zipMap(const Tensor<U>& other, F&& func) const {
+            return zipMap(other, func, false);
+        }
+
+        template<typename U, ElementMap<T, U> F>
+        Tensor<map_result_t<F, T, U>> parallelZipMap(const Tensor<U>& other, F&& func) const {
+            return zipMap(other, func, true);
+        }
+
+        /// Folds the elements into init in row-major order, e.g. reduce(T{0}, std::plus{}).
+        template<typename Acc, Reduction<Acc, T> Op>
+        Acc reduce(Acc init, Op&& op) const {
+            const Tensor dense = contiguous();
+            return detail::reduce(dense.ptr, size(), std::move(init), op, false);
+        }
+
+        /// reduce on the shared ThreadPool, op must be associative.
+        template<typename Acc, Reduction<Acc, T> Op>
+        Acc parallelReduce(Acc init, Op&& op) const {
+            const Tensor dense = contiguous();
+            return detail::reduce(dense.ptr, size(), std::move(init), op, true);
+        }
+
+        template<std::size_t R, std::size_t C>
+        Matrix<R, C, T> toMatrix() const {
+            if (dims != Shape{R, C}) {
+                throw std::invalid_argument("Tensor shape must match matrix dimensions");
+            }
+
+            Matrix<R, C, T> res;
+            for (std::size_t i = 0; i < R; i++) {
+                for (std::size_t j = 0; j < C; j++) {
+                    res.data[i][j] = ptr[i * steps[0] + j * steps[1]];
+                }
+            }
+            return res;
+        }
+
+        template<std::size_t N>
+        Vector<N, T> toVector() const {
+            if (dims != Shape{N}) {
+                throw std::invalid_argument("Tensor shape must match vector dimension");
+            }
+
+            Vector<N, T> res;
+            for (std::size_t i = 0; i < N; i++) {
+                res.data[i] = ptr[i * steps[0]];
+            }
+            return res;
+        }
+
+        bool operator==(const Tensor& other) const {
+            if (dims != other.dims) {
+                return false;
+            }
+
+            const Tensor lhs = contiguous();
+            const Tensor rhs = other.contiguous();
+            return std::equal(lhs.ptr, lhs.ptr + size(), rhs.ptr);
+        }
+
+        Tensor operator+(const Tensor& other) const {
+            return zip(other, std::plus{});
+        }
+
+        Tensor operator-(const Tensor& other) const {
+            return zip(other, std::minus{});
+        }
+
+        /**
+         * Element-wise multiplication
+         */
+        Tensor operator*(const Tensor& other) const {
+            return zip(other, std::multiplies{});
+        }
+
+        /**
+         * Scalar Multiplication
+         */
+        Tensor operator*(const T& scalar) const {
+            return parallelMap([scalar](T const x) -> T { return x * scalar; });
+        }
+
+        /**
+         * Matrix Multiplication
+         */
+        Tensor operator&(const Tensor& other) const {
+            return matmul(*this, other);
+        }
+
+        /// Row-major strides of a dense tensor of the given shape.
+        static Shape contiguousStrides(const Shape& shape) {
+            Shape strides(shape.size());
+            std::size_t stride = 1;
+            for (std::size_t i = shape.size(); i > 0; i--) {
+                strides[i - 1] = stride;
+                stride *= shape[i - 1];
+            }
+            return strides;
+        }
+
+        /// Visits the offset of every element in row-major order.
+        template<typename F>
+        void forEachOffset(F&& func) const {
+            if (isContiguous()) {
+                for (std::size_t i = 0, n = size(); i < n; i++) {
+                    func(i);
+                }
+                return;
+            }
+
+            if (empty()) {
+                return;
+            }
+
+            // Odometer over every dimension but the last, which is walked in the inner loop
+            const std::size_t last = rank() - 1;
+            Shape index(rank(), 0);
+            std::size_t base = 0;
+
+            while (true) {
+                for (std::size_t j = 0; j < dims[last]; j++) {
+                    func(base + j * steps[last]);
+                }
+
+                std::size_t dim = last;
+                while (true) {
+                    if (dim == 0) {
+                        return;
+                    }
+                    dim--;
+                    base += steps[dim];
+                    if (++index[dim] < dims[dim]) {
+                        break;
+                    }
+                    base -= index[dim] * steps[dim];
+                    index[dim] = 0;
+                }
+            }
+        }
+
+    private:
+        // Owner of the storage, empty when viewing memory owned elsewhere
+        std::shared_ptr<T> storage;
+        T* ptr = nullptr;
+        Shape dims = {0};
+        Shape steps = {1};
+
+        Tensor(std::shared_ptr<T> storage, T* ptr, Shape shape, Shape strides)
+            : storage(std::move(storage)), ptr(ptr), dims(std::move(shape)), steps(std::move(strides)) {}
+
+        static std::shared_ptr<T> allocate(std::size_t const n) {
+            const std::size_t bytes = std::max<std::size_t>(n, 1) * sizeof(T);
+            auto* memory = static_cast<T*>(::operator new(bytes, std::align_val_t{alignment}));
+            return std::shared_ptr<T>(memory, [](T* p) { ::operator delete(p, std::align_val_t{alignment}); });
+        }
+
+        std::size_t offset(std::initializer_list<std::size_t> index) const {
+            if (index.size() != rank()) {
+                throw std::invalid_argument("Number of indices must match tensor rank");
+            }
+
+            std::size_t res = 0;
+            std::size_t dim = 0;
+            for (const std::size_t i : index) {
+                if (i >= dims[dim]) {
+                    throw std::out_of_range("Index out of bounds");
+                }
+                res += i * steps[dim++];
+            }
+            return res;
+        }
+
+        void requireSameShape(const Tensor& other) const {
+            if (dims != other.dims) {
+                throw std::invalid_argument("Tensor shapes must match");
+            }
+        }
+
+        template<typename F>
+        Tensor& apply(F& func, bool const parallel) {
+            if (isContiguous()) {
+                detail::apply(ptr, size(), func, parallel);
+            } else {
+                forEachOffset([&func, this](std::size_t const offset) { ptr[offset] = static_cast<T>(std::invoke(func, ptr[offset])); });
+            }
+            return *this;
+        }
+
+        template<typename F>
+        Tensor<map_result_t<F, T>> map(F& func, bool const parallel) const {
+            const Tensor dense = contiguous();
+            Tensor<map_result_t<F, T>> res{Shape(dims)};
+            detail::map(dense.ptr, res.data(), size(), func, parallel);
+            return res;
+        }
+
+        template<typename U, typename F>
+        Tensor<map_result_t<F, T, U>> zipMap(const Tensor<U>& other, F& func, bool const parallel) const {
+            if (dims != other.shape()) {
+                throw std::invalid_argument("Tensor shapes must match");
+            }
+
+            const Tensor dense = contiguous();
+            const Tensor<U> rhs = other.contiguous();
+            Tensor<map_result_t<F, T, U>> res{Shape(dims)};
+            detail::zipMap(dense.ptr, rhs.data(), res.data(), size(), func, parallel);
+            return res;
+        }
+
+        template<typename F>
+        Tensor zip(const Tensor& other, F&& func) const {
+            requireSameShape(other);
+
+            const Tensor lhs = contiguous();
+            const Tensor rhs = other.contiguous();
+
+            Tensor res{Shape(dims)};
+            detail::zipMap(lhs.ptr, rhs.ptr, res.ptr, size(), func, true);
+            return res;
+        }
+    };
+
+    /**
+     * Matrix product with NumPy semantics. Operands of rank 2 or more are stacks of matrices over their leading
+     * dimensions, which broadcast against each other, e.g. (batch, heads, seq, d) x (batch, heads, d, seq) or
+     * (batch, seq, d) x (d, d). A vector operand takes part as a single row on the left or a single column on the
+     * right, and that dimension is dropped from the result. Either operand may be a strided view such as a transpose
+     * or a slice. The products of a batch are spread across the shared ThreadPool.
+     */
+    template<typename T>
+    Tensor<T> matmul(const Tensor<T>& a, const Tensor<T>& b) {
+        using Shape = typename Tensor<T>::Shape;
+
+        if (a.rank() == 0 || b.rank() == 0) {
+            throw std::invalid_argument("Matrix multiplication requires operands of rank 1 or more");
+        }
+
+        const Tensor<T> lhs = a.rank() == 1 ? a.reshape({1, a.shape(0)}) : a;
+        const Tensor<T> rhs = b.rank() == 1 ? b.reshape({b.shape(0), 1}) : b;
+
+        const std::size_t lr = lhs.rank();
+        const std::size_t rr = rhs.rank();
+        const std::size_t m = lhs.shape(lr - 2);
+        const std::size_t k = lhs.shape(lr - 1);
+        const std::size_t n = rhs.shape(rr - 1);
+
+        if (rhs.shape(rr - 2) != k) {
+            throw std::invalid_argument("Matrix multiplication requires (m x k) and (k x n) operands");
+        }
+
+        // Broadcast the leading dimensions, right aligned, a dimension of 1 or a missing one repeats with stride 0
+        const std::size_t nb = std::max(lr, rr) - 2;
+        Shape batch(nb);
+        Shape a_steps(nb, 0);
+        Shape b_steps(nb, 0);
+
+        for (std::size_t d = 0; d < nb; d++) {
+            const std::size_t from_end = nb - d;
+            const std::size_t ad = lr - 2 >= from_end ? lhs.shape(lr - 2 - from_end) : 1;
+            const std::size_t bd = rr - 2 >= from_end ? rhs.shape(rr - 2 - from_end) : 1;
+
+            if (ad != bd && ad != 1 && bd != 1) {
+                throw std::invalid_argument("Leading dimensions of matrix multiplication operands must broadcast");
+            }
+
+            batch[d] = std::max(ad, bd);
+            if (ad != 1) {
+                a_steps[d] = lhs.strides()[lr - 2 - from_end];
+            }
+            if (bd != 1) {
+                b_steps[d] = rhs.strides()[rr - 2 - from_end];
+            }
+        }
+
+        const std::size_t count = std::accumulate(batch.begin(), batch.end(), std::size_t{1}, std::multiplies{});
+
+        Shape shape = batch;
+        shape.push_back(m);
+        shape.push_back(n);
+        Tensor<T> res(shape);
+
+        const T* a_data = lhs.data();
+        const T* b_data = rhs.data();
+        T* c_data = res.data();
+        const std::size_t a_rs = lhs.strides()[lr - 2];
+        const std::size_t a_cs = lhs.strides()[lr - 1];
+        const std::size_t b_rs = rhs.strides()[rr - 2];
+        const std::size_t b_cs = rhs.strides()[rr - 1];
+
+        const std::size_t work = std::max<std::size_t>(m * n * k, 1);
+        parallelFor(0, count, std::max<std::size_t>(1, detail::gemm_parallel / work),
+                    [&](std::size_t const lo, std::size_t const hi) {
+            for (std::size_t i = lo; i < hi; i++) {
+                // Offsets of the i-th matrices, the batch index read as mixed radix digits
+                std::size_t a_offset = 0;
+                std::size_t b_offset = 0;
+                for (std::size_t d = nb, rest = i; d-- > 0; rest /= batch[d]) {
+                    const std::size_t digit = rest % batch[d];
+                    a_offset += digit * a_steps[d];
+                    b_offset += digit * b_steps[d];
+                }
+
+                gemm(m, n, k, compute_t<T>{1}, a_data + a_offset, a_rs, a_cs, b_data + b_offset, b_rs, b_cs,
+                     compute_t<T>{0}, c_data + i * m * n, n);
+            }
+        });
+
+        if (b.rank() == 1) {
+            shape.pop_back();
+        }
+        if (a.rank() == 1) {
+            shape.erase(shape.end() - (b.rank() == 1 ? 1 : 2));
+        }
+        return res.view(std::move(shape));
+    }
+
+    namespace detail {
+        template<typename T>
+        void requireSquare(const Tensor<T>& a) {
+            if (a.rank() != 2 || a.shape(0) != a.shape(1)) {
+                throw std::invalid_argument("Operation requires a square matrix");
+            }
+        }
+    }
+
+    /// Determinant of a square matrix, see Matrix::determinant.
+    template<typename T>
+    T determinant(const Tensor<T>& a) {
+        detail::requireSquare(a);
+
+        const Tensor<T> dense = a.contiguous();
+        if constexpr (std::is_floating_point_v<T>) {
+            return LUDecomposition<T>(dense.shape(0), dense.data(), dense.shape(1)).determinant();
+        } else if constexpr (ReducedFloat<T>) {
+            const std::vector<float> wide(dense.data(), dense.data() + dense.size());
+            return LUDecomposition<float>(dense.shape(0), wide.data(), dense.shape(1)).determinant();
+        } else {
+            return bareissDeterminant<T>(dense.shape(0), dense.data(), dense.shape(1));
+        }
+    }
+
+    /// @throws std::domain_error If the matrix is singular
+    template<std::floating_point T>
+    Tensor<T> inverse(const Tensor<T>& a) {
+        detail::requireSquare(a);
+
+        const std::size_t n = a.shape(0);
+        const Tensor<T> dense = a.contiguous();
+
+        Tensor<T> res({n, n});
+        LUDecomposition<T>(n, dense.data(), n).inverse(res.data(), n);
+        return res;
+    }
+
+    /**
+     * Solves A X = B for a square A and B of shape (n) or (n x k).
+     * @throws std::domain_error If A is singular
+     */
+    template<std::floating_point T>
+    Tensor<T> solve(const Tensor<T>& a, const Tensor<T>& b) {
+        detail::requireSquare(a);
+
+        const std::size_t n = a.shape(0);
+        if (b.rank() == 0 || b.rank() > 2 || b.shape(0) != n) {
+            throw std::invalid_argument("Right hand side must have as many rows as the matrix");
+        }
+
+        const Tensor<T> dense = a.contiguous();
+        Tensor<T> res = b.clone();
+        const std::size_t nrhs = b.rank() == 2 ? b.shape(1) : 1;
+        LUDecomposition<T>(n, dense.data(), n).solve(res.data(), nrhs, nrhs);
+        return res;
+    }
+}
@@ -0,0 +1,351 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+namespace LinearLib {
+    struct ThreadPoolConfig {
+        /// Threads working on a parallel region, the calling thread included. 0 reads LINEARLIB_NUM_THREADS and falls
+        /// back to the hardware concurrency.
+        std::size_t threads = 0;
+
+        /// Pin each worker to one CPU.
+        bool pin = false;
+
+        /// CPUs the workers are pinned to in turn, empty uses CPUs 0, 1, 2, ...
+        std::vector<int> cpus = {};
+    };
+
+    /**
+     * Work stealing thread pool. Each worker owns a deque it pops from the back of, and steals from the front of the
+     * others' when its own runs dry. The thread starting a parallel region runs one share itself and keeps executing
+     * its region's queued tasks while it waits, so a pool of n threads spawns n - 1 workers. It never picks up other
+     * regions' tasks: those could clobber thread local state, such as GEMM's packed panels, that its own region's
+     * tasks are still reading.
+     *
+     * Parallel regions started from inside another one, from an OpenMP region or within a SerialScope run inline on
+     * the calling thread, so nested or already parallel callers never oversubscribe the machine.
+     */
+    class ThreadPool {
+    public:
+        explicit ThreadPool(const ThreadPoolConfig& config = {}) {
+            std::size_t threads = config.threads;
+            if (threads == 0) {
+                if (const char* env = std::getenv("LINEARLIB_NUM_THREADS"); env != nullptr) {
+                    threads = std::strtoul(env, nullptr, 10);
+                }
+            }
+            if (threads == 0) {
+                threads = std::max(1u, std::thread::hardware_concurrency());
+            }
+
+            for (std::size_t i = 0; i + 1 < threads; i++) {
+                queues.push_back(std::make_unique<Queue>());
+            }
+
+            for (std::size_t i = 0; i + 1 < threads; i++) {
+                workers.emplace_back([this, i] { work(i); });
+
+                if (config.pin) {
+                    const int cpu = config.cpus.empty() ? static_cast<int>(i) : config.cpus[i % config.cpus.size()];
+                    pin(workers.back(), cpu);
+                }
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard lock(sleep_mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+        }
+
+        /// @return Threads working on a parallel region, the calling thread included
+        [[nodiscard]] std::size_t size() const {
+            return workers.size() + 1;
+        }
+
+        /// Pool shared by LinearLib's parallel kernels, created on first use.
+        static ThreadPool& shared() {
+            std::lock_guard lock(shared_mutex());
+            std::unique_ptr<ThreadPool>& pool = shared_pool();
+            if (pool == nullptr) {
+                pool = std::make_unique<ThreadPool>();
+            }
+            return *pool;
+        }
+
+        /// Replaces the shared pool, must not be called while a parallel region is running on it.
+        static void configure(const ThreadPoolConfig& config) {
+            std::lock_guard lock(shared_mutex());
+            std::unique_ptr<ThreadPool>& pool = shared_pool();
+            pool.reset();
+            pool = std::make_unique<ThreadPool>(config);
+        }
+
+        /// @return Whether the calling thread is already inside a parallel region
+        [[nodiscard]] static bool inParallel() {
+#if defined(_OPENMP)
+            if (omp_in_parallel()) {
+                return true;
+            }
+#endif
+            return depth() > 0;
+        }
+
+        /// Marks the calling thread as already parallel for its lifetime, e.g. inside threads managed by the caller.
+        struct SerialScope {
+            SerialScope() {
+                depth()++;
+            }
+
+            SerialScope(const SerialScope&) = delete;
+            SerialScope& operator=(const SerialScope&) = delete;
+
+            ~SerialScope() {
+                depth()--;
+            }
+        };
+
+        /**
+         * Runs func(lo, hi) over chunks covering [begin, end), each at least grain long, and returns once all of them
+         * are done. The first exception thrown by a chunk is rethrown.
+         */
+        template<typename F>
+        void parallelFor(std::size_t const begin, std::size_t const end, std::size_t const grain, F&& func) {
+            if (end <= begin) {
+                return;
+            }
+
+            const std::size_t n = end - begin;
+            const std::size_t chunks = std::min((n + std::max<std::size_t>(grain, 1) - 1) / std::max<std::size_t>(grain, 1), 4 * size());
+
+            if (chunks <= 1 || size() == 1 || inParallel()) {
+                SerialScope scope;
+                func(begin, end);
+                return;
+            }
+
+            struct Region {
+                std::atomic<std::size_t> remaining;
+                std::mutex mutex;
+                std::exception_ptr error;
+            };
+
+            auto region = std::make_shared<Region>();
+            region->remaining = chunks;
+
+            auto run = [region, &func](std::size_t const lo, std::size_t const hi) {
+                try {
+                    SerialScope scope;
+                    func(lo, hi);
+                } catch (...) {
+                    std::lock_guard lock(region->mutex);
+                    if (!region->error) {
+                        region->error = std::current_exception();
+                    }
+                }
+
+                region->remaining.fetch_sub(1);
+                region->remaining.notify_all();
+            };
+
+            auto bound = [&](std::size_t const chunk) {
+                return begin + n * chunk / chunks;
+            };
+
+            for (std::size_t chunk = 1; chunk < chunks; chunk++) {
+                submit({[run, lo = bound(chunk), hi = bound(chunk + 1)] { run(lo, hi); }, region.get()});
+            }
+
+            run(bound(0), bound(1));
+
+            // Help with this region's queued chunks instead of idling until every chunk is done
+            while (true) {
+                const std::size_t remaining = region->remaining.load();
+                if (remaining == 0) {
+                    break;
+                }
+                if (std::optional<Task> task = take(std::nullopt, region.get())) {
+                    task->run();
+                } else {
+                    region->remaining.wait(remaining);
+                }
+            }
+
+            if (region->error) {
+                std::rethrow_exception(region->error);
+            }
+        }
+
+    private:
+        struct Task {
+            std::function<void()> run;
+
+            /// Parallel region the task belongs to.
+            const void* region;
+        };
+
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> workers;
+
+        std::mutex sleep_mutex;
+        std::condition_variable wake;
+        std::atomic<std::size_t> pending = 0;
+        std::atomic<std::size_t> next_queue = 0;
+        bool stopping = false;
+
+        static std::mutex& shared_mutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        static std::unique_ptr<ThreadPool>& shared_pool() {
+            static std::unique_ptr<ThreadPool> pool;
+            return pool;
+        }
+
+        static int& depth() {
+            thread_local int depth = 0;
+            return depth;
+        }
+
+        /// Queue owned by the calling thread if it is one of this pool's workers.
+        static std::optional<std::size_t>& own_queue() {
+            thread_local std::optional<std::size_t> queue;
+            return queue;
+        }
+
+        static void pin(std::thread& thread, int const cpu) {
+#if defined(__linux__)
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#elif defined(_WIN32)
+            SetThreadAffinityMask(thread.native_handle(), DWORD_PTR{1} << cpu);
+#else
+            (void) thread;
+            (void) cpu;
+#endif
+        }
+
+        void submit(Task task) {
+            const std::size_t index = own_queue().value_or(next_queue.fetch_add(1) % queues.size());
+            {
+                std::lock_guard lock(queues[index]->mutex);
+                queues[index]->tasks.push_back(std::move(task));
+            }
+            {
+                std::lock_guard lock(sleep_mutex);
+                pending++;
+            }
+            wake.notify_one();
+        }
+
+        /// Pops from the back of the caller's own queue, otherwise steals from the front of another.
+        /// @param region Only take tasks of this region, nullptr for any.
+        std::optional<Task> take(std::optional<std::size_t> const own, const void* const region = nullptr) {
+            if (pending.load() == 0) {
+                return std::nullopt;
+            }
+
+            if (region != nullptr) {
+                for (const std::unique_ptr<Queue>& queue : queues) {
+                    std::lock_guard lock(queue->mutex);
+                    const auto it = std::find_if(queue->tasks.begin(), queue->tasks.end(),
+                                                 [region](const Task& task) { return task.region == region; });
+                    if (it != queue->tasks.end()) {
+                        Task task = std::move(*it);
+                        queue->tasks.erase(it);
+                        pending--;
+                        return task;
+                    }
+                }
+                return std::nullopt;
+            }
+
+            if (own.has_value()) {
+                std::lock_guard lock(queues[*own]->mutex);
+                if (!queues[*own]->tasks.empty()) {
+                    Task task = std::move(queues[*own]->tasks.back());
+                    queues[*own]->tasks.pop_back();
+                    pending--;
+                    return task;
+                }
+            }
+
+            const std::size_t start = own.value_or(0);
+            for (std::size_t i = 0; i < queues.size(); i++) {
+                Queue& queue = *queues[(start + i) % queues.size()];
+                std::lock_guard lock(queue.mutex);
+                if (!queue.tasks.empty()) {
+                    Task task = std::move(queue.tasks.front());
+                    queue.tasks.pop_front();
+                    pending--;
+                    return task;
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        void work(std::size_t const index) {
+            own_queue() = index;
+
+            while (true) {
+                if (std::optional<Task> task = take(index)) {
+                    task->run();
+                    continue;
+                }
+
+                std::unique_lock lock(sleep_mutex);
+                wake.wait(lock, [this] { return stopping || pending.load() > 0; });
+                if (stopping && pending.load() == 0) {
+                    return;
+                }
+            }
+        }
+    };
+
+    /// Runs func(lo, hi) over chunks of [begin, end) on the shared pool.
+    template<typename F>
+    void parallelFor(std::size_t const begin, std::size_t const end, std::size_t const grain, F&& func) {
+        ThreadPool::shared().parallelFor(begin, end, grain, std::forward<F>(func));
+    }
+}
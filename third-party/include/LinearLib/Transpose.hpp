@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace LinearLib {
+    namespace detail {
+        /// Side of the square tiles a transpose walks, two tiles of doubles fit comfortably in L1.
+        inline constexpr std::size_t transpose_tile = 32;
+
+        /// Side of the register-sized blocks inside a tile.
+        inline constexpr std::size_t transpose_block = 8;
+
+        template<typename T>
+        void transposeBlock(const T* in, std::size_t const ldi, T* out, std::size_t const ldo) {
+            for (std::size_t i = 0; i < transpose_block; i++) {
+                for (std::size_t j = 0; j < transpose_block; j++) {
+                    out[j * ldo + i] = in[i * ldi + j];
+                }
+            }
+        }
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+        /// 8 x 8 float block through unpack, shuffle and lane permutes, so every load and store is a full row.
+        template<>
+        inline void transposeBlock<float>(const float* in, std::size_t const ldi, float* out, std::size_t const ldo) {
+            __m256 r0 = _mm256_loadu_ps(in + 0 * ldi);
+            __m256 r1 = _mm256_loadu_ps(in + 1 * ldi);
+            __m256 r2 = _mm256_loadu_ps(in + 2 * ldi);
+            __m256 r3 = _mm256_loadu_ps(in + 3 * ldi);
+            __m256 r4 = _mm256_loadu_ps(in + 4 * ldi);
+            __m256 r5 = _mm256_loadu_ps(in + 5 * ldi);
+            __m256 r6 = _mm256_loadu_ps(in + 6 * ldi);
+            __m256 r7 = _mm256_loadu_ps(in + 7 * ldi);
+
+            const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+            const __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+            const __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+            const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+            const __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+            const __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+            const __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+            const __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+
+            const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+            r0 = _mm256_permute2f128_ps(s0, s4, 0x20);
+            r1 = _mm256_permute2f128_ps(s1, s5, 0x20);
+            r2 = _mm256_permute2f128_ps(s2, s6, 0x20);
+            r3 = _mm256_permute2f128_ps(s3, s7, 0x20);
+            r4 = _mm256_permute2f128_ps(s0, s4, 0x31);
+            r5 = _mm256_permute2f128_ps(s1, s5, 0x31);
+            r6 = _mm256_permute2f128_ps(s2, s6, 0x31);
+            r7 = _mm256_permute2f128_ps(s3, s7, 0x31);
+
+            _mm256_storeu_ps(out + 0 * ldo, r0);
+            _mm256_storeu_ps(out + 1 * ldo, r1);
+            _mm256_storeu_ps(out + 2 * ldo, r2);
+            _mm256_storeu_ps(out + 3 * ldo, r3);
+            _mm256_storeu_ps(out + 4 * ldo, r4);
+            _mm256_storeu_ps(out + 5 * ldo, r5);
+            _mm256_storeu_ps(out + 6 * ldo, r6);
+            _mm256_storeu_ps(out + 7 * ldo, r7);
+        }
+#endif
+    }
+
+    /**
+     * Writes the transpose of the row-major rows x cols matrix in (leading dimension ldi) to the cols x rows matrix out
+     * (leading dimension ldo). Both are walked in square tiles so that neither side is streamed column by column, and
+     * whole 8 x 8 blocks go through a register kernel. The matrices must not overlap.
+     */
+    template<typename T>
+    void transpose(std::size_t const rows, std::size_t const cols, const T* in, std::size_t const ldi, T* out,
+                   std::size_t const ldo) {
+        using detail::transpose_block;
+        using detail::transpose_tile;
+
+        for (std::size_t ib = 0; ib < rows; ib += transpose_tile) {
+            const std::size_t ie = std::min(rows, ib + transpose_tile);
+
+            for (std::size_t jb = 0; jb < cols; jb += transpose_tile) {
+                const std::size_t je = std::min(cols, jb + transpose_tile);
+
+                std::size_t i = ib;
+                for (; i + transpose_block <= ie; i += transpose_block) {
+                    std::size_t j = jb;
+                    for (; j + transpose_block <= je; j += transpose_block) {
+                        detail::transposeBlock(in + i * ldi + j, ldi, out + j * ldo + i, ldo);
+                    }
+                    for (; j < je; j++) {
+                        for (std::size_t r = i; r < i + transpose_block; r++) {
+                            out[j * ldo + r] = in[r * ldi + j];
+                        }
+                    }
+                }
+                for (; i < ie; i++) {
+                    for (std::size_t j = jb; j < je; j++) {
+                        out[j * ldo + i] = in[i * ldi + j];
+                    }
+                }
+            }
+        }
+    }
+}
@@ -5,11 +5,12 @@
 #include <initializer_list>
 #include <type_traits>
 
+#include "Expression.hpp"
 #include "Matrix.hpp"
 
 namespace LinearLib {
     template<std::size_t N, typename T>
-    requires std::is_arithmetic_v<T>
+    requires Numeric<T>
     struct Vector {
 
         std::array<T, N> data;
@@ -22,6 +23,20 @@ namespace LinearLib {
         // Default constructor is still needed
         Vector() = default;
 
+        /// Evaluates a lazy element-wise expression in a single pass.
+        template<MatrixExpression E>
+        requires (E::rows == N && E::cols == 1 && std::is_same_v<typename E::value_type, T>)
+        Vector(const E& expr) {
+            evaluate(expr, data.data());
+        }
+
+        template<MatrixExpression E>
+        requires (E::rows == N && E::cols == 1 && std::is_same_v<typename E::value_type, T>)
+        Vector& operator=(const E& expr) {
+            evaluate(expr, data.data());
+            return *this;
+        }
+
         T magnitude() const {
             T res = 0;
 
@@ -123,4 +138,13 @@ namespace LinearLib {
             return res;
         }
     };
+
+    /// Opts a vector into lazy element-wise arithmetic as an N x 1 expression, the vector must outlive the expression.
+    template<std::size_t N, typename T>
+    LeafExpression<T, N, 1> lazy(const Vector<N, T>& vector) {
+        return {vector.data.data()};
+    }
+
+    template<std::size_t N, typename T>
+    void lazy(const Vector<N, T>&&) = delete;
 }